@@ -0,0 +1,196 @@
+#include "World.h"
+#include "Metrics.h"
+
+#include <array>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+/**
+ * @brief Replays the CollisionSample scene without rendering and compares the broad phase structures of the World.
+ *
+ * Each structure runs the same scene: the circles are created with the same seeded positions and velocities, moved
+ * and bounced on the fictive border like in CollisionSample. The time spent in ResolveBroadPhase, in the whole collision
+ * step and the average number of pairs reported by the broad phase are printed for each structure, followed by the time
+ * of the whole collision step when the pairs are streamed to the narrow phase by ResolveCollisions.
+ */
+
+namespace
+{
+    // Same values as CollisionSample.
+    constexpr float VelocityMaxOnStart = 80.0f;
+    constexpr float BorderSizeForElements = 50.0f;
+    constexpr float CircleRadius = 12.0f;
+    constexpr float DeltaTime = 1.0f / 60.0f;
+    constexpr int WarmUpSteps = 60;
+    constexpr int MeasuredSteps = 1000;
+
+    class NullContactListener final : public Engine::ContactListener
+    {
+    public:
+        void OnTriggerEnter(Engine::Collider, Engine::Collider) noexcept override {}
+
+        void OnTriggerExit(Engine::Collider, Engine::Collider) noexcept override {}
+
+        void OnCollisionEnter(Engine::Collider, Engine::Collider) noexcept override {}
+
+        void OnCollisionExit(Engine::Collider, Engine::Collider) noexcept override {}
+    };
+
+    struct Circle
+    {
+        Engine::BodyRef bodyRef;
+        Engine::ColliderRef colliderRef;
+    };
+
+    struct BenchmarkResult
+    {
+        double broadPhaseMs = 0.0;
+        double collisionMs = 0.0;
+        double streamedCollisionMs = 0.0;
+        double averagePairCount = 0.0;
+    };
+
+    const char* BroadPhaseName(Engine::BroadPhaseType broadPhaseType) noexcept
+    {
+        switch (broadPhaseType)
+        {
+            case Engine::BroadPhaseType::QUAD_TREE:
+                return "QuadTree";
+            case Engine::BroadPhaseType::AABB_TREE:
+                return "AABBTree";
+            case Engine::BroadPhaseType::SWEEP_AND_PRUNE:
+                return "SweepAndPrune";
+            case Engine::BroadPhaseType::SPATIAL_HASH_GRID:
+                return "SpatialHashGrid";
+            case Engine::BroadPhaseType::LINEAR_QUAD_TREE:
+                return "LinearQuadTree";
+            case Engine::BroadPhaseType::KD_TREE:
+                return "KdTree";
+        }
+        return "Unknown";
+    }
+
+    /**
+     * @brief Does the work of World::Update for the circles, so that both collision phases can be timed separately.
+     */
+    void MoveCircles(Engine::World& world, std::vector<Circle>& circles) noexcept
+    {
+        for (auto& circle: circles)
+        {
+            auto& body = world.GetBody(circle.bodyRef);
+            auto velocity = body.Velocity();
+            const auto position = body.Position();
+            if (position.X >= Metrics::WIDTH - BorderSizeForElements || position.X <= BorderSizeForElements)
+            {
+                velocity.X = -velocity.X;
+            }
+            if (position.Y >= Metrics::HEIGHT - BorderSizeForElements || position.Y <= BorderSizeForElements)
+            {
+                velocity.Y = -velocity.Y;
+            }
+            body.SetVelocity(velocity);
+            body.SetPosition(position + velocity * DeltaTime);
+
+            world.GetCollider(circle.colliderRef).circleShape = Math::CircleF(body.Position(), CircleRadius);
+        }
+    }
+
+    BenchmarkResult RunBenchmark(Engine::BroadPhaseType broadPhaseType, std::size_t circleCount) noexcept
+    {
+        Engine::World world;
+        world.Init();
+        world.broadPhaseType = broadPhaseType;
+        NullContactListener contactListener;
+        world.contactListener = &contactListener;
+
+        std::mt19937 generator(42);
+        std::uniform_real_distribution<float> positionX(100.0f, Metrics::WIDTH - 100.0f);
+        std::uniform_real_distribution<float> positionY(100.0f, Metrics::HEIGHT - 100.0f);
+        std::uniform_real_distribution<float> velocity(-VelocityMaxOnStart, VelocityMaxOnStart);
+
+        std::vector<Circle> circles(circleCount);
+        for (auto& circle: circles)
+        {
+            circle.bodyRef = world.CreateBody();
+            auto& body = world.GetBody(circle.bodyRef);
+            body.SetMass(1);
+            body.SetPosition(Math::Vec2F(positionX(generator), positionY(generator)));
+            body.SetVelocity(Math::Vec2F(velocity(generator), velocity(generator)));
+
+            circle.colliderRef = world.CreateCollider(circle.bodyRef);
+            auto& collider = world.GetCollider(circle.colliderRef);
+            collider._shape = Math::ShapeType::Circle;
+            collider.isTrigger = false;
+            collider.circleShape = Math::CircleF(body.Position(), CircleRadius);
+        }
+
+        for (int step = 0; step < WarmUpSteps; step++)
+        {
+            MoveCircles(world, circles);
+            world.ResolveBroadPhase();
+            world.ResolveNarrowPhase();
+        }
+
+        BenchmarkResult result;
+        std::size_t pairCount = 0;
+        for (int step = 0; step < MeasuredSteps; step++)
+        {
+            MoveCircles(world, circles);
+
+            const auto broadPhaseStart = std::chrono::high_resolution_clock::now();
+            world.ResolveBroadPhase();
+            const auto broadPhaseEnd = std::chrono::high_resolution_clock::now();
+            world.ResolveNarrowPhase();
+            const auto narrowPhaseEnd = std::chrono::high_resolution_clock::now();
+
+            result.broadPhaseMs += std::chrono::duration<double, std::milli>(broadPhaseEnd - broadPhaseStart).count();
+            result.collisionMs += std::chrono::duration<double, std::milli>(narrowPhaseEnd - broadPhaseStart).count();
+            pairCount += world.GetBroadPhase().ColliderPairs().size();
+        }
+
+        for (int step = 0; step < MeasuredSteps; step++)
+        {
+            MoveCircles(world, circles);
+
+            const auto collisionStart = std::chrono::high_resolution_clock::now();
+            world.ResolveCollisions();
+            const auto collisionEnd = std::chrono::high_resolution_clock::now();
+            result.streamedCollisionMs += std::chrono::duration<double, std::milli>(collisionEnd - collisionStart).count();
+        }
+
+        result.collisionMs /= MeasuredSteps;
+        result.streamedCollisionMs /= MeasuredSteps;
+        result.broadPhaseMs /= MeasuredSteps;
+        result.averagePairCount = static_cast<double>(pairCount) / MeasuredSteps;
+        world.contactListener = nullptr;
+        return result;
+    }
+}
+
+int main()
+{
+    constexpr std::array<std::size_t, 3> CircleCounts{200, 1000, 2000};
+    constexpr std::array<Engine::BroadPhaseType, 6> BroadPhaseTypes{
+            Engine::BroadPhaseType::QUAD_TREE,
+            Engine::BroadPhaseType::AABB_TREE,
+            Engine::BroadPhaseType::SWEEP_AND_PRUNE,
+            Engine::BroadPhaseType::SPATIAL_HASH_GRID,
+            Engine::BroadPhaseType::LINEAR_QUAD_TREE,
+            Engine::BroadPhaseType::KD_TREE
+    };
+
+    std::printf("%-8s %-16s %16s %14s %14s %10s\n", "Circles", "BroadPhase", "BroadPhase(ms)", "Collision(ms)",
+                "Streamed(ms)", "Pairs");
+    for (const auto circleCount: CircleCounts)
+    {
+        for (const auto broadPhaseType: BroadPhaseTypes)
+        {
+            const auto result = RunBenchmark(broadPhaseType, circleCount);
+            std::printf("%-8zu %-16s %16.4f %14.4f %14.4f %10.1f\n", circleCount, BroadPhaseName(broadPhaseType),
+                        result.broadPhaseMs, result.collisionMs, result.streamedCollisionMs, result.averagePairCount);
+        }
+    }
+    return 0;
+}
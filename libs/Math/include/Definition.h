@@ -8,6 +8,8 @@
 #define NOALIAS __declspec(noalias)
 #define FORCE_INLINE __forceinline
 #else
-#define NOALIAS __attribute__((const))
+// pure, not const: the members read *this and the references they are given, const would let the compiler fold the
+// call on the address alone.
+#define NOALIAS __attribute__((pure))
 #define FORCE_INLINE __attribute__((always_inline))
 #endif
\ No newline at end of file
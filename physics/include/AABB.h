@@ -0,0 +1,159 @@
+#pragma once
+
+#include "Shape.h"
+#include "Intrinsics.h"
+
+#include <algorithm>
+#include <cstdint>
+
+namespace Engine
+{
+    /**
+     * @brief Checks if an AABB fully contains another one.
+     * @param outer The containing AABB.
+     * @param inner The contained AABB.
+     * @return True if every point of inner is inside outer.
+     */
+    [[nodiscard]] inline bool ContainsAABB(const Math::RectangleF& outer, const Math::RectangleF& inner) noexcept
+    {
+        return outer.MinBound().X <= inner.MinBound().X && outer.MinBound().Y <= inner.MinBound().Y &&
+               outer.MaxBound().X >= inner.MaxBound().X && outer.MaxBound().Y >= inner.MaxBound().Y;
+    }
+
+    /**
+     * @brief Returns the smallest AABB containing both AABBs.
+     */
+    [[nodiscard]] inline Math::RectangleF MergeAABB(const Math::RectangleF& aabbA, const Math::RectangleF& aabbB) noexcept
+    {
+        return Math::RectangleF(
+                Math::Vec2F(std::min(aabbA.MinBound().X, aabbB.MinBound().X),
+                            std::min(aabbA.MinBound().Y, aabbB.MinBound().Y)),
+                Math::Vec2F(std::max(aabbA.MaxBound().X, aabbB.MaxBound().X),
+                            std::max(aabbA.MaxBound().Y, aabbB.MaxBound().Y)));
+    }
+
+    /**
+     * @brief Returns the AABB enlarged by a margin on every side, used to store "fat" AABBs in the broad phase.
+     */
+    [[nodiscard]] inline Math::RectangleF FattenAABB(const Math::RectangleF& aabb, float margin) noexcept
+    {
+        const Math::Vec2F marginVec2F(margin, margin);
+        return Math::RectangleF(aabb.MinBound() - marginVec2F, aabb.MaxBound() + marginVec2F);
+    }
+
+    /**
+     * @brief Returns the perimeter of an AABB, the 2D equivalent of its surface area used by the SAH cost.
+     */
+    [[nodiscard]] inline float PerimeterAABB(const Math::RectangleF& aabb) noexcept
+    {
+        const auto size = aabb.Size();
+        return 2.0f * (size.X + size.Y);
+    }
+
+    /**
+     * @brief Returns the square distance from a point to an AABB, 0 if the AABB contains the point.
+     */
+    [[nodiscard]] inline float SquareDistanceAABB(const Math::RectangleF& aabb, Math::Vec2F point) noexcept
+    {
+        const float distanceX = std::max({aabb.MinBound().X - point.X, 0.0f, point.X - aabb.MaxBound().X});
+        const float distanceY = std::max({aabb.MinBound().Y - point.Y, 0.0f, point.Y - aabb.MaxBound().Y});
+        return distanceX * distanceX + distanceY * distanceY;
+    }
+
+    /**
+     * @brief The number of AABBs tested at once by OverlapMask8.
+     */
+    static constexpr std::size_t OverlapBatchSize = 8;
+
+    /**
+     * @brief Tests one AABB against eight AABBs stored as structure of arrays.
+     * \n Note : Eight values are read from each array, the arrays must be padded after the last AABB.
+     * @param aabb The AABB tested against the packed ones.
+     * @param minX, minY, maxX, maxY The bounds of the eight packed AABBs.
+     * @return A mask whose bit i is set if the AABB overlaps the packed AABB i, touching AABBs overlap like Math::Intersect.
+     */
+    [[nodiscard]] inline std::uint32_t OverlapMask8(const Math::RectangleF& aabb, const float* minX, const float* minY,
+                                                    const float* maxX, const float* maxY) noexcept
+    {
+#if defined(__AVX__)
+        const __m256 aabbMinX = _mm256_set1_ps(aabb.MinBound().X);
+        const __m256 aabbMinY = _mm256_set1_ps(aabb.MinBound().Y);
+        const __m256 aabbMaxX = _mm256_set1_ps(aabb.MaxBound().X);
+        const __m256 aabbMaxY = _mm256_set1_ps(aabb.MaxBound().Y);
+
+        const __m256 overlapX = _mm256_and_ps(_mm256_cmp_ps(aabbMaxX, _mm256_loadu_ps(minX), _CMP_GE_OQ),
+                                              _mm256_cmp_ps(aabbMinX, _mm256_loadu_ps(maxX), _CMP_LE_OQ));
+        const __m256 overlapY = _mm256_and_ps(_mm256_cmp_ps(aabbMaxY, _mm256_loadu_ps(minY), _CMP_GE_OQ),
+                                              _mm256_cmp_ps(aabbMinY, _mm256_loadu_ps(maxY), _CMP_LE_OQ));
+        return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_and_ps(overlapX, overlapY)));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < OverlapBatchSize; i++)
+        {
+            const bool isOverlapping = aabb.MaxBound().X >= minX[i] && aabb.MinBound().X <= maxX[i] &&
+                                       aabb.MaxBound().Y >= minY[i] && aabb.MinBound().Y <= maxY[i];
+            mask |= static_cast<std::uint32_t>(isOverlapping) << i;
+        }
+        return mask;
+#endif
+    }
+
+    /**
+     * @brief The number of child AABBs classified at once by OverlapMask4 and ContainsMask4, one per quadtree child.
+     */
+    static constexpr std::size_t ChildBatchSize = 4;
+
+    /**
+     * @brief Tests one AABB against four AABBs stored as structure of arrays, a single SSE comparison per bound.
+     * @param aabb The AABB tested against the packed ones.
+     * @param minX, minY, maxX, maxY The bounds of the four packed AABBs, four values are read from each array.
+     * @return A mask whose bit i is set if the AABB overlaps the packed AABB i, touching AABBs overlap like Math::Intersect.
+     */
+    [[nodiscard]] inline std::uint32_t OverlapMask4(const Math::RectangleF& aabb, const float* minX, const float* minY,
+                                                    const float* maxX, const float* maxY) noexcept
+    {
+#if defined(__SSE__)
+        const __m128 overlapX = _mm_and_ps(_mm_cmpge_ps(_mm_set1_ps(aabb.MaxBound().X), _mm_loadu_ps(minX)),
+                                           _mm_cmple_ps(_mm_set1_ps(aabb.MinBound().X), _mm_loadu_ps(maxX)));
+        const __m128 overlapY = _mm_and_ps(_mm_cmpge_ps(_mm_set1_ps(aabb.MaxBound().Y), _mm_loadu_ps(minY)),
+                                           _mm_cmple_ps(_mm_set1_ps(aabb.MinBound().Y), _mm_loadu_ps(maxY)));
+        return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_and_ps(overlapX, overlapY)));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < ChildBatchSize; i++)
+        {
+            const bool isOverlapping = aabb.MaxBound().X >= minX[i] && aabb.MinBound().X <= maxX[i] &&
+                                       aabb.MaxBound().Y >= minY[i] && aabb.MinBound().Y <= maxY[i];
+            mask |= static_cast<std::uint32_t>(isOverlapping) << i;
+        }
+        return mask;
+#endif
+    }
+
+    /**
+     * @brief Checks which of four AABBs stored as structure of arrays fully contain an AABB.
+     * @param aabb The contained AABB.
+     * @param minX, minY, maxX, maxY The bounds of the four packed AABBs, four values are read from each array.
+     * @return A mask whose bit i is set if the packed AABB i contains the AABB, like ContainsAABB.
+     */
+    [[nodiscard]] inline std::uint32_t ContainsMask4(const Math::RectangleF& aabb, const float* minX, const float* minY,
+                                                     const float* maxX, const float* maxY) noexcept
+    {
+#if defined(__SSE__)
+        const __m128 containsX = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minX), _mm_set1_ps(aabb.MinBound().X)),
+                                            _mm_cmpge_ps(_mm_loadu_ps(maxX), _mm_set1_ps(aabb.MaxBound().X)));
+        const __m128 containsY = _mm_and_ps(_mm_cmple_ps(_mm_loadu_ps(minY), _mm_set1_ps(aabb.MinBound().Y)),
+                                            _mm_cmpge_ps(_mm_loadu_ps(maxY), _mm_set1_ps(aabb.MaxBound().Y)));
+        return static_cast<std::uint32_t>(_mm_movemask_ps(_mm_and_ps(containsX, containsY)));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < ChildBatchSize; i++)
+        {
+            const bool isContaining = minX[i] <= aabb.MinBound().X && minY[i] <= aabb.MinBound().Y &&
+                                      maxX[i] >= aabb.MaxBound().X && maxY[i] >= aabb.MaxBound().Y;
+            mask |= static_cast<std::uint32_t>(isContaining) << i;
+        }
+        return mask;
+#endif
+    }
+}
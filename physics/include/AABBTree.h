@@ -0,0 +1,224 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+#include "AABB.h"
+#include "QueryCallback.h"
+#include "RayCast.h"
+#include "NearestCallback.h"
+#include "PairCallback.h"
+#include "BroadPhase.h"
+#include "Allocator.h"
+#include <vector>
+#ifdef TRACY_ENABLE
+#include <Tracy.hpp>
+#include <TracyC.h>
+#endif
+
+namespace Engine
+{
+    /**
+     * @struct AABBTreeNode
+     * @brief Represents a node of the dynamic AABB tree.
+     *
+     * Leaves hold one collider, internal nodes always have two children and bound both of them.
+     *
+     * The struct has the following members:
+     * - `Math::RectangleF aabb`: The fat AABB of the leaf collider, or the AABB containing both children.
+     * - `ColliderRef colliderRef`: The collider of a leaf node.
+     * - `CollisionFilter filter`: The filter of the collider of a leaf node.
+     * - `int parent`: The parent node index, also used as the next free node when the node is released.
+     * - `int child1`, `int child2`: The children node indices, AABBTree::NullNode for a leaf.
+     * - `int height`: 0 for a leaf, 1 + the height of the highest child otherwise, -1 for a released node.
+     */
+    struct AABBTreeNode
+    {
+        Math::RectangleF aabb{Math::Vec2F::Zero(), Math::Vec2F::Zero()};
+        ColliderRef colliderRef{};
+        CollisionFilter filter{};
+        int parent = -1;
+        int child1 = -1;
+        int child2 = -1;
+        int height = -1;
+    };
+
+    /**
+     * @class AABBTree
+     * @brief Represents a dynamic bounding volume hierarchy used as a BroadPhase.
+     *
+     * Colliders are stored as leaves with an enlarged ("fat") AABB, a collider is only moved in the tree when its tight
+     * AABB leaves its fat AABB. Leaves are inserted next to the sibling minimizing the surface area heuristic (the
+     * perimeter in 2D), and the tree is kept balanced with rotations while refitting the ancestors of a leaf.
+     * Unlike the QuadTree, it does not depend on the world extent nor on a maximum depth, which makes it a better fit
+     * for scenes mixing tiny and very large colliders.
+     *
+     * The class has the following members:
+     * - `HeapAllocator heapAllocator`: An allocator for managing memory used by the tree.
+     * - `AllocatedVector<AABBTreeNode> nodes`: The node pool, released nodes are chained in a free list.
+     * - `AllocatedVector<int> proxies`: The leaf node of each collider, indexed by collider index.
+     * - `AllocatedVector<ColliderPair> colliderPairs`: The pairs of colliders whose fat AABBs overlap.
+     * - `int root`: The index of the root node, NullNode if the tree is empty.
+     * - `static constexpr int NullNode`: The index used for a missing node.
+     * - `static constexpr float FatAABBMargin`: The margin added around each collider AABB stored in the tree.
+     *
+     * The class provides the following methods:
+     * - `void Init() noexcept`: Preallocates the node pool.
+     * - `void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept`: Inserts a collider or moves it if it left its fat AABB.
+     * - `void RemoveCollider(std::size_t colliderIndex) noexcept`: Removes a collider from the tree.
+     * - `void FindPossiblePairs() noexcept`: Fills colliderPairs with the colliders whose fat AABBs overlap.
+     * - `void FindPossiblePairs(PairCallback& callback) noexcept`: Streams the overlapping colliders to a callback in chunks of PairChunkSize pairs.
+     * - `const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept`: Returns colliderPairs.
+     * - `void QueryPairs(const SimplifedCollider& simplifedCollider, AllocatedVector<ColliderPair>& pairs) noexcept`: Adds the pairs of an outside collider with the colliders of the tree.
+     * - `void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept`: Finds the colliders whose fat AABB overlaps an AABB.
+     * - `void QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept`: Answers a batch of AABB queries in a single traversal.
+     * - `void RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept`: Finds the colliders whose fat AABB is crossed by a packet of rays.
+     * - `bool QueryNearest(Math::Vec2F point, std::size_t queryIndex, float maxSquareDistance, NearestCallback& callback) noexcept`: Finds the colliders nearest to a point, closest nodes first.
+     * - `void VisitNodes(BroadPhaseVisitor& visitor) const noexcept`: Gives the fat AABB and depth of every node to a visitor.
+     * - `bool HasCollider(std::size_t colliderIndex) const noexcept`: Checks if a collider is in the tree.
+     * - `int Height() const noexcept`: Returns the height of the tree.
+     * - `void Clear() noexcept`: Clears the tree, resetting it to an empty state.
+     */
+    class AABBTree final : public BroadPhase
+    {
+    public:
+        HeapAllocator heapAllocator;
+        AllocatedVector <AABBTreeNode> nodes{StandardAllocator < AABBTreeNode > {heapAllocator}};
+        AllocatedVector <int> proxies{StandardAllocator < int > {heapAllocator}};
+        AllocatedVector <ColliderPair> colliderPairs{StandardAllocator < ColliderPair > {heapAllocator}};
+        int root = NullNode;
+
+        static constexpr int NullNode = -1;
+        static constexpr float FatAABBMargin = 4.0f;
+
+        AABBTree() noexcept = default;
+
+        /**
+         * @brief Preallocates the node pool and the collider pairs.
+         */
+        void Init() noexcept override;
+
+        /**
+         * @brief Inserts a collider in the tree, or moves it if its tight AABB left the fat AABB stored in the tree.
+         * @param simplifedCollider The simplified collider with its tight AABB.
+         */
+        void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept override;
+
+        /**
+         * @brief Removes a collider from the tree, does nothing if the collider is not in the tree.
+         * @param colliderIndex The index of the collider to remove.
+         */
+        void RemoveCollider(std::size_t colliderIndex) noexcept override;
+
+        /**
+         * @brief Fills colliderPairs with every pair of colliders whose fat AABBs overlap and whose filters collide.
+         * \n Note : Each pair is reported once, ordered by collider index.
+         */
+        void FindPossiblePairs() noexcept override;
+
+        /**
+         * @brief Finds the same pairs as FindPossiblePairs, handing them to the callback each time PairChunkSize of them
+         * are found instead of keeping them all.
+         * \n Note : colliderPairs is the chunk buffer, it is left empty.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        void FindPossiblePairs(PairCallback& callback) noexcept override;
+
+        /**
+         * @return colliderPairs, the pairs of the last FindPossiblePairs.
+         */
+        [[nodiscard]] const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept override;
+
+        /**
+         * @brief Adds to pairs a pair of the given collider with every collider of the tree whose fat AABB overlaps its AABB.
+         * The colliders whose filter does not collide with the filter of the given collider are skipped.
+         * \n Note : The given collider does not need to be in the tree, it is the first collider of each pair.
+         * @param simplifedCollider The simplified collider to test against the tree.
+         * @param pairs The pairs to append to.
+         */
+        void QueryPairs(const SimplifedCollider& simplifedCollider, AllocatedVector <ColliderPair>& pairs) noexcept;
+
+        /**
+         * @brief Gives to the callback every collider whose fat AABB overlaps the given AABB.
+         * @param aabb The AABB to query.
+         * @param queryIndex The index given back to the callback with each collider found.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Answers a batch of AABB queries in a single traversal of the tree.
+         * \n Note : Each node is visited once with the subset of the queries reaching it.
+         * @param aabbs The AABBs to query, the index of an AABB in the array is its query index.
+         * @param queryCount The number of AABBs.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Gives to the callback every collider whose fat AABB is crossed by some lanes of the packet.
+         * \n Note : A node is skipped when none of the lanes reach it before their maxFraction, which the callback
+         * lowers on each hit, so the nodes behind the closest hits are not visited.
+         * @param packet The rays traversing the tree.
+         * @param callback The callback testing the colliders found.
+         */
+        void RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept override;
+
+        /**
+         * @brief Gives to the callback the colliders that may be the nearest to a point, visiting the nodes closest first.
+         * The nodes wait in a priority queue ordered by the distance to their bounds, a lower bound of the distance to
+         * their colliders, and the traversal stops when the closest node left is farther than the distance returned
+         * by the callback.
+         * @param point The query point.
+         * @param queryIndex The index given back to the callback with each candidate.
+         * @param maxSquareDistance The square distance beyond which no collider is needed.
+         * @param callback The callback measuring the candidates.
+         * @return True, the tree always answers the query.
+         */
+        bool QueryNearest(Math::Vec2F point, std::size_t queryIndex, float maxSquareDistance,
+                          NearestCallback& callback) noexcept override;
+
+        /**
+         * @brief Gives the fat AABB of every node to the visitor, a node before its children.
+         * @param visitor The visitor receiving the nodes.
+         */
+        void VisitNodes(BroadPhaseVisitor& visitor) const noexcept override;
+
+        /**
+         * @return True if the collider with this index is in the tree.
+         */
+        [[nodiscard]] bool HasCollider(std::size_t colliderIndex) const noexcept;
+
+        /**
+         * @return The height of the tree, 0 for an empty tree or a single leaf.
+         */
+        [[nodiscard]] int Height() const noexcept;
+
+        /**
+         * @brief Clears the tree, resetting it to an empty state.
+         */
+        void Clear() noexcept override;
+
+    private:
+        PairCallback* _pairCallback = nullptr;
+        int _freeList = NullNode;
+        AllocatedVector <int> _stack{StandardAllocator < int > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _activeQueries{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <NearestEntry<int>> _nearestQueue{
+                StandardAllocator < NearestEntry<int> > {heapAllocator}};
+
+        int allocateNode() noexcept;
+
+        void freeNode(int nodeIndex) noexcept;
+
+        void insertLeaf(int leaf) noexcept;
+
+        void removeLeaf(int leaf) noexcept;
+
+        int balance(int nodeIndex) noexcept;
+
+        void visitNode(int nodeIndex, int depth, BroadPhaseVisitor& visitor) const noexcept;
+
+        void queryNodeBatch(int nodeIndex, std::size_t activeBegin, const Math::RectangleF* aabbs,
+                            QueryCallback& callback) noexcept;
+    };
+}
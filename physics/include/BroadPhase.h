@@ -0,0 +1,140 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+#include "Allocator.h"
+#include "QueryCallback.h"
+#include "RayCast.h"
+#include "NearestCallback.h"
+#include "PairCallback.h"
+#include "BroadPhaseVisitor.h"
+
+#include <cstddef>
+
+namespace Engine
+{
+    /**
+     * @class BroadPhase
+     * @brief Interface of the spatial structures finding the pairs of colliders that may collide.
+     *
+     * The World only talks to its broad phase through this interface, so the structure can be switched between two
+     * steps, or replaced by one written outside the engine, without touching the World. A step calls UpdateCollider or
+     * RemoveCollider for every collider, Rebalance once, then FindPossiblePairs; the queries see the structure of the
+     * last FindPossiblePairs.
+     *
+     * The class has the following public abstract methods:
+     * - `virtual void Init() noexcept = 0`: Clears the structure and preallocates its storage.
+     * - `virtual void Clear() noexcept = 0`: Removes every collider, the structure stays usable.
+     * - `virtual void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept = 0`: Registers a collider or updates its AABB.
+     * - `virtual void RemoveCollider(std::size_t colliderIndex) noexcept = 0`: Removes a collider, does nothing if it is not registered.
+     * - `virtual void FindPossiblePairs() noexcept = 0`: Fills the buffer returned by ColliderPairs with the overlapping colliders.
+     * - `virtual void FindPossiblePairs(PairCallback& callback) noexcept = 0`: Streams the overlapping colliders to a callback in chunks.
+     * - `virtual const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept = 0`: Returns the pairs of the last FindPossiblePairs.
+     * - `virtual void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept = 0`: Finds the colliders whose AABB overlaps an AABB.
+     *
+     * And the following public virtual methods, with a default implementation:
+     * - `virtual void Rebalance() noexcept`: Applies the deferred changes of the updates, does nothing by default.
+     * - `virtual void QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept`: Answers a batch of AABB queries, one by one by default.
+     * - `virtual void RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept`: Finds the colliders crossed by a packet of rays, with one AABB query per lane by default.
+     * - `virtual bool QueryNearest(Math::Vec2F point, std::size_t queryIndex, float maxSquareDistance, NearestCallback& callback) noexcept`: Finds the colliders nearest to a point, unsupported by default.
+     * - `virtual void VisitNodes(BroadPhaseVisitor& visitor) const noexcept`: Gives the nodes of the structure to a visitor, none by default.
+     */
+    class BroadPhase
+    {
+    public:
+        virtual ~BroadPhase() noexcept = default;
+
+        /**
+         * @brief Clears the structure and preallocates its storage.
+         */
+        virtual void Init() noexcept = 0;
+
+        /**
+         * @brief Removes every collider from the structure, which stays usable without another Init.
+         */
+        virtual void Clear() noexcept = 0;
+
+        /**
+         * @brief Registers a collider or updates its AABB.
+         * @param simplifedCollider The simplified collider with its tight AABB.
+         */
+        virtual void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept = 0;
+
+        /**
+         * @brief Removes a collider, does nothing if the collider is not registered.
+         * @param colliderIndex The index of the collider to remove.
+         */
+        virtual void RemoveCollider(std::size_t colliderIndex) noexcept = 0;
+
+        /**
+         * @brief Applies the changes the structure deferred while the colliders were updated, before the pairs are found.
+         * \n Note : Does nothing by default.
+         */
+        virtual void Rebalance() noexcept
+        {}
+
+        /**
+         * @brief Fills the buffer returned by ColliderPairs with every pair of colliders whose AABBs overlap.
+         * \n Note : Each pair is reported once, the pairs whose filters do not collide are left out.
+         */
+        virtual void FindPossiblePairs() noexcept = 0;
+
+        /**
+         * @brief Finds the same pairs as FindPossiblePairs, handing them to the callback in chunks of at most
+         * PairChunkSize pairs while they are found.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        virtual void FindPossiblePairs(PairCallback& callback) noexcept = 0;
+
+        /**
+         * @return The pairs found by the last FindPossiblePairs without a callback.
+         */
+        [[nodiscard]] virtual const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept = 0;
+
+        /**
+         * @brief Gives to the callback every collider whose stored AABB overlaps the given AABB.
+         * \n Note : A structure storing fat AABBs may give colliders whose tight AABB does not overlap the query.
+         * @param aabb The AABB to query.
+         * @param queryIndex The index given back to the callback with each collider found.
+         * @param callback The callback receiving the colliders found.
+         */
+        virtual void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept = 0;
+
+        /**
+         * @brief Answers a batch of AABB queries.
+         * \n Note : Runs QueryAABB for each AABB by default, a hierarchy can share its traversal between the queries.
+         * @param aabbs The AABBs to query, the index of an AABB in the array is its query index.
+         * @param queryCount The number of AABBs.
+         * @param callback The callback receiving the colliders found.
+         */
+        virtual void QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept;
+
+        /**
+         * @brief Gives to the callback every collider whose stored AABB may be crossed by some lanes of the packet.
+         * \n Note : By default each lane is an AABB query around the segment it sweeps, a hierarchy can instead walk
+         * its nodes once for the whole packet.
+         * @param packet The rays traversing the structure.
+         * @param callback The callback testing the colliders found.
+         */
+        virtual void RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept;
+
+        /**
+         * @brief Gives to the callback the colliders that may be the nearest to a point, closest first.
+         * \n Note : Not supported by default, the caller then looks for the nearest colliders with AABB queries.
+         * @param point The query point.
+         * @param queryIndex The index given back to the callback with each candidate.
+         * @param maxSquareDistance The square distance beyond which no collider is needed.
+         * @param callback The callback measuring the candidates.
+         * @return False if the structure does not support the query and gave no candidate.
+         */
+        virtual bool QueryNearest(Math::Vec2F point, std::size_t queryIndex, float maxSquareDistance,
+                                  NearestCallback& callback) noexcept;
+
+        /**
+         * @brief Gives the bounds of every node of the structure to the visitor, parents first.
+         * \n Note : A structure without nodes visits nothing by default.
+         * @param visitor The visitor receiving the nodes.
+         */
+        virtual void VisitNodes(BroadPhaseVisitor& visitor) const noexcept;
+    };
+}
@@ -0,0 +1,26 @@
+#pragma once
+
+#include "Shape.h"
+
+namespace Engine
+{
+    /**
+     * @class BroadPhaseVisitor
+     * @brief Interface walking the nodes of a broad phase structure, to draw or inspect them.
+     *
+     * The class has the following public abstract method:
+     * - `virtual void OnNode(const Math::RectangleF& bounds, int depth) noexcept = 0`: Called for each node of the structure.
+     *
+     * The visitor only sees the bounds of the nodes, so a debug view does not depend on the layout of the structure.
+     */
+    class BroadPhaseVisitor
+    {
+    public:
+        /**
+         * @brief Abstract method that is called for each node of a broad phase structure, parents before their children.
+         * @param bounds The region covered by the node.
+         * @param depth The depth of the node, 0 for a root node.
+         */
+        virtual void OnNode(const Math::RectangleF& bounds, int depth) noexcept = 0;
+    };
+}
@@ -0,0 +1,117 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+#include "AABB.h"
+#include "QueryCallback.h"
+#include "PairCallback.h"
+#include "BroadPhase.h"
+#include "Allocator.h"
+#include <cstddef>
+#ifdef TRACY_ENABLE
+#include <Tracy.hpp>
+#include <TracyC.h>
+#endif
+
+namespace Engine
+{
+    /**
+     * @struct BruteForceProxy
+     * @brief Represents a collider registered in the BruteForceBroadPhase.
+     *
+     * The struct has the following members:
+     * - `SimplifedCollider simplifedCollider`: The collider reference with its current AABB.
+     * - `bool isActive`: True while the collider is registered.
+     */
+    struct BruteForceProxy
+    {
+        SimplifedCollider simplifedCollider{ColliderRef{}, Math::RectangleF(Math::Vec2F::Zero(), Math::Vec2F::Zero())};
+        bool isActive = false;
+    };
+
+    /**
+     * @class BruteForceBroadPhase
+     * @brief Represents the reference broad phase, testing every pair of registered colliders.
+     *
+     * FindPossiblePairs is O(n²) and keeps no structure: it is the ground truth the other broad phases are checked
+     * against, see World::isCheckingBroadPhase, not a structure meant to run a simulation. Its tests are the plain
+     * Math::Intersect on the tight AABBs followed by ShouldCollide, with no packing nor SIMD that could share a bug
+     * with the structures it checks.
+     *
+     * The class has the following members:
+     * - `HeapAllocator heapAllocator`: An allocator for managing memory used by the broad phase.
+     * - `AllocatedVector<BruteForceProxy> proxies`: The registered colliders, indexed by collider index.
+     * - `AllocatedVector<ColliderPair> colliderPairs`: The pairs of colliders whose AABBs overlap.
+     *
+     * The class provides the following methods:
+     * - `void Init() noexcept`: Preallocates the colliders and the pairs.
+     * - `void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept`: Registers a collider or updates its AABB.
+     * - `void RemoveCollider(std::size_t colliderIndex) noexcept`: Removes a collider.
+     * - `void FindPossiblePairs() noexcept`: Fills colliderPairs with the overlapping colliders.
+     * - `void FindPossiblePairs(PairCallback& callback) noexcept`: Streams the overlapping colliders to a callback in chunks of PairChunkSize pairs.
+     * - `const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept`: Returns colliderPairs.
+     * - `void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept`: Finds the colliders whose AABB overlaps an AABB.
+     * - `void Clear() noexcept`: Removes every collider.
+     */
+    class BruteForceBroadPhase final : public BroadPhase
+    {
+    public:
+        HeapAllocator heapAllocator;
+        AllocatedVector <BruteForceProxy> proxies{StandardAllocator < BruteForceProxy > {heapAllocator}};
+        AllocatedVector <ColliderPair> colliderPairs{StandardAllocator < ColliderPair > {heapAllocator}};
+
+        BruteForceBroadPhase() noexcept = default;
+
+        /**
+         * @brief Preallocates the colliders and the collider pairs.
+         */
+        void Init() noexcept override;
+
+        /**
+         * @brief Registers a collider or updates its AABB.
+         * @param simplifedCollider The simplified collider with its tight AABB.
+         */
+        void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept override;
+
+        /**
+         * @brief Removes a collider, does nothing if the collider is not registered.
+         * @param colliderIndex The index of the collider to remove.
+         */
+        void RemoveCollider(std::size_t colliderIndex) noexcept override;
+
+        /**
+         * @brief Tests every pair of registered colliders and fills colliderPairs with the ones whose AABBs overlap.
+         * \n Note : Each pair is reported once, the pairs whose filters do not collide are left out.
+         */
+        void FindPossiblePairs() noexcept override;
+
+        /**
+         * @brief Finds the same pairs as FindPossiblePairs, handing them to the callback each time PairChunkSize of them
+         * are found instead of keeping them all.
+         * \n Note : colliderPairs is the chunk buffer, it is left empty.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        void FindPossiblePairs(PairCallback& callback) noexcept override;
+
+        /**
+         * @return colliderPairs, the pairs of the last FindPossiblePairs.
+         */
+        [[nodiscard]] const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept override;
+
+        /**
+         * @brief Gives to the callback every registered collider whose AABB overlaps the given AABB.
+         * @param aabb The AABB to query.
+         * @param queryIndex The index given back to the callback with each collider found.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Removes every collider and the pairs found.
+         */
+        void Clear() noexcept override;
+
+    private:
+        PairCallback* _pairCallback = nullptr;
+    };
+}
@@ -1,6 +1,8 @@
 #pragma once
 #include "Shape.h"
 #include "Body.h"
+#include "Intrinsics.h"
+#include <cstdint>
 #include <unordered_set>
 
 namespace Engine
@@ -33,6 +35,76 @@ namespace Engine
     };
 
 
+    /**
+     * @struct CollisionFilter
+     * @brief Represents the filtering data deciding which colliders can collide, tested by the broad phase before a pair is reported.
+     *
+     * Two colliders of the same non zero group always collide if the group is positive and never collide if it is
+     * negative. Otherwise, each collider must have the category of the other one in its mask.
+     *
+     * The struct has the following members:
+     * - `std::uint32_t categoryBits`: The categories the collider belongs to, usually a single bit.
+     * - `std::uint32_t maskBits`: The categories the collider collides with.
+     * - `std::int32_t groupIndex`: The group of the collider, 0 for no group.
+     */
+    struct CollisionFilter
+    {
+        std::uint32_t categoryBits = 1;
+        std::uint32_t maskBits = 0xFFFFFFFFu;
+        std::int32_t groupIndex = 0;
+    };
+
+    /**
+     * @return True if the colliders of the two filters can collide.
+     */
+    [[nodiscard]] constexpr bool ShouldCollide(const CollisionFilter& filterA, const CollisionFilter& filterB) noexcept
+    {
+        if (filterA.groupIndex == filterB.groupIndex && filterA.groupIndex != 0)
+        {
+            return filterA.groupIndex > 0;
+        }
+        return (filterA.maskBits & filterB.categoryBits) != 0 && (filterB.maskBits & filterA.categoryBits) != 0;
+    }
+
+    /**
+     * @brief Tests one filter against eight filters stored as structure of arrays, like ShouldCollide.
+     * \n Note : Eight values are read from each array, the arrays must be padded after the last filter.
+     * @param filter The filter tested against the packed ones.
+     * @param categoryBits, maskBits, groupIndices The packed filters.
+     * @return A mask whose bit i is set if the filter collides with the packed filter i.
+     */
+    [[nodiscard]] inline std::uint32_t FilterMask8(const CollisionFilter& filter, const std::uint32_t* categoryBits,
+                                                   const std::uint32_t* maskBits, const std::int32_t* groupIndices) noexcept
+    {
+#if defined(__AVX2__)
+        const __m256i zero = _mm256_setzero_si256();
+        const __m256i categories = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(categoryBits));
+        const __m256i masks = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(maskBits));
+        const __m256i isMaskedOut = _mm256_or_si256(
+                _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(filter.maskBits)), categories), zero),
+                _mm256_cmpeq_epi32(_mm256_and_si256(_mm256_set1_epi32(static_cast<int>(filter.categoryBits)), masks), zero));
+        auto collideMask = ~static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_castsi256_ps(isMaskedOut))) & 0xFFu;
+        if (filter.groupIndex == 0)
+        {
+            return collideMask;
+        }
+
+        // The colliders of the same group ignore the masks.
+        const __m256i groups = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(groupIndices));
+        const auto sameGroupMask = static_cast<std::uint32_t>(_mm256_movemask_ps(
+                _mm256_castsi256_ps(_mm256_cmpeq_epi32(_mm256_set1_epi32(filter.groupIndex), groups))));
+        return filter.groupIndex > 0 ? collideMask | sameGroupMask : collideMask & ~sameGroupMask;
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < 8; i++)
+        {
+            mask |= static_cast<std::uint32_t>(ShouldCollide(filter, CollisionFilter{categoryBits[i], maskBits[i],
+                                                                                     groupIndices[i]})) << i;
+        }
+        return mask;
+#endif
+    }
+
     /**
      * @class Collider
      * @brief Represents a collider in a physics simulation.
@@ -49,6 +121,7 @@ namespace Engine
      * - `int ID`: The unique identifier of the collider.
      * - `BodyRef bodyRef`: The reference to the physics body associated with the collider.
      * - `bool isTrigger`: A flag indicating if the collider is a trigger (does not participate in physical collisions).
+     * - `CollisionFilter filter`: The categories, mask and group deciding which colliders it can collide with.
      * - `bool IsValid() const noexcept`: Checks if the collider is valid based on its shape.
      * - `constexpr bool operator==(const Collider& other) const noexcept`: Equality comparison operator based on collider ID.
      * - `constexpr bool operator!=(const Collider& other) const noexcept`: Inequality comparison operator based on collider ID.
@@ -66,6 +139,7 @@ namespace Engine
         int ID = 0;
         BodyRef bodyRef{};
         bool isTrigger = false;
+        CollisionFilter filter{};
 
         Collider() noexcept = default;
 
@@ -96,6 +170,25 @@ namespace Engine
         }
     };
 
+    /**
+     * @struct SimplifiedCollider
+     * @brief Represents a simplified view of a collider with its reference and axis-aligned bounding box (AABB).
+     *
+     * The SimplifiedCollider struct provides a simplified representation of a collider, including its collider reference
+     * and its axis-aligned bounding box (AABB). It is useful for scenarios where a simplified view of a collider's data is needed.
+     *
+     * The struct has the following members:
+     * - `Engine::ColliderRef colliderRef`: The reference to the associated collider.
+     * - `Math::RectangleF aabb`: The axis-aligned bounding box (AABB) of the collider.
+     * - `CollisionFilter filter`: The filter of the collider, tested by the broad phase next to the AABB.
+     */
+    struct SimplifedCollider
+    {
+        Engine::ColliderRef colliderRef;
+        Math::RectangleF aabb;
+        CollisionFilter filter{};
+    };
+
     /**
     * @brief A ColliderPair contain 2 colliderRef
     **/
@@ -1,6 +1,15 @@
 #pragma once
 #include "Body.h"
 #include "Collider.h"
+#include "ContactManifold.h"
+#include "Const.h"
+#include "Intrinsics.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
 
 namespace Engine
 {
@@ -24,7 +33,9 @@ namespace Engine
      *
      * The Contact class encapsulates information about a contact point between two bodies, including colliding bodies,
      * contact normal, contact position, penetration depth, and restitution.
-     * It includes methods to calculate relative velocity, resolve velocity, resolve interpenetration, and resolve the collision.
+     * It is solved with sequential impulses: Prepare computes what the solver needs once, then each ResolveVelocity
+     * iteration corrects the impulse accumulated along the normal, which stays positive so the bodies are only pushed
+     * apart. The impulse accumulated on a step can warm start the contact of the same pair on the next step.
      *
      * The class has the following public properties and methods:
      * - `std::array<CollidingBody, 2> collidingBodies`: An array of two CollidingBody instances representing the bodies involved in the collision.
@@ -32,10 +43,17 @@ namespace Engine
      * - `Math::Vec2F contactPosition`: The position of the contact point.
      * - `float penetration`: The penetration depth indicating how much the bodies overlap.
      * - `float restitution`: The restitution coefficient for the collision.
+     * - `std::array<float, 2> inverseMasses`: The inverse mass of each body, 0 for a body the contact cannot move.
+     * - `float normalMass`: The mass seen by an impulse along the normal, 0 when neither body can move.
+     * - `float velocityBias`: The separating velocity the solver aims for, the bounce given by the restitution.
+     * - `float normalImpulse`: The impulse accumulated along the normal by the iterations of the solver.
      * - `float CalculateSeparateVelocity() const noexcept`: Calculates the relative velocity of colliding bodies along the contact normal.
-     * - `void ResolveVelocity() const noexcept`: Resolves the velocity of colliding bodies based on their relative velocity and restitution.
+     * - `void Prepare(const ContactManifold& manifold) noexcept`: Sets the contact from a manifold and computes the masses and the bias of the solver.
+     * - `void WarmStart() const noexcept`: Applies normalImpulse to the bodies, before the first iteration.
+     * - `void ResolveVelocity() noexcept`: Runs one iteration of the solver, correcting normalImpulse and the velocities.
      * - `void ResolveInterpenetration() const noexcept`: Resolves interpenetration of colliding bodies by adjusting their positions.
      * - `void Resolve()`: Resolves the collision by determining the contact normal, penetration, and applying velocity and position corrections.
+     * - `void Resolve(const ContactManifold& manifold) noexcept`: Resolves the collision described by a manifold computed beforehand.
      *
      * This class is crucial for handling collision responses, ensuring realistic physics interactions between bodies.
      */
@@ -47,6 +65,10 @@ namespace Engine
         Math::Vec2F contactPosition{};
         float penetration = 0.0f;
         float restitution = 0.0f;
+        std::array<float, 2> inverseMasses{};
+        float normalMass = 0.0f;
+        float velocityBias = 0.0f;
+        float normalImpulse = 0.0f;
 
         /**
          * @brief Calculates the relative velocity of colliding bodies along the contact normal.
@@ -55,18 +77,182 @@ namespace Engine
         float CalculateSeparateVelocity() const noexcept;
 
         /**
-         * @brief Resolves the velocity of colliding bodies based on their relative velocity and restitution.
+         * @brief Sets contactNormal, penetration and contactPosition from the manifold, then computes the restitution,
+         * the inverse masses, normalMass and velocityBias from the bodies as they are before the solve.
+         * \n Note : normalImpulse is left as is, it is 0 unless a previous impulse is given to warm start the contact.
+         * @param manifold The manifold of the colliding bodies, with at least one contact point.
+         */
+        void Prepare(const ContactManifold& manifold) noexcept;
+
+        /**
+         * @brief Applies normalImpulse to the bodies, so the solve starts from the impulse of the previous step.
+         */
+        void WarmStart() const noexcept;
+
+        /**
+         * @brief Runs one iteration of the solver: applies the impulse that brings the separating velocity to
+         * velocityBias, clamped so that normalImpulse never becomes negative.
+         * \n Note : Prepare must be called first.
          */
-        void ResolveVelocity() const noexcept;
+        void ResolveVelocity() noexcept;
 
         /**
          * @brief Resolves interpenetration of colliding bodies by adjusting their positions.
+         * \n Note : The penetration is split between the bodies according to inverseMasses.
          */
         void ResolveInterpenetration() const noexcept;
 
         /**
          * @brief Resolves the collision by determining the contact normal, penetration, and applying velocity and position corrections.
+         * \n Note : The manifold is computed by Collide from the shapes of the colliders.
          */
         void Resolve();
+
+        /**
+         * @brief Resolves the collision described by the manifold, which sets contactNormal, penetration and
+         * contactPosition, without measuring the shapes again.
+         * \n Note : A single iteration of the solver, from normalImpulse as it is.
+         * @param manifold The manifold of the colliding bodies, with at least one contact point.
+         */
+        void Resolve(const ContactManifold& manifold) noexcept;
+
+    private:
+        void applyImpulse(float impulse) const noexcept;
     };
+
+    /**
+     * @brief The number of circle pairs tested at once by CircleContacts8, and of contacts solved at once by
+     * SolveContacts8.
+     */
+    static constexpr std::size_t ContactBatchSize = 8;
+
+    /**
+     * @brief Tests eight pairs of circles stored as structure of arrays, and computes the contact of each pair.
+     * \n Note : Eight values are read from each input array and written to each output array, the arrays must be
+     * padded after the last pair.
+     * @param centerAX, centerAY, centerBX, centerBY The centers of the first and of the second circle of each pair.
+     * @param radiusSum The sum of the radii of each pair.
+     * @param normalX, normalY Receive the unit normal of each pair, from the second circle towards the first one,
+     * (0, 1) when the centers are closer than Math::Epsilon.
+     * @param penetration Receives the depth of each overlap, negative for the pairs that do not overlap.
+     * @return A mask whose bit i is set if the circles of the pair i overlap, touching circles overlap like Math::Intersect.
+     */
+    [[nodiscard]] inline std::uint32_t CircleContacts8(const float* centerAX, const float* centerAY,
+                                                       const float* centerBX, const float* centerBY,
+                                                       const float* radiusSum, float* normalX, float* normalY,
+                                                       float* penetration) noexcept
+    {
+#if defined(__AVX__)
+        const __m256 deltaX = _mm256_sub_ps(_mm256_loadu_ps(centerAX), _mm256_loadu_ps(centerBX));
+        const __m256 deltaY = _mm256_sub_ps(_mm256_loadu_ps(centerAY), _mm256_loadu_ps(centerBY));
+        const __m256 radii = _mm256_loadu_ps(radiusSum);
+        const __m256 squareDistance = _mm256_add_ps(_mm256_mul_ps(deltaX, deltaX), _mm256_mul_ps(deltaY, deltaY));
+        const __m256 isOverlapping = _mm256_cmp_ps(squareDistance, _mm256_mul_ps(radii, radii), _CMP_LE_OQ);
+
+        // The concentric lanes divide by Math::Epsilon, the blend then replaces their normal by (0, 1).
+        const __m256 distance = _mm256_sqrt_ps(squareDistance);
+        const __m256 hasDirection = _mm256_cmp_ps(distance, _mm256_set1_ps(Math::Epsilon), _CMP_GT_OQ);
+        const __m256 inverseDistance = _mm256_div_ps(_mm256_set1_ps(1.0f),
+                                                     _mm256_max_ps(distance, _mm256_set1_ps(Math::Epsilon)));
+        _mm256_storeu_ps(normalX, _mm256_blendv_ps(_mm256_setzero_ps(), _mm256_mul_ps(deltaX, inverseDistance),
+                                                   hasDirection));
+        _mm256_storeu_ps(normalY, _mm256_blendv_ps(_mm256_set1_ps(1.0f), _mm256_mul_ps(deltaY, inverseDistance),
+                                                   hasDirection));
+        _mm256_storeu_ps(penetration, _mm256_sub_ps(radii, distance));
+        return static_cast<std::uint32_t>(_mm256_movemask_ps(isOverlapping));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t i = 0; i < ContactBatchSize; i++)
+        {
+            const float deltaX = centerAX[i] - centerBX[i];
+            const float deltaY = centerAY[i] - centerBY[i];
+            const float squareDistance = deltaX * deltaX + deltaY * deltaY;
+            const float distance = std::sqrt(squareDistance);
+            const bool hasDirection = distance > Math::Epsilon;
+            normalX[i] = hasDirection ? deltaX / distance : 0.0f;
+            normalY[i] = hasDirection ? deltaY / distance : 1.0f;
+            penetration[i] = radiusSum[i] - distance;
+            mask |= static_cast<std::uint32_t>(squareDistance <= radiusSum[i] * radiusSum[i]) << i;
+        }
+        return mask;
+#endif
+    }
+
+    /**
+     * @brief Runs one iteration of Contact::ResolveVelocity on eight contacts stored as structure of arrays.
+     * The velocities of the bodies are gathered from the packed velocities, solved, then scattered back.
+     * \n Note : The eight contacts must not share a body with a non zero inverse mass, a lane whose normalMass and
+     * inverse masses are 0 changes nothing and can pad the last batch.
+     * @param normalX, normalY, normalMass, velocityBias, inverseMassA, inverseMassB The rows of the contacts, as
+     * computed by Contact::Prepare.
+     * @param bodyA, bodyB The index of the first and of the second body of each contact in the packed velocities.
+     * @param velocityX, velocityY The packed velocities of the bodies, read and written at the body indices.
+     * @param normalImpulse The impulse accumulated by each contact, updated like Contact::normalImpulse.
+     */
+    inline void SolveContacts8(const float* normalX, const float* normalY, const float* normalMass,
+                               const float* velocityBias, const float* inverseMassA, const float* inverseMassB,
+                               const std::int32_t* bodyA, const std::int32_t* bodyB, float* velocityX,
+                               float* velocityY, float* normalImpulse) noexcept
+    {
+#if defined(__AVX2__)
+        const __m256i indexA = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bodyA));
+        const __m256i indexB = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bodyB));
+        __m256 velocityAX = _mm256_i32gather_ps(velocityX, indexA, 4);
+        __m256 velocityAY = _mm256_i32gather_ps(velocityY, indexA, 4);
+        __m256 velocityBX = _mm256_i32gather_ps(velocityX, indexB, 4);
+        __m256 velocityBY = _mm256_i32gather_ps(velocityY, indexB, 4);
+        const __m256 directionX = _mm256_loadu_ps(normalX);
+        const __m256 directionY = _mm256_loadu_ps(normalY);
+
+        const __m256 separatingVelocity = _mm256_add_ps(
+                _mm256_mul_ps(_mm256_sub_ps(velocityAX, velocityBX), directionX),
+                _mm256_mul_ps(_mm256_sub_ps(velocityAY, velocityBY), directionY));
+        const __m256 impulse = _mm256_mul_ps(_mm256_sub_ps(_mm256_loadu_ps(velocityBias), separatingVelocity),
+                                             _mm256_loadu_ps(normalMass));
+        const __m256 previousImpulse = _mm256_loadu_ps(normalImpulse);
+        const __m256 accumulatedImpulse = _mm256_max_ps(_mm256_add_ps(previousImpulse, impulse), _mm256_setzero_ps());
+        _mm256_storeu_ps(normalImpulse, accumulatedImpulse);
+
+        const __m256 deltaImpulse = _mm256_sub_ps(accumulatedImpulse, previousImpulse);
+        const __m256 impulseX = _mm256_mul_ps(directionX, deltaImpulse);
+        const __m256 impulseY = _mm256_mul_ps(directionY, deltaImpulse);
+        const __m256 inverseA = _mm256_loadu_ps(inverseMassA);
+        const __m256 inverseB = _mm256_loadu_ps(inverseMassB);
+        velocityAX = _mm256_add_ps(velocityAX, _mm256_mul_ps(impulseX, inverseA));
+        velocityAY = _mm256_add_ps(velocityAY, _mm256_mul_ps(impulseY, inverseA));
+        velocityBX = _mm256_sub_ps(velocityBX, _mm256_mul_ps(impulseX, inverseB));
+        velocityBY = _mm256_sub_ps(velocityBY, _mm256_mul_ps(impulseY, inverseB));
+
+        // AVX2 has no scatter, the lanes are written back one by one. A body shared by several lanes has no inverse
+        // mass, every lane writes its unchanged velocity.
+        alignas(32) float solvedAX[ContactBatchSize], solvedAY[ContactBatchSize];
+        alignas(32) float solvedBX[ContactBatchSize], solvedBY[ContactBatchSize];
+        _mm256_store_ps(solvedAX, velocityAX);
+        _mm256_store_ps(solvedAY, velocityAY);
+        _mm256_store_ps(solvedBX, velocityBX);
+        _mm256_store_ps(solvedBY, velocityBY);
+        for (std::size_t i = 0; i < ContactBatchSize; i++)
+        {
+            velocityX[bodyA[i]] = solvedAX[i];
+            velocityY[bodyA[i]] = solvedAY[i];
+            velocityX[bodyB[i]] = solvedBX[i];
+            velocityY[bodyB[i]] = solvedBY[i];
+        }
+#else
+        for (std::size_t i = 0; i < ContactBatchSize; i++)
+        {
+            const float separatingVelocity = (velocityX[bodyA[i]] - velocityX[bodyB[i]]) * normalX[i] +
+                                             (velocityY[bodyA[i]] - velocityY[bodyB[i]]) * normalY[i];
+            const float impulse = (velocityBias[i] - separatingVelocity) * normalMass[i];
+            const float accumulatedImpulse = std::max(normalImpulse[i] + impulse, 0.0f);
+            const float deltaImpulse = accumulatedImpulse - normalImpulse[i];
+            normalImpulse[i] = accumulatedImpulse;
+
+            velocityX[bodyA[i]] += normalX[i] * deltaImpulse * inverseMassA[i];
+            velocityY[bodyA[i]] += normalY[i] * deltaImpulse * inverseMassA[i];
+            velocityX[bodyB[i]] -= normalX[i] * deltaImpulse * inverseMassB[i];
+            velocityY[bodyB[i]] -= normalY[i] * deltaImpulse * inverseMassB[i];
+        }
+#endif
+    }
 }
\ No newline at end of file
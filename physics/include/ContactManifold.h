@@ -0,0 +1,235 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+namespace Engine
+{
+    /**
+     * @struct ContactManifold
+     * @brief Represents how two shapes touch, computed once per pair by a collide function and given to the Contact.
+     *
+     * The struct has the following members:
+     * - `static constexpr std::size_t MaxPointCount`: The most contact points of a manifold, two for faces resting on each other.
+     * - `Math::Vec2F normal`: The unit normal pointing from the second shape towards the first one.
+     * - `float depth`: The penetration depth along the normal, 0 for shapes that only touch.
+     * - `std::array<Math::Vec2F, MaxPointCount> points`: The contact points, only the first pointCount are set.
+     * - `std::size_t pointCount`: The number of contact points, 0 when the shapes do not touch.
+     * - `bool HasContact() const noexcept`: Checks if the shapes touch.
+     */
+    struct ContactManifold
+    {
+        static constexpr std::size_t MaxPointCount = 2;
+
+        Math::Vec2F normal{0.0f, 1.0f};
+        float depth = 0.0f;
+        std::array<Math::Vec2F, MaxPointCount> points{};
+        std::size_t pointCount = 0;
+
+        [[nodiscard]] bool HasContact() const noexcept { return pointCount != 0; }
+    };
+
+    /**
+     * @brief Computes the manifold of two circles, with one contact point halfway between their surfaces.
+     * \n Note : The circles touch like Math::Intersect, the normal of concentric circles is (0, 1).
+     */
+    [[nodiscard]] ContactManifold CollideCircles(const Math::CircleF& circleA, const Math::CircleF& circleB) noexcept;
+
+    /**
+     * @brief Computes the manifold of a circle and a rectangle, the normal pointing towards the circle and the contact
+     * point on the rectangle.
+     * \n Note : A circle whose center is inside the rectangle is pushed out through the closest side.
+     */
+    [[nodiscard]] ContactManifold CollideCircleRectangle(const Math::CircleF& circle,
+                                                         const Math::RectangleF& rectangle) noexcept;
+
+    /**
+     * @brief Computes the manifold of a rectangle and a circle, CollideCircleRectangle with the normal reversed.
+     */
+    [[nodiscard]] ContactManifold CollideRectangleCircle(const Math::RectangleF& rectangle,
+                                                         const Math::CircleF& circle) noexcept;
+
+    /**
+     * @brief Computes the manifold of two axis aligned rectangles, separated along the axis of least overlap.
+     * \n Note : The contact points are the ends of the overlap of the touching sides, one point if it is a corner.
+     */
+    [[nodiscard]] ContactManifold CollideRectangles(const Math::RectangleF& rectangleA,
+                                                    const Math::RectangleF& rectangleB) noexcept;
+
+    /**
+     * @brief The number of Math::ShapeType values, None included.
+     */
+    static constexpr std::size_t ShapeTypeCount = static_cast<std::size_t>(Math::ShapeType::None) + 1;
+
+    /**
+     * @brief The number of ordered pairs of shape types, the size of the dispatch tables.
+     */
+    static constexpr std::size_t ShapePairCount = ShapeTypeCount * ShapeTypeCount;
+
+    /**
+     * @return The index of an ordered pair of shape types in the dispatch tables.
+     */
+    [[nodiscard]] constexpr std::size_t ShapePairIndex(Math::ShapeType shapeA, Math::ShapeType shapeB) noexcept
+    {
+        return static_cast<std::size_t>(shapeA) * ShapeTypeCount + static_cast<std::size_t>(shapeB);
+    }
+
+    /**
+     * @struct ShapePairCollider
+     * @brief Gives the intersection test and the collide function of an ordered pair of shape types.
+     *
+     * The primary template is the pair of shapes that never collide, each supported pair is a specialization. The
+     * dispatch tables are generated from it, so supporting a new pair of shapes is one more specialization.
+     *
+     * The struct has the following static methods:
+     * - `static bool Intersect(const Collider& colliderA, const Collider& colliderB) noexcept`: Checks if the shapes touch, like Math::Intersect.
+     * - `static ContactManifold Collide(const Collider& colliderA, const Collider& colliderB) noexcept`: Computes the manifold of the shapes.
+     */
+    template<Math::ShapeType ShapeA, Math::ShapeType ShapeB>
+    struct ShapePairCollider
+    {
+        static bool Intersect(const Collider&, const Collider&) noexcept { return false; }
+
+        static ContactManifold Collide(const Collider&, const Collider&) noexcept { return ContactManifold{}; }
+    };
+
+    template<>
+    struct ShapePairCollider<Math::ShapeType::Circle, Math::ShapeType::Circle>
+    {
+        static bool Intersect(const Collider& colliderA, const Collider& colliderB) noexcept
+        {
+            return Math::Intersect(colliderA.circleShape, colliderB.circleShape);
+        }
+
+        static ContactManifold Collide(const Collider& colliderA, const Collider& colliderB) noexcept
+        {
+            return CollideCircles(colliderA.circleShape, colliderB.circleShape);
+        }
+    };
+
+    template<>
+    struct ShapePairCollider<Math::ShapeType::Circle, Math::ShapeType::Rectangle>
+    {
+        static bool Intersect(const Collider& colliderA, const Collider& colliderB) noexcept
+        {
+            return Math::Intersect(colliderA.circleShape, colliderB.rectangleShape);
+        }
+
+        static ContactManifold Collide(const Collider& colliderA, const Collider& colliderB) noexcept
+        {
+            return CollideCircleRectangle(colliderA.circleShape, colliderB.rectangleShape);
+        }
+    };
+
+    template<>
+    struct ShapePairCollider<Math::ShapeType::Rectangle, Math::ShapeType::Circle>
+    {
+        static bool Intersect(const Collider& colliderA, const Collider& colliderB) noexcept
+        {
+            return Math::Intersect(colliderA.rectangleShape, colliderB.circleShape);
+        }
+
+        static ContactManifold Collide(const Collider& colliderA, const Collider& colliderB) noexcept
+        {
+            return CollideRectangleCircle(colliderA.rectangleShape, colliderB.circleShape);
+        }
+    };
+
+    template<>
+    struct ShapePairCollider<Math::ShapeType::Rectangle, Math::ShapeType::Rectangle>
+    {
+        static bool Intersect(const Collider& colliderA, const Collider& colliderB) noexcept
+        {
+            return Math::Intersect(colliderA.rectangleShape, colliderB.rectangleShape);
+        }
+
+        static ContactManifold Collide(const Collider& colliderA, const Collider& colliderB) noexcept
+        {
+            return CollideRectangles(colliderA.rectangleShape, colliderB.rectangleShape);
+        }
+    };
+
+    /**
+     * @brief Computes the manifolds of a bucket of pairs sharing the same ordered pair of shape types, with the collide
+     * function of the pair inlined in the loop.
+     * @param colliders The colliders of the World, indexed by the collider references of the pairs.
+     * @param pairs The pairs being resolved.
+     * @param pairIndices The indices in pairs of the pairs of the bucket.
+     * @param pairCount The number of pairs of the bucket.
+     * @param manifolds The manifolds of the pairs, the manifold of pairs[i] is written at manifolds[i].
+     */
+    template<Math::ShapeType ShapeA, Math::ShapeType ShapeB>
+    void CollideBucket(const Collider* colliders, const ColliderPair* pairs, const std::uint32_t* pairIndices,
+                       std::size_t pairCount, ContactManifold* manifolds) noexcept
+    {
+        for (std::size_t i = 0; i < pairCount; i++)
+        {
+            const auto& pair = pairs[pairIndices[i]];
+            manifolds[pairIndices[i]] = ShapePairCollider<ShapeA, ShapeB>::Collide(colliders[pair.colliderA.index],
+                                                                                   colliders[pair.colliderB.index]);
+        }
+    }
+
+    using IntersectFunction = bool (*)(const Collider&, const Collider&) noexcept;
+    using CollideFunction = ContactManifold (*)(const Collider&, const Collider&) noexcept;
+    using CollideBucketFunction = void (*)(const Collider*, const ColliderPair*, const std::uint32_t*, std::size_t,
+                                           ContactManifold*) noexcept;
+
+    namespace ShapePairDispatch
+    {
+        template<std::size_t PairIndex>
+        static constexpr auto ShapeA = static_cast<Math::ShapeType>(PairIndex / ShapeTypeCount);
+
+        template<std::size_t PairIndex>
+        static constexpr auto ShapeB = static_cast<Math::ShapeType>(PairIndex % ShapeTypeCount);
+
+        template<std::size_t... PairIndices>
+        constexpr std::array<IntersectFunction, ShapePairCount> MakeIntersectTable(std::index_sequence<PairIndices...>) noexcept
+        {
+            return {{&ShapePairCollider<ShapeA<PairIndices>, ShapeB<PairIndices>>::Intersect...}};
+        }
+
+        template<std::size_t... PairIndices>
+        constexpr std::array<CollideFunction, ShapePairCount> MakeCollideTable(std::index_sequence<PairIndices...>) noexcept
+        {
+            return {{&ShapePairCollider<ShapeA<PairIndices>, ShapeB<PairIndices>>::Collide...}};
+        }
+
+        template<std::size_t... PairIndices>
+        constexpr std::array<CollideBucketFunction, ShapePairCount> MakeCollideBucketTable(
+                std::index_sequence<PairIndices...>) noexcept
+        {
+            return {{&CollideBucket<ShapeA<PairIndices>, ShapeB<PairIndices>>...}};
+        }
+    }
+
+    /**
+     * @brief The intersection tests of ShapePairCollider, indexed by ShapePairIndex.
+     */
+    static constexpr auto IntersectTable = ShapePairDispatch::MakeIntersectTable(std::make_index_sequence<ShapePairCount>{});
+
+    /**
+     * @brief The collide functions of ShapePairCollider, indexed by ShapePairIndex.
+     */
+    static constexpr auto CollideTable = ShapePairDispatch::MakeCollideTable(std::make_index_sequence<ShapePairCount>{});
+
+    /**
+     * @brief The CollideBucket loops, indexed by ShapePairIndex.
+     */
+    static constexpr auto CollideBucketTable = ShapePairDispatch::MakeCollideBucketTable(
+            std::make_index_sequence<ShapePairCount>{});
+
+    /**
+     * @brief Computes the manifold of two colliders with the collide function of their shapes, read from CollideTable.
+     * \n Note : The manifold has no contact if a shape is not a circle nor a rectangle.
+     */
+    [[nodiscard]] inline ContactManifold Collide(const Collider& colliderA, const Collider& colliderB) noexcept
+    {
+        return CollideTable[ShapePairIndex(colliderA._shape, colliderB._shape)](colliderA, colliderB);
+    }
+}
@@ -0,0 +1,206 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+#include "AABB.h"
+#include "QueryCallback.h"
+#include "PairCallback.h"
+#include "BroadPhase.h"
+#include "Allocator.h"
+#include <cstdint>
+#include <vector>
+#ifdef TRACY_ENABLE
+#include <Tracy.hpp>
+#include <TracyC.h>
+#endif
+
+namespace Engine
+{
+    /**
+     * @struct KdTreeEntry
+     * @brief Represents a collider sorted by the KdTree build, keyed by the center of its AABB.
+     *
+     * The struct has the following members:
+     * - `float centerX, centerY`: The center of the collider AABB.
+     * - `std::uint32_t colliderIndex`: The index of the collider.
+     */
+    struct KdTreeEntry
+    {
+        float centerX;
+        float centerY;
+        std::uint32_t colliderIndex;
+    };
+
+    /**
+     * @struct KdTreeNode
+     * @brief Represents a node of the KdTree, covering a contiguous range of the sorted entries.
+     *
+     * The struct has the following members:
+     * - `Math::RectangleF bounds`: The union of the AABBs of the colliders in the node.
+     * - `std::uint32_t begin, end`: The range of the entries of the node.
+     * - `std::uint32_t rightChild`: The index of the right child, 0 for a leaf. The left child follows the node.
+     */
+    struct KdTreeNode
+    {
+        Math::RectangleF bounds{Math::Vec2F::Zero(), Math::Vec2F::Zero()};
+        std::uint32_t begin = 0;
+        std::uint32_t end = 0;
+        std::uint32_t rightChild = 0;
+
+        [[nodiscard]] bool IsLeaf() const noexcept { return rightChild == 0; }
+    };
+
+    /**
+     * @struct KdTreeProxy
+     * @brief Represents a collider registered in the KdTree.
+     *
+     * The struct has the following members:
+     * - `SimplifedCollider simplifedCollider`: The collider reference with its current AABB.
+     * - `bool isActive`: True while the collider is in the tree.
+     */
+    struct KdTreeProxy
+    {
+        SimplifedCollider simplifedCollider{ColliderRef{}, Math::RectangleF(Math::Vec2F::Zero(), Math::Vec2F::Zero())};
+        bool isActive = false;
+    };
+
+    /**
+     * @class KdTree
+     * @brief Represents a balanced 2D tree rebuilt in bulk each step by splitting the colliders at their median.
+     *
+     * The build partitions the entries with std::nth_element around the median of the AABB centers, alternating
+     * between the x axis and the y axis at each depth, until a node holds at most leafSize colliders. Both halves of a
+     * split have the same size give or take one, so the leaves are balanced whatever the distribution of the colliders,
+     * and the build is O(n log n). The colliders of a leaf are contiguous and packed as structure of arrays: the pairs
+     * are found inside each leaf, then between the leaves whose bounds overlap, reading the packed AABBs eight at a time.
+     *
+     * The class has the following members:
+     * - `HeapAllocator heapAllocator`: An allocator for managing memory used by the tree.
+     * - `AllocatedVector<KdTreeProxy> proxies`: The registered colliders, indexed by collider index.
+     * - `AllocatedVector<KdTreeEntry> entries`: The colliders in the order of the leaves.
+     * - `AllocatedVector<KdTreeNode> nodes`: The nodes in depth first order, the root first.
+     * - `AllocatedVector<ColliderPair> colliderPairs`: The pairs of colliders whose AABBs overlap.
+     * - `std::uint32_t leafSize`: The maximum number of colliders of a leaf, can be changed between two builds.
+     * - `static constexpr std::uint32_t DefaultLeafSize`: The default value of leafSize.
+     *
+     * The class provides the following methods:
+     * - `void Init() noexcept`: Preallocates the tree storage.
+     * - `void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept`: Registers a collider or updates its AABB.
+     * - `void RemoveCollider(std::size_t colliderIndex) noexcept`: Removes a collider from the tree.
+     * - `void FindPossiblePairs() noexcept`: Rebuilds the tree and fills colliderPairs with the overlapping colliders.
+     * - `void FindPossiblePairs(PairCallback& callback) noexcept`: Streams the overlapping colliders to a callback in chunks of PairChunkSize pairs.
+     * - `const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept`: Returns colliderPairs.
+     * - `void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept`: Finds the colliders whose AABB overlaps an AABB.
+     * - `void VisitNodes(BroadPhaseVisitor& visitor) const noexcept`: Gives the bounds and depth of every node to a visitor.
+     * - `void Clear() noexcept`: Clears the tree, resetting it to an empty state.
+     */
+    class KdTree final : public BroadPhase
+    {
+    public:
+        static constexpr std::uint32_t DefaultLeafSize = 8;
+
+        HeapAllocator heapAllocator;
+        AllocatedVector <KdTreeProxy> proxies{StandardAllocator < KdTreeProxy > {heapAllocator}};
+        AllocatedVector <KdTreeEntry> entries{StandardAllocator < KdTreeEntry > {heapAllocator}};
+        AllocatedVector <KdTreeNode> nodes{StandardAllocator < KdTreeNode > {heapAllocator}};
+        AllocatedVector <ColliderPair> colliderPairs{StandardAllocator < ColliderPair > {heapAllocator}};
+        std::uint32_t leafSize = DefaultLeafSize;
+
+        KdTree() noexcept = default;
+
+        /**
+         * @brief Preallocates the tree storage and the collider pairs.
+         * \n Note : A leafSize of 0 is raised to 1.
+         */
+        void Init() noexcept override;
+
+        /**
+         * @brief Registers a collider or updates its AABB, the tree is rebuilt on the next FindPossiblePairs.
+         * @param simplifedCollider The simplified collider with its tight AABB.
+         */
+        void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept override;
+
+        /**
+         * @brief Removes a collider from the tree, does nothing if the collider is not registered.
+         * @param colliderIndex The index of the collider to remove.
+         */
+        void RemoveCollider(std::size_t colliderIndex) noexcept override;
+
+        /**
+         * @brief Rebuilds the tree and fills colliderPairs with every pair of colliders whose AABBs overlap.
+         * \n Note : Each pair is reported once, the pairs whose filters do not collide are left out.
+         */
+        void FindPossiblePairs() noexcept override;
+
+        /**
+         * @brief Finds the same pairs as FindPossiblePairs, handing them to the callback each time PairChunkSize of them
+         * are found instead of keeping them all.
+         * \n Note : colliderPairs is the chunk buffer, it is left empty.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        void FindPossiblePairs(PairCallback& callback) noexcept override;
+
+        /**
+         * @return colliderPairs, the pairs of the last FindPossiblePairs.
+         */
+        [[nodiscard]] const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept override;
+
+        /**
+         * @brief Gives to the callback every collider whose AABB overlaps the given AABB, descending only in the nodes
+         * whose bounds overlap it.
+         * \n Note : The tree is the one built by the last FindPossiblePairs.
+         * @param aabb The AABB to query.
+         * @param queryIndex The index given back to the callback with each collider found.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Clears the tree, resetting it to an empty state.
+         */
+        void Clear() noexcept override;
+
+        /**
+         * @brief Gives the bounds of every node of the last build to the visitor, the root first.
+         * @param visitor The visitor receiving the nodes.
+         */
+        void VisitNodes(BroadPhaseVisitor& visitor) const noexcept override;
+
+    private:
+        PairCallback* _pairCallback = nullptr;
+        AllocatedVector <float> _packedMinX{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMinY{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMaxX{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMaxY{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _packedCategoryBits{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _packedMaskBits{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <std::int32_t> _packedGroupIndices{StandardAllocator < std::int32_t > {heapAllocator}};
+
+        /**
+         * @brief Builds the subtree of the entries in [begin, end), splitting them at their median on the axis of the depth.
+         * @return The index of the root node of the subtree.
+         */
+        std::uint32_t buildNode(std::uint32_t begin, std::uint32_t end, std::uint32_t depth) noexcept;
+
+        /**
+         * @brief Finds the pairs inside the subtree of a node, then the pairs between its two children.
+         */
+        void findPairs(std::uint32_t nodeIndex) noexcept;
+
+        /**
+         * @brief Finds the pairs between the colliders of two disjoint subtrees, descending in the larger one until
+         * both nodes are leaves.
+         */
+        void findPairs(std::uint32_t nodeIndexA, std::uint32_t nodeIndexB) noexcept;
+
+        /**
+         * @brief Adds the pairs between the entry i and the entries in [begin, end) whose AABBs overlap it.
+         */
+        void addOverlappingPairs(std::uint32_t i, std::uint32_t begin, std::uint32_t end) noexcept;
+
+        void visitNode(std::uint32_t nodeIndex, int depth, BroadPhaseVisitor& visitor) const noexcept;
+
+        void queryNode(const Math::RectangleF& aabb, std::uint32_t nodeIndex, std::size_t queryIndex,
+                       QueryCallback& callback) const noexcept;
+    };
+}
@@ -0,0 +1,175 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+#include "AABB.h"
+#include "QueryCallback.h"
+#include "PairCallback.h"
+#include "BroadPhase.h"
+#include "Allocator.h"
+#include <cstdint>
+#include <vector>
+#ifdef TRACY_ENABLE
+#include <Tracy.hpp>
+#include <TracyC.h>
+#endif
+
+namespace Engine
+{
+    /**
+     * @struct LinearQuadTreeEntry
+     * @brief Represents a collider placed in a node of the LinearQuadTree.
+     *
+     * The struct has the following members:
+     * - `std::uint64_t key`: The Morton code of the first deepest cell covered by the node, followed by the node level.
+     * - `std::uint32_t colliderIndex`: The index of the collider stored in the node.
+     */
+    struct LinearQuadTreeEntry
+    {
+        std::uint64_t key;
+        std::uint32_t colliderIndex;
+    };
+
+    /**
+     * @struct LinearQuadTreeProxy
+     * @brief Represents a collider registered in the LinearQuadTree.
+     *
+     * The struct has the following members:
+     * - `SimplifedCollider simplifedCollider`: The collider reference with its current AABB.
+     * - `bool isActive`: True while the collider is in the tree.
+     */
+    struct LinearQuadTreeProxy
+    {
+        SimplifedCollider simplifedCollider{ColliderRef{}, Math::RectangleF(Math::Vec2F::Zero(), Math::Vec2F::Zero())};
+        bool isActive = false;
+    };
+
+    /**
+     * @class LinearQuadTree
+     * @brief Represents a pointer-free quadtree whose nodes are implied by the Morton (Z-order) keys of the colliders.
+     *
+     * Each collider is placed in the deepest node fully containing its AABB, found from the highest bit that differs
+     * between the quantized coordinates of its min and max bounds. The node is encoded as the Morton code of its first
+     * cell at MaxLevel followed by its level, so sorting the keys lays the colliders out in depth first order: a node
+     * comes before its descendants and the colliders of a subtree are contiguous. The keys are sorted with a radix
+     * sort, which makes the build O(n), and the pairs are found like in the QuadTree by testing each collider against
+     * the colliders after it in its subtree, reading the packed AABBs sequentially eight at a time.
+     *
+     * The class has the following members:
+     * - `HeapAllocator heapAllocator`: An allocator for managing memory used by the tree.
+     * - `AllocatedVector<LinearQuadTreeProxy> proxies`: The registered colliders, indexed by collider index.
+     * - `AllocatedVector<LinearQuadTreeEntry> entries`: The colliders sorted by key, in depth first order.
+     * - `AllocatedVector<ColliderPair> colliderPairs`: The pairs of colliders whose AABBs overlap.
+     * - `Math::RectangleF bounds`: The bounds of the root node, computed around the colliders on each build.
+     * - `static constexpr std::uint32_t MaxLevel`: The level of the deepest nodes.
+     * - `static constexpr std::uint32_t LevelBitCount`: The number of low bits of a key holding the node level.
+     *
+     * The class provides the following methods:
+     * - `void Init() noexcept`: Preallocates the tree storage.
+     * - `void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept`: Registers a collider or updates its AABB.
+     * - `void RemoveCollider(std::size_t colliderIndex) noexcept`: Removes a collider from the tree.
+     * - `void FindPossiblePairs() noexcept`: Rebuilds the tree and fills colliderPairs with the overlapping colliders.
+     * - `void FindPossiblePairs(PairCallback& callback) noexcept`: Streams the overlapping colliders to a callback in chunks of PairChunkSize pairs.
+     * - `const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept`: Returns colliderPairs.
+     * - `void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept`: Finds the colliders whose AABB overlaps an AABB.
+     * - `void Clear() noexcept`: Clears the tree, resetting it to an empty state.
+     * - `static std::uint32_t Level(std::uint64_t key) noexcept`: Returns the level of the node of a key.
+     * - `static std::uint64_t SubtreeEndKey(std::uint64_t key) noexcept`: Returns the first key after the subtree of a node.
+     */
+    class LinearQuadTree final : public BroadPhase
+    {
+    public:
+        static constexpr std::uint32_t MaxLevel = 15;
+        static constexpr std::uint32_t LevelBitCount = 4;
+
+        HeapAllocator heapAllocator;
+        AllocatedVector <LinearQuadTreeProxy> proxies{StandardAllocator < LinearQuadTreeProxy > {heapAllocator}};
+        AllocatedVector <LinearQuadTreeEntry> entries{StandardAllocator < LinearQuadTreeEntry > {heapAllocator}};
+        AllocatedVector <ColliderPair> colliderPairs{StandardAllocator < ColliderPair > {heapAllocator}};
+        Math::RectangleF bounds{Math::Vec2F::Zero(), Math::Vec2F::Zero()};
+
+        LinearQuadTree() noexcept = default;
+
+        /**
+         * @brief Preallocates the tree storage and the collider pairs.
+         */
+        void Init() noexcept override;
+
+        /**
+         * @brief Registers a collider or updates its AABB, the tree is rebuilt on the next FindPossiblePairs.
+         * @param simplifedCollider The simplified collider with its tight AABB.
+         */
+        void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept override;
+
+        /**
+         * @brief Removes a collider from the tree, does nothing if the collider is not registered.
+         * @param colliderIndex The index of the collider to remove.
+         */
+        void RemoveCollider(std::size_t colliderIndex) noexcept override;
+
+        /**
+         * @brief Rebuilds the tree and fills colliderPairs with every pair of colliders whose AABBs overlap.
+         * \n Note : Each pair is reported once, the pairs whose filters do not collide are left out.
+         */
+        void FindPossiblePairs() noexcept override;
+
+        /**
+         * @brief Finds the same pairs as FindPossiblePairs, handing them to the callback each time PairChunkSize of them
+         * are found instead of keeping them all.
+         * \n Note : colliderPairs is the chunk buffer, it is left empty.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        void FindPossiblePairs(PairCallback& callback) noexcept override;
+
+        /**
+         * @return colliderPairs, the pairs of the last FindPossiblePairs.
+         */
+        [[nodiscard]] const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept override;
+
+        /**
+         * @brief Gives to the callback every collider whose AABB overlaps the given AABB.
+         * The query is keyed like a collider, the colliders it can overlap are in the subtree of its node or in one of
+         * the ancestors of its node, each found with a binary search in the sorted entries.
+         * \n Note : The tree is the one built by the last FindPossiblePairs.
+         * @param aabb The AABB to query.
+         * @param queryIndex The index given back to the callback with each collider found.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Clears the tree, resetting it to an empty state.
+         */
+        void Clear() noexcept override;
+
+        /**
+         * @return The level of the node encoded in the key, 0 for the root node.
+         */
+        [[nodiscard]] static std::uint32_t Level(std::uint64_t key) noexcept;
+
+        /**
+         * @return The smallest key greater than the keys of the node and of all its descendants.
+         */
+        [[nodiscard]] static std::uint64_t SubtreeEndKey(std::uint64_t key) noexcept;
+
+    private:
+        PairCallback* _pairCallback = nullptr;
+        AllocatedVector <LinearQuadTreeEntry> _sortBuffer{StandardAllocator < LinearQuadTreeEntry > {heapAllocator}};
+        AllocatedVector <float> _packedMinX{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMinY{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMaxX{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMaxY{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _packedCategoryBits{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _packedMaskBits{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <std::int32_t> _packedGroupIndices{StandardAllocator < std::int32_t > {heapAllocator}};
+        float _scaleX = 0.0f;
+        float _scaleY = 0.0f;
+
+        [[nodiscard]] std::uint64_t computeKey(const Math::RectangleF& aabb) const noexcept;
+
+        void radixSort() noexcept;
+
+        void queryRange(const Math::RectangleF& aabb, std::uint32_t begin, std::uint32_t end, std::size_t queryIndex,
+                        QueryCallback& callback) const noexcept;
+    };
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include "Collider.h"
+
+namespace Engine
+{
+    /**
+     * @struct NearestCollider
+     * @brief Represents a collider found by a nearest neighbour query.
+     *
+     * The struct has the following members:
+     * - `ColliderRef colliderRef`: The collider found.
+     * - `float distance`: The distance from the query point to the collider shape, 0 if the shape contains the point.
+     */
+    struct NearestCollider
+    {
+        ColliderRef colliderRef{};
+        float distance = 0.0f;
+    };
+
+    /**
+     * @struct NearestEntry
+     * @brief Represents a node waiting in the priority queue of a best first traversal.
+     *
+     * The struct has the following members:
+     * - `float squareDistance`: The square distance from the query point to the node bounds, a lower bound for its colliders.
+     * - `Node node`: The node, as stored by the structure traversed.
+     */
+    template<typename Node>
+    struct NearestEntry
+    {
+        float squareDistance;
+        Node node;
+    };
+
+    /**
+     * @class NearestCallback
+     * @brief Interface receiving the candidates of a nearest neighbour query, in the order a broad phase structure finds them.
+     *
+     * The class has the following public abstract method:
+     * - `virtual float OnNearestCandidate(std::size_t queryIndex, ColliderRef colliderRef) noexcept = 0`: Called for each collider that may be one of the nearest.
+     *
+     * The callback measures the exact distance to the collider shape, keeps the nearest colliders found so far and
+     * returns how far the structure still has to look, which prunes the rest of the traversal.
+     */
+    class NearestCallback
+    {
+    public:
+        /**
+         * @brief Abstract method that is called for each collider whose stored AABB is within the search distance.
+         * @param queryIndex The index of the query in its batch, 0 for a single query.
+         * @param colliderRef The candidate collider.
+         * @return The square distance beyond which no collider is needed anymore.
+         */
+        virtual float OnNearestCandidate(std::size_t queryIndex, ColliderRef colliderRef) noexcept = 0;
+    };
+}
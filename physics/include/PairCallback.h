@@ -0,0 +1,65 @@
+#pragma once
+
+#include "Collider.h"
+#include "Allocator.h"
+
+#include <cstddef>
+
+namespace Engine
+{
+    /**
+     * @brief The number of pairs a broad phase gathers before handing them to a PairCallback.
+     * \n Note : A ColliderPair is 32 bytes, a chunk takes 8 KiB and stays in the L1 cache while it is consumed.
+     */
+    static constexpr std::size_t PairChunkSize = 256;
+
+    /**
+     * @class PairCallback
+     * @brief Interface consuming the pairs of a broad phase chunk by chunk, while the broad phase is still running.
+     *
+     * The class has the following public abstract method:
+     * - `virtual void OnPairs(const ColliderPair* pairs, std::size_t pairCount) noexcept = 0`: Called with each chunk of pairs found.
+     *
+     * A broad phase streaming its pairs reuses the same chunk buffer for the whole traversal, so the pairs found are
+     * still in cache when they are consumed and the memory used does not grow with the number of pairs.
+     */
+    class PairCallback
+    {
+    public:
+        /**
+         * @brief Abstract method that is called for each chunk of pairs found by a broad phase.
+         * \n Note : The pairs are only valid during the call, the buffer is reused for the next chunk.
+         * @param pairs The pairs of the chunk.
+         * @param pairCount The number of pairs of the chunk, at most PairChunkSize.
+         */
+        virtual void OnPairs(const ColliderPair* pairs, std::size_t pairCount) noexcept = 0;
+    };
+
+    /**
+     * @brief Adds a pair to a broad phase pair buffer, and hands the buffer to the callback once it holds a full chunk.
+     * @param pairs The pair buffer, emptied after each chunk given to the callback.
+     * @param pair The pair found.
+     * @param callback The callback consuming the chunks, nullptr to keep every pair in the buffer.
+     */
+    inline void AddPair(AllocatedVector<ColliderPair>& pairs, const ColliderPair& pair, PairCallback* callback) noexcept
+    {
+        pairs.push_back(pair);
+        if (callback != nullptr && pairs.size() == PairChunkSize)
+        {
+            callback->OnPairs(pairs.data(), pairs.size());
+            pairs.clear();
+        }
+    }
+
+    /**
+     * @brief Hands the last, partial chunk of a pair buffer to the callback, does nothing without a callback.
+     */
+    inline void FlushPairs(AllocatedVector<ColliderPair>& pairs, PairCallback* callback) noexcept
+    {
+        if (callback != nullptr && !pairs.empty())
+        {
+            callback->OnPairs(pairs.data(), pairs.size());
+            pairs.clear();
+        }
+    }
+}
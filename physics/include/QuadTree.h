@@ -2,8 +2,17 @@
 
 #include "Shape.h"
 #include "Collider.h"
-#include "Metrics.h"
+#include "AABB.h"
+#include "QueryCallback.h"
+#include "RayCast.h"
+#include "NearestCallback.h"
+#include "PairCallback.h"
+#include "BroadPhase.h"
+#include <array>
+#include <condition_variable>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <vector>
 #include "Allocator.h"
 #ifdef TRACY_ENABLE
@@ -13,23 +22,6 @@
 
 namespace Engine
 {
-    /**
-     * @struct SimplifiedCollider
-     * @brief Represents a simplified view of a collider with its reference and axis-aligned bounding box (AABB).
-     *
-     * The SimplifiedCollider struct provides a simplified representation of a collider, including its collider reference
-     * and its axis-aligned bounding box (AABB). It is useful for scenarios where a simplified view of a collider's data is needed.
-     *
-     * The struct has the following members:
-     * - `Engine::ColliderRef colliderRef`: The reference to the associated collider.
-     * - `Math::RectangleF aabb`: The axis-aligned bounding box (AABB) of the collider.
- */
-    struct SimplifedCollider
-    {
-        Engine::ColliderRef colliderRef;
-        Math::RectangleF aabb;
-    };
-
     /**
      * @struct QuadNode
      * @brief Represents a node in a quadtree used for spatial partitioning.
@@ -41,7 +33,13 @@ namespace Engine
      * The struct has the following members:
      * - `Math::RectangleF bounds`: The bounding rectangle defining the region covered by the quad node.
      * - `std::array<QuadNode*, 4> children`: An array of pointers to the quad node's four children.
-     * - `AllocatedVector<SimplifedCollider> colliders`: A vector of simplified colliders contained within the quad node.
+     * - `QuadNode* parent`: The parent node, nullptr for the root node.
+     * - `int depth`: The depth of the node in the tree, 0 for the root node.
+     * - `std::uint32_t colliderBegin`, `colliderCount`: The range of the node colliders in QuadTree::colliders.
+     * - `std::size_t subtreeColliderCount`: The number of colliders stored in this node and all of its descendants.
+     * - `std::array<float, 4> childMinX, childMinY, childMaxX, childMaxY`: The loose bounds of the four children as
+     * structure of arrays, so OverlapMask4 and ContainsMask4 classify an AABB against every child at once. They are
+     * set by QuadTree::Subdivide and only meaningful while the node has children.
      *
      *
      * This struct facilitates the creation and management of a quadtree for spatial partitioning.
@@ -50,105 +48,441 @@ namespace Engine
     {
         Math::RectangleF bounds{Math::Vec2F::Zero(), Math::Vec2F::Zero()};
         std::array<QuadNode*, 4> children{nullptr, nullptr, nullptr, nullptr};
-        AllocatedVector <SimplifedCollider> colliders{};
+        QuadNode* parent = nullptr;
+        int depth = 0;
+        std::uint32_t colliderBegin = 0;
+        std::uint32_t colliderCount = 0;
+        std::size_t subtreeColliderCount = 0;
+        alignas(16) std::array<float, 4> childMinX{};
+        alignas(16) std::array<float, 4> childMinY{};
+        alignas(16) std::array<float, 4> childMaxX{};
+        alignas(16) std::array<float, 4> childMaxY{};
+    };
 
-        QuadNode() noexcept = default;
+    /**
+     * @struct QuadProxy
+     * @brief Locates a collider stored in the persistent QuadTree.
+     *
+     * A proxy is kept per collider index so the tree can find the node holding a collider without searching it. The
+     * proxies are the reference copy of the colliders, QuadTree::colliders is laid out from them by Rebalance.
+     * - `QuadNode* node`: The node holding the collider, nullptr if the collider is not in the tree.
+     * - `SimplifedCollider collider`: The collider with its fat AABB.
+     */
+    struct QuadProxy
+    {
+        QuadNode* node = nullptr;
+        SimplifedCollider collider{ColliderRef{}, Math::RectangleF(Math::Vec2F::Zero(), Math::Vec2F::Zero())};
+    };
 
-        explicit QuadNode(Allocator& allocator) noexcept:
-                colliders{StandardAllocator < Collider > {allocator}}
-        {};
+    /**
+     * @struct PackedQuadNode
+     * @brief A node of the subtree packed by QuadTree::FindPossiblePairs, used to find the pairs of a loose QuadTree.
+     *
+     * - `std::array<float, 4> childMinX, childMinY, childMaxX, childMaxY`: The loose bounds of the children of the
+     * node, copied from the QuadNode, every collider of a child subtree is inside them.
+     * - `std::uint32_t colliderBegin`, `colliderEnd`: The range of the packed colliders stored in the node.
+     * - `std::uint32_t subtreeColliderEnd`: The end of the range of the packed colliders of the node subtree.
+     * - `std::uint32_t subtreeNodeEnd`: The index of the first packed node after the node subtree.
+     */
+    struct PackedQuadNode
+    {
+        alignas(16) std::array<float, 4> childMinX;
+        alignas(16) std::array<float, 4> childMinY;
+        alignas(16) std::array<float, 4> childMaxX;
+        alignas(16) std::array<float, 4> childMaxY;
+        std::uint32_t colliderBegin;
+        std::uint32_t colliderEnd;
+        std::uint32_t subtreeColliderEnd;
+        std::uint32_t subtreeNodeEnd;
     };
 
 /**
      * @class QuadTree
-     * @brief Represents a quadtree used for spatial partitioning of colliders.
+     * @brief Represents a persistent quadtree used for spatial partitioning of colliders, the default BroadPhase.
      *
      * The QuadTree class represents a quadtree, a tree data structure used for spatial partitioning in applications
      * such as collision detection. The quadtree divides space into quadrants, allowing for efficient spatial queries.
+     * Nodes come from a pool growing by chunks of NodeChunkSize when a split happens, so the memory used scales with the
+     * colliders present and not with 4^maxDepth, and node addresses stay valid while the pool grows.
+     * Nodes own no storage: the colliders of every node are in one contiguous array, in depth first order, each node
+     * referencing its [colliderBegin, colliderBegin + colliderCount) range. Rebalance lays the array out again from the
+     * proxies with a counting sort, and a split partitions the range of the node among its children in place.
+     * The tree persists across steps: colliders are stored with an enlarged ("fat") AABB and are only moved when their
+     * tight AABB leaves the fat one. Nodes are split when a leaf overflows and merged back when their subtree empties,
+     * so the cost of an update scales with the number of moving colliders and not with the total count.
+     * In loose mode, the region a node accepts colliders in is its bounds enlarged by LooseFactor around its center, and
+     * a collider goes down to the child holding its center as long as it fits in the child loose bounds. A collider then
+     * sinks to the depth matching its size instead of staying in the first node whose center lines it crosses, so a
+     * large collider no longer ends up at the root and is only tested against the nodes its AABB reaches.
      *
      * The class has the following members:
      * - `HeapAllocator heapAllocator`: An allocator for managing memory used by the quadtree.
-     * - `AllocatedVector<QuadNode> nodes{StandardAllocator<QuadNode>{heapAllocator}}` : represent the nodes created in the quad tree
-     * - `int nodeIndex`: index used to navigate through the nodes.
+     * - `QuadNode root`: The root node, its bounds are refitted around the colliders so the world can have any extent.
+     * - `AllocatedVector<SimplifedCollider> colliders`: The colliders of every node, grouped by node in depth first order.
      * - `AllocatedVector <ColliderPair> nodeColliderPairs{StandardAllocator <ColliderPair > {heapAllocator}}`: An allocated vector to store collider pairs within the quadtree.
-     * - `static const auto MaxColliderInNode`: A constant defining the maximum number of colliders allowed in a single quadtree node.
-     * - `static const auto MaxDepth`: A constant defining the maximum depth of the quadtree.
+     * - `AllocatedVector <QuadProxy> proxies`: The location of each collider in the tree, indexed by collider index.
+     * - `std::size_t maxColliderInNode`: The number of colliders above which a leaf is split, can be changed at runtime.
+     * - `int maxDepth`: The depth below which nodes are not split anymore, can be changed at runtime.
+     * - `std::size_t workerCount`: The number of threads finding the pairs, 0 to use every hardware thread. The worker
+     *   threads are started by Init and restarted on the next FindPossiblePairs if it changes.
+     * - `bool isLoose`: Enables the loose mode, changing it rebuilds the tree on the next Rebalance.
+     * - `static constexpr float LooseFactor`: The ratio between the loose bounds and the bounds of a node in loose mode.
+     * - `static constexpr std::size_t ParallelColliderThreshold`: Below this number of colliders, the pairs are found on the calling thread only.
+     * - `static constexpr std::size_t PairTaskColliderCount`: The number of colliders whose pairs are found by one task.
+     * - `static constexpr std::size_t TaskBuffersPerThread`: The number of task pair buffers per thread finding the pairs.
+     * - `static constexpr std::size_t DefaultMaxColliderInNode`, `DefaultMaxDepth`: The default values of the parameters.
+     * - `static constexpr std::size_t NodeChunkSize`: The number of nodes allocated at once when the node pool grows.
+     * - `static constexpr float FatAABBMargin`: The margin added around each collider AABB stored in the tree.
      *
      * The class provides the following methods:
-     * - `void Init()`: pre allocating memory for nodes and collider pairs.
+     * - `void Init()`: pre allocating memory for collider pairs and starting the worker threads, nodes are only allocated when a node is split.
      * - `void Subdivide(QuadNode& node)`: Subdivides the quad node into four children, splitting the space into quadrants.
-     * - `void InsertInRootNode(const SimplifiedCollider &simplifiedCollider) noexcept`: Inserts a simplified collider into the root QuadNode of the QuadTree.
-     * - `void SubdivideNodeRecursively(QuadNode &node, int depth) noexcept`: Recursively subdivides a QuadNode if it contains more colliders than the maximum allowed or if the depth limit is not reached.
-     * - `void FindPossiblePairs(QuadNode &node) noexcept`: Finds possible collider pairs within a QuadNode and its children.
-     * - `void FindInChildrenNodePossiblePairs(QuadNode &node, Engine::ColliderRef &colliderRef) noexcept`: Finds possible collider pairs between a specific collider and the colliders within a QuadNode and its children.
+     * - `std::size_t NodeCount() const noexcept`: Returns the number of nodes currently in the tree.
+     * - `std::size_t AllocatedNodeCount() const noexcept`: Returns the number of nodes allocated by the node pool.
+     * - `void UpdateCollider(const SimplifiedCollider &simplifiedCollider) noexcept`: Inserts a collider or moves it if it left its fat AABB.
+     * - `void RemoveCollider(std::size_t colliderIndex) noexcept`: Removes a collider from the tree.
+     * - `void Rebalance() noexcept`: Merges the nodes that became underfull and refits the root if a collider left it.
+     * - `void InsertInRootNode(const SimplifiedCollider &simplifiedCollider) noexcept`: Inserts a simplified collider in the deepest existing node that fully contains it.
+     * - `void SubdivideNodeRecursively(QuadNode &node) noexcept`: Recursively subdivides a QuadNode if it contains more colliders than the maximum allowed and the depth limit is not reached.
+     * - `void FindPossiblePairs(QuadNode &node) noexcept`: Finds the collider pairs whose AABBs overlap within a QuadNode and its children.
+     * - `void FindPossiblePairs(QuadNode& node, PairCallback& callback) noexcept`: Streams the same pairs to a callback in chunks of PairChunkSize pairs.
+     * - `void FindPossiblePairs() noexcept`, `void FindPossiblePairs(PairCallback& callback) noexcept`: Find the pairs of the whole tree, from the root.
+     * - `const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept`: Returns nodeColliderPairs.
+     * - `void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept`: Finds the colliders whose stored AABB overlaps an AABB.
+     * - `void QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept`: Answers a batch of AABB queries in a single traversal.
+     * - `void RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept`: Finds the colliders whose stored AABB is crossed by a packet of rays.
+     * - `bool QueryNearest(Math::Vec2F point, std::size_t queryIndex, float maxSquareDistance, NearestCallback& callback) noexcept`: Finds the colliders nearest to a point, closest nodes first.
+     * - `void VisitNodes(BroadPhaseVisitor& visitor) const noexcept`: Gives the bounds and depth of every node to a visitor.
      * - `void Clear() noexcept`: Clears the QuadTree, resetting it to an empty state.
+     * - `Math::RectangleF LooseBounds(const QuadNode& node) const noexcept`: Returns the region a node accepts colliders in.
+     * - `std::size_t StartedWorkerCount() const noexcept`: Returns the number of worker threads running.
      *
      * This class facilitates the creation and management of a quadtree for spatial partitioning of colliders.
      */
-    class QuadTree
+    class QuadTree final : public BroadPhase
     {
     public:
+        static constexpr std::size_t DefaultMaxColliderInNode = 4;
+        static constexpr int DefaultMaxDepth = 6;
+        static constexpr std::size_t NodeChunkSize = 64;
+        static constexpr float FatAABBMargin = 4.0f;
+        static constexpr std::size_t ParallelColliderThreshold = 1024;
+        static constexpr std::size_t PairTaskColliderCount = 64;
+        static constexpr std::size_t TaskBuffersPerThread = 2;
+        static constexpr float LooseFactor = 2.0f;
+
         HeapAllocator heapAllocator;
-        AllocatedVector <QuadNode> nodes{StandardAllocator < QuadNode > {heapAllocator}};
-        int nodeIndex = 1;
+        QuadNode root{};
+        AllocatedVector <SimplifedCollider> colliders{StandardAllocator < SimplifedCollider > {heapAllocator}};
         AllocatedVector <ColliderPair> nodeColliderPairs{
                 StandardAllocator < ColliderPair > {heapAllocator}};
-
-        static const auto MaxColliderInNode = 4;
-        static const auto MaxDepth = 6;
+        AllocatedVector <QuadProxy> proxies{StandardAllocator < QuadProxy > {heapAllocator}};
+        std::size_t maxColliderInNode = DefaultMaxColliderInNode;
+        int maxDepth = DefaultMaxDepth;
+        std::size_t workerCount = 0;
+        bool isLoose = false;
 
         QuadTree() noexcept = default;
 
+        QuadTree(const QuadTree&) = delete;
+        QuadTree& operator=(const QuadTree&) = delete;
+
         /**
-         * @brief Initializes the QuadTree by preallocating memory for nodes and collider pairs.
-         *
-         * The method has the following key steps:
-         * 1. Calculates the maximum possible number of children nodes based on the maximum depth.
-         * 2. Resizes the nodes vector to allocate memory for the calculated maximum number of nodes.
-         * 3. Iterates over each node and reserves space for colliders within the node.
-         * 4. Reserves space for collider pairs based on the calculated maximum number of children nodes and a Ratio.
-         *
-         * This initialization ensures that the QuadTree has sufficient memory to accommodate its structure
-         * and allows for efficient insertion and retrieval of colliders during collision detection.
+         * @brief Stops and joins the worker threads.
          */
-        void Init() noexcept;
+        ~QuadTree() noexcept override;
+
+        /**
+         * @brief Initializes the QuadTree by clearing it and preallocating memory for the collider pairs, then starts
+         * the workerCount - 1 worker threads that help the calling thread find the pairs.
+         * \n Note : No node is preallocated, the node pool grows when a node is split. The workers sleep between two
+         * FindPossiblePairs, a step only wakes them and waits for its tasks.
+         */
+        void Init() noexcept override;
 
         /**
          * @brief Subdivides the current Node into four quadNodes.
+         * \n Note : Children are taken from the released node blocks first, then from the node pool, which allocates
+         * a new chunk of nodes when all of its nodes are used.
          */
         void Subdivide(QuadNode& node);
 
         /**
-         * @brief Inserts a simplified collider into the root QuadNode of the QuadTree.
-         * \n Note : RootNode dimension are set with the position of the collider inserted.
+         * @return The number of nodes in the tree, the root included.
+         */
+        [[nodiscard]] std::size_t NodeCount() const noexcept;
+
+        /**
+         * @return The number of nodes allocated by the node pool, the root included.
+         */
+        [[nodiscard]] std::size_t AllocatedNodeCount() const noexcept;
+
+        /**
+         * @brief Inserts a collider in the tree, or moves it if its tight AABB left the fat AABB stored in the tree.
+         * \n Note : A collider that stays inside its fat AABB is not touched.
+         * @param simplifedCollider The simplified collider with its tight AABB.
+         */
+        void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept override;
+
+        /**
+         * @brief Removes a collider from the tree, does nothing if the collider is not in the tree.
+         * @param colliderIndex The index of the collider to remove.
+         */
+        void RemoveCollider(std::size_t colliderIndex) noexcept override;
+
+        /**
+         * @brief Applies the deferred changes of the last updates.
+         * If a collider was inserted outside the root bounds or isLoose changed, refits the root around every collider
+         * and rebuilds the tree. Then lays out colliders from the proxies, merges the children of the nodes whose
+         * subtree became underfull and splits the leaves holding more than maxColliderInNode colliders.
+         * \n Note : The queries and FindPossiblePairs read colliders, they see the tree of the last Rebalance.
+         */
+        void Rebalance() noexcept override;
+
+        /**
+         * @brief Inserts a simplified collider in the deepest node of the tree that fully contains its AABB, in loose mode
+         * the deepest node holding its center whose loose bounds contain its AABB.
+         * \n Note : No node is split here, the leaves that overflow are split by the next Rebalance. A collider outside
+         * the root bounds is kept in the root node until then.
          * @param simplifedCollider The simplified collider to be inserted.
          */
         void InsertInRootNode(const SimplifedCollider& simplifedCollider) noexcept;
 
         /**
-         * @brief Recursively subdivides a QuadNode if it contains more colliders than the maximum allowed or if the depth limit is not reached.
+         * @brief Recursively subdivides a QuadNode if it contains more colliders than the maximum allowed and the depth limit is not reached.
+         * The range of the node in colliders is partitioned with a counting sort: the colliders staying in the node
+         * first, then the ones of each child, so the children ranges follow their parent one without any allocation.
+         * \n Note : colliders must be laid out, which Rebalance does before splitting.
          * @param node The QuadNode to be subdivided.
-         * @param depth The current depth of the recursion.
          */
-        void SubdivideNodeRecursively(QuadNode& node, int depth) noexcept;
+        void SubdivideNodeRecursively(QuadNode& node) noexcept;
 
         /**
-         * @brief Finds possible collider pairs within a QuadNode and its children.
+         * @brief Finds the collider pairs whose AABBs overlap within a QuadNode and its children.
+         * Each collider can only overlap the colliders after it in its node and the colliders of the node descendants.
+         * The colliders of the subtree are packed in depth first order, so these candidates are contiguous and are
+         * tested eight at a time with OverlapMask8, then the overlapping ones with FilterMask8 on their packed filters.
+         * With enough colliders, the packed colliders are split in tasks of PairTaskColliderCount colliders run by
+         * the calling thread and the worker threads started by Init, each task writing in one of TaskBuffersPerThread
+         * buffers per thread. The calling thread appends the buffers in task order as soon as the earlier tasks are
+         * done, so the pairs are the same and in the same order whatever the number of threads.
+         * In loose mode the subtrees overlap, so each collider is tested against the colliders after it in every packed
+         * node whose loose bounds its AABB reaches, the four children of a node being classified with one OverlapMask4.
+         * \n Note : Only the pairs whose fat AABBs overlap and whose filters collide are added to nodeColliderPairs.
          * @param node The QuadNode to search for possible pairs.
          */
         void FindPossiblePairs(QuadNode& node) noexcept;
 
         /**
-         * @brief Finds possible collider pairs between a specific collider and the colliders within a QuadNode and its children.
-         *
+         * @brief Finds the same pairs as FindPossiblePairs, handing them to the callback each time PairChunkSize of them
+         * are found instead of appending them all to nodeColliderPairs.
+         * \n Note : With several threads, each task buffer is handed to the callback in chunks as soon as the earlier
+         * tasks are done, so at most TaskBuffersPerThread buffers per thread hold pairs. nodeColliderPairs is the chunk
+         * buffer of the single thread path, it is left empty.
          * @param node The QuadNode to search for possible pairs.
-         * @param colliderRef Reference to the collider to compare with.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        void FindPossiblePairs(QuadNode& node, PairCallback& callback) noexcept;
+
+        /**
+         * @brief Clears nodeColliderPairs and fills it with the pairs of the whole tree.
+         */
+        void FindPossiblePairs() noexcept override;
+
+        /**
+         * @brief Streams the pairs of the whole tree to the callback.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        void FindPossiblePairs(PairCallback& callback) noexcept override;
+
+        /**
+         * @return nodeColliderPairs, the pairs of the last FindPossiblePairs.
+         */
+        [[nodiscard]] const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept override;
+
+        /**
+         * @brief Gives to the callback every collider whose stored AABB overlaps the given AABB.
+         * \n Note : The stored AABBs are the fat AABBs, the caller filters the colliders with their tight AABB if needed.
+         * @param aabb The AABB to query.
+         * @param queryIndex The index given back to the callback with each collider found.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Answers a batch of AABB queries in a single traversal of the tree.
+         * Each node is visited once with the queries reaching it, and passes down to each child the subset of these
+         * queries reaching the child, so the nodes near the root are not walked again for every query.
+         * @param aabbs The AABBs to query, the index of an AABB in the array is its query index.
+         * @param queryCount The number of AABBs.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Gives to the callback every collider whose stored AABB is crossed by some lanes of the packet.
+         * \n Note : A child is only visited with the lanes reaching its bounds before their maxFraction.
+         * @param packet The rays traversing the tree.
+         * @param callback The callback testing the colliders found.
+         */
+        void RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept override;
+
+        /**
+         * @brief Gives to the callback the colliders that may be the nearest to a point, visiting the nodes closest first.
+         * \n Note : A node is queued with the distance to its loose bounds, the colliders of a node are only given to
+         * the callback when their stored AABB is within the distance it returned last.
+         * @param point The query point.
+         * @param queryIndex The index given back to the callback with each candidate.
+         * @param maxSquareDistance The square distance beyond which no collider is needed.
+         * @param callback The callback measuring the candidates.
+         * @return True, the tree always answers the query.
          */
-        void FindInChildrenNodePossiblePairs(QuadNode& node, Engine::ColliderRef& colliderRef) noexcept;
+        bool QueryNearest(Math::Vec2F point, std::size_t queryIndex, float maxSquareDistance,
+                          NearestCallback& callback) noexcept override;
+
+        /**
+         * @brief Gives the bounds of every node to the visitor in depth first order, the root first.
+         * @param visitor The visitor receiving the nodes.
+         */
+        void VisitNodes(BroadPhaseVisitor& visitor) const noexcept override;
 
         /**
          * @brief Clears the QuadTree, resetting it to an empty state.
          */
-        void Clear() noexcept;
+        void Clear() noexcept override;
+
+        /**
+         * @return The bounds of the node enlarged by LooseFactor in loose mode, the bounds of the node otherwise.
+         * \n Note : The root is never enlarged, a collider outside its bounds makes the tree rebuild.
+         */
+        [[nodiscard]] Math::RectangleF LooseBounds(const QuadNode& node) const noexcept;
+
+        /**
+         * @return The number of worker threads running next to the calling thread, workerCount - 1 unless the system
+         * refused to create them all.
+         */
+        [[nodiscard]] std::size_t StartedWorkerCount() const noexcept
+        {
+            return _workers.size();
+        }
+
+    private:
+        AllocatedVector <AllocatedVector<QuadNode>> _nodeChunks{
+                StandardAllocator < AllocatedVector<QuadNode> > {heapAllocator}};
+        std::size_t _usedNodeBlockCount = 0;
+        AllocatedVector <QuadNode*> _freeNodeBlocks{StandardAllocator < QuadNode* > {heapAllocator}};
+        AllocatedVector <QuadNode*> _mergeCandidates{StandardAllocator < QuadNode* > {heapAllocator}};
+        AllocatedVector <SimplifedCollider> _partitionBuffer{StandardAllocator < SimplifedCollider > {heapAllocator}};
+        AllocatedVector <std::uint8_t> _partitionBuckets{StandardAllocator < std::uint8_t > {heapAllocator}};
+        bool _isRootOutgrown = false;
+        bool _isTreeLoose = false;
+
+        AllocatedVector <float> _packedMinX{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMinY{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMaxX{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <float> _packedMaxY{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _packedCategoryBits{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _packedMaskBits{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <std::int32_t> _packedGroupIndices{StandardAllocator < std::int32_t > {heapAllocator}};
+        AllocatedVector <ColliderRef> _packedColliderRefs{StandardAllocator < ColliderRef > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _packedSubtreeEnds{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <PackedQuadNode> _packedNodes{StandardAllocator < PackedQuadNode > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _activeQueries{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _activeChildMasks{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <NearestEntry<const QuadNode*>> _nearestQueue{
+                StandardAllocator < NearestEntry<const QuadNode*> > {heapAllocator}};
+        AllocatedVector <AllocatedVector<ColliderPair>> _taskPairs{
+                StandardAllocator < AllocatedVector<ColliderPair> > {heapAllocator}};
+
+        // The worker pool, every member below _workers is guarded by _taskMutex.
+        std::vector<std::thread> _workers;
+        std::size_t _requestedWorkerCount = 0;
+        std::mutex _taskMutex;
+        std::condition_variable _tasksPosted;
+        std::condition_variable _tasksProgressed;
+        bool _isStopping = false;
+        std::size_t _taskGeneration = 0;
+        std::size_t _taskWorkerCount = 0;
+        std::size_t _busyWorkerCount = 0;
+        std::size_t _taskCount = 0;
+        std::size_t _nextTask = 0;
+        std::size_t _handedTaskCount = 0;
+        std::size_t _taskBufferCount = 0;
+        AllocatedVector <std::uint8_t> _taskDone{StandardAllocator < std::uint8_t > {heapAllocator}};
+        PairCallback* _taskCallback = nullptr;
+        std::uint32_t _taskColliderCount = 0;
+
+        [[nodiscard]] QuadNode* findContainingChild(const QuadNode& node, const Math::RectangleF& aabb) const noexcept;
+
+        void addInNode(QuadNode& node, const SimplifedCollider& simplifedCollider) noexcept;
+
+        void removeFromNode(std::size_t colliderIndex) noexcept;
+
+        void mergeChildren(QuadNode& node) noexcept;
+
+        void releaseChildren(QuadNode& node) noexcept;
+
+        QuadNode* allocateNodeBlock() noexcept;
+
+        void rebuild() noexcept;
+
+        void layoutColliders() noexcept;
+
+        void resetColliderCounts(QuadNode& node) noexcept;
+
+        std::uint32_t assignColliderRanges(QuadNode& node, std::uint32_t offset) noexcept;
+
+        void splitOverflowingLeaves(QuadNode& node) noexcept;
+
+        void packSubtree(const QuadNode& node) noexcept;
+
+        void findPossiblePairs(QuadNode& node, PairCallback* callback) noexcept;
+
+        /**
+         * @brief Stops the worker threads, then starts workerCount - 1 of them, fewer if the system refuses to create
+         * more threads.
+         */
+        void startWorkers() noexcept;
+
+        void stopWorkers() noexcept;
+
+        /**
+         * @brief Waits for the tasks posted by findPossiblePairs and runs them until the QuadTree is destroyed.
+         * @param generation The _taskGeneration when the worker is started, the worker waits for the next one.
+         */
+        void runWorker(std::size_t workerIndex, std::size_t generation) noexcept;
+
+        /**
+         * @brief Takes the pair tasks one by one until none is left, called with _taskMutex locked. A thread never
+         * runs more than _taskBufferCount tasks ahead of the first task not handed over.
+         * @param isCallingThread True on the thread of FindPossiblePairs, which hands the done tasks over between its tasks.
+         */
+        void runPairTasks(std::unique_lock<std::mutex>& lock, bool isCallingThread) noexcept;
+
+        /**
+         * @brief Hands the pairs of the done tasks over, in task order, up to the first task still running.
+         * \n Note : Appends them to nodeColliderPairs, or gives them to _taskCallback in chunks of PairChunkSize pairs.
+         */
+        void handOverDoneTasks(std::unique_lock<std::mutex>& lock) noexcept;
+
+        void findPackedPairs(std::uint32_t begin, std::uint32_t end, AllocatedVector <ColliderPair>& pairs,
+                             PairCallback* callback) const noexcept;
+
+        void findLoosePairs(std::uint32_t colliderIndex, const Math::RectangleF& aabb, std::uint32_t nodeIndex,
+                            AllocatedVector <ColliderPair>& pairs, PairCallback* callback) const noexcept;
+
+        void queryNode(const QuadNode& node, const Math::RectangleF& aabb, std::size_t queryIndex,
+                       QueryCallback& callback) const noexcept;
+
+        void queryNodeBatch(const QuadNode& node, std::size_t activeBegin, const Math::RectangleF* aabbs,
+                            QueryCallback& callback) noexcept;
+
+        void visitNode(const QuadNode& node, BroadPhaseVisitor& visitor) const noexcept;
+
+        void rayCastNode(const QuadNode& node, std::uint32_t laneMask, RayPacket& packet,
+                         RayCastCallback& callback) const noexcept;
+
+        void addOverlappingPairs(std::uint32_t colliderIndex, std::uint32_t begin, std::uint32_t end,
+                                 AllocatedVector <ColliderPair>& pairs, PairCallback* callback) const noexcept;
     };
 }
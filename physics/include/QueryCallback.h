@@ -0,0 +1,29 @@
+#pragma once
+
+#include "Collider.h"
+
+namespace Engine
+{
+    /**
+     * @class QueryCallback
+     * @brief Interface receiving the colliders found by a spatial query.
+     *
+     * The QueryCallback class is given to the spatial queries of the World and of the broad phase structures. The
+     * colliders found are handed to it as soon as they are found, so a query does not need to store its results.
+     *
+     * The class has the following public abstract method:
+     * - `virtual void OnColliderFound(std::size_t queryIndex, ColliderRef colliderRef) noexcept = 0`: Called for each collider found by a query.
+     *
+     * Implementing this interface allows gathering, counting or filtering the results of a query without any allocation.
+     */
+    class QueryCallback
+    {
+    public:
+        /**
+        * @brief Abstract method that is called for each collider found by a query.
+        * @param queryIndex The index of the query in its batch, 0 for a single query.
+        * @param colliderRef The collider found.
+        */
+        virtual void OnColliderFound(std::size_t queryIndex, ColliderRef colliderRef) noexcept = 0;
+    };
+}
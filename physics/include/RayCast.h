@@ -0,0 +1,160 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+
+#include <array>
+#include <cstdint>
+
+namespace Engine
+{
+    /**
+     * @struct Ray
+     * @brief Represents a segment cast through the world, or a circle swept along it when radius is not zero.
+     *
+     * The struct has the following members:
+     * - `Math::Vec2F origin`: The start of the ray.
+     * - `Math::Vec2F translation`: The vector from the start to the end of the ray, the fractions are along it.
+     * - `float radius`: The radius of the cast circle, 0 for a ray.
+     */
+    struct Ray
+    {
+        Math::Vec2F origin = Math::Vec2F::Zero();
+        Math::Vec2F translation = Math::Vec2F::Zero();
+        float radius = 0.0f;
+    };
+
+    /**
+     * @struct RayCastHit
+     * @brief Represents the first collider hit by a ray.
+     *
+     * The struct has the following members:
+     * - `ColliderRef colliderRef`: The collider hit.
+     * - `Math::Vec2F point`: The point of the collider surface that is hit.
+     * - `Math::Vec2F normal`: The unit normal of the collider surface at the hit point.
+     * - `float fraction`: The fraction of the translation travelled before the hit, in [0, 1].
+     * - `bool hasHit`: False if the ray did not hit any collider, the other members are then meaningless.
+     */
+    struct RayCastHit
+    {
+        ColliderRef colliderRef{};
+        Math::Vec2F point = Math::Vec2F::Zero();
+        Math::Vec2F normal = Math::Vec2F::Zero();
+        float fraction = 1.0f;
+        bool hasHit = false;
+    };
+
+    /**
+     * @struct RayPacket
+     * @brief Represents up to eight rays traversing the broad phase structures together, stored as structure of arrays.
+     *
+     * A node is visited once for the whole packet, its AABB is tested against the eight rays at once and the lanes that
+     * miss it are masked out for the node subtree. The maxFraction of a lane shrinks as the lane hits colliders, so the
+     * nodes behind the closest hit found so far are skipped.
+     *
+     * The struct has the following members:
+     * - `static constexpr std::size_t Size`: The number of lanes of a packet.
+     * - `std::array<float, Size> originX, originY`: The origins of the rays.
+     * - `std::array<float, Size> translationX, translationY`: The translations of the rays.
+     * - `std::array<float, Size> inverseX, inverseY`: The inverse of the translations, used by the slab tests.
+     * - `std::array<float, Size> radius`: The radius of the cast circles, 0 for a ray.
+     * - `std::array<float, Size> maxFraction`: The fraction of the closest hit of each lane, 1 until a lane hits.
+     * - `std::size_t firstRayIndex`: The index of the ray of the first lane in the batch.
+     * - `std::uint32_t laneMask`: The lanes holding a ray.
+     *
+     * The struct provides the following method:
+     * - `void Load(const Ray* rays, std::size_t firstRay, std::size_t rayCount) noexcept`: Fills the packet with consecutive rays.
+     */
+    struct RayPacket
+    {
+        static constexpr std::size_t Size = 8;
+
+        std::array<float, Size> originX{};
+        std::array<float, Size> originY{};
+        std::array<float, Size> translationX{};
+        std::array<float, Size> translationY{};
+        std::array<float, Size> inverseX{};
+        std::array<float, Size> inverseY{};
+        std::array<float, Size> radius{};
+        std::array<float, Size> maxFraction{};
+        std::size_t firstRayIndex = 0;
+        std::uint32_t laneMask = 0;
+
+        /**
+         * @brief Fills the packet with the rays starting at firstRay, the lanes after the last ray are left empty.
+         * @param rays The rays of the batch.
+         * @param firstRay The index of the ray of the first lane.
+         * @param rayCount The number of rays of the batch.
+         */
+        void Load(const Ray* rays, std::size_t firstRay, std::size_t rayCount) noexcept;
+    };
+
+    /**
+     * @class RayCastCallback
+     * @brief Interface receiving the colliders a ray packet may hit, found while traversing a broad phase structure.
+     *
+     * The class has the following public abstract method:
+     * - `virtual void OnRayCandidate(RayPacket& packet, std::uint32_t laneMask, ColliderRef colliderRef) noexcept = 0`: Called for each collider whose AABB is crossed by some lanes.
+     *
+     * The callback runs the exact test against the collider shape and lowers the maxFraction of the lanes it hits,
+     * which prunes the rest of the traversal.
+     */
+    class RayCastCallback
+    {
+    public:
+        /**
+         * @brief Abstract method that is called for each collider whose AABB is crossed by some lanes of a packet.
+         * @param packet The packet traversing the structure.
+         * @param laneMask The lanes crossing the collider AABB.
+         * @param colliderRef The collider to test.
+         */
+        virtual void OnRayCandidate(RayPacket& packet, std::uint32_t laneMask, ColliderRef colliderRef) noexcept = 0;
+    };
+
+    /**
+     * @brief Tests the eight lanes of a packet against an AABB with the slab method.
+     * \n Note : The AABB is enlarged by the radius of each lane, a lane starting inside the AABB crosses it.
+     * @return A mask whose bit i is set if the lane i enters the AABB before its maxFraction, empty lanes included.
+     */
+    [[nodiscard]] std::uint32_t RaySlabMask8(const Math::RectangleF& aabb, const RayPacket& packet) noexcept;
+
+    /**
+     * @brief Casts the eight lanes of a packet against a circle.
+     * \n Note : A lane starting inside the circle, enlarged by the lane radius, does not hit it.
+     * @param packet The rays cast.
+     * @param center, radius The circle.
+     * @param fractions Receives the fraction of the hit of each lane whose bit is set in the result.
+     * @return A mask whose bit i is set if the lane i hits the circle before its maxFraction.
+     */
+    [[nodiscard]] std::uint32_t RayCastCircle8(const RayPacket& packet, Math::Vec2F center, float radius,
+                                               float* fractions) noexcept;
+
+    /**
+     * @brief Casts the eight lanes of a packet against a rectangle.
+     * \n Note : A cast circle is tested against the rectangle with rounded corners, a lane starting inside the
+     * rectangle enlarged by its radius does not hit it.
+     * @param packet The rays cast.
+     * @param rectangle The rectangle.
+     * @param fractions Receives the fraction of the hit of each lane whose bit is set in the result.
+     * @return A mask whose bit i is set if the lane i hits the rectangle before its maxFraction.
+     */
+    [[nodiscard]] std::uint32_t RayCastRectangle8(const RayPacket& packet, const Math::RectangleF& rectangle,
+                                                  float* fractions) noexcept;
+
+    /**
+     * @brief Completes the hit of a ray on a circle from its fraction.
+     * @return The hit with its point and normal, colliderRef is left empty.
+     */
+    [[nodiscard]] RayCastHit CircleHit(const Ray& ray, Math::Vec2F center, float radius, float fraction) noexcept;
+
+    /**
+     * @brief Completes the hit of a ray on a rectangle from its fraction.
+     * @return The hit with its point and normal, colliderRef is left empty.
+     */
+    [[nodiscard]] RayCastHit RectangleHit(const Ray& ray, const Math::RectangleF& rectangle, float fraction) noexcept;
+
+    /**
+     * @return The AABB swept by a ray, enlarged by its radius.
+     */
+    [[nodiscard]] Math::RectangleF RayAABB(const Ray& ray) noexcept;
+}
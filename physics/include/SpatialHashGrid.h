@@ -0,0 +1,153 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+#include "QueryCallback.h"
+#include "PairCallback.h"
+#include "BroadPhase.h"
+#include "Allocator.h"
+#include <cstdint>
+#include <vector>
+#ifdef TRACY_ENABLE
+#include <Tracy.hpp>
+#include <TracyC.h>
+#endif
+
+namespace Engine
+{
+    /**
+     * @struct GridEntry
+     * @brief Represents a collider registered in one cell of the SpatialHashGrid.
+     *
+     * The struct has the following members:
+     * - `std::int32_t cellX`, `cellY`: The coordinates of the cell, kept to tell apart cells hashed in the same bucket.
+     * - `std::uint32_t colliderIndex`: The index of the collider overlapping the cell.
+     */
+    struct GridEntry
+    {
+        std::int32_t cellX;
+        std::int32_t cellY;
+        std::uint32_t colliderIndex;
+    };
+
+    /**
+     * @struct GridProxy
+     * @brief Represents a collider registered in the SpatialHashGrid.
+     *
+     * The struct has the following members:
+     * - `SimplifedCollider simplifedCollider`: The collider reference with its current AABB.
+     * - `bool isActive`: True while the collider is in the grid.
+     */
+    struct GridProxy
+    {
+        SimplifedCollider simplifedCollider{ColliderRef{}, Math::RectangleF(Math::Vec2F::Zero(), Math::Vec2F::Zero())};
+        bool isActive = false;
+    };
+
+    /**
+     * @class SpatialHashGrid
+     * @brief Represents a uniform grid BroadPhase whose cells are hashed in a fixed number of buckets.
+     *
+     * The grid is rebuilt from scratch on each FindPossiblePairs. The cell size is chosen from the distribution of the
+     * collider sizes so that most colliders overlap at most four cells, and the colliders of each bucket are stored
+     * contiguously in a single array filled with a counting sort. A pair of colliders sharing several cells is only
+     * reported by the cell containing the min corner of the intersection of their AABBs, so no pair is duplicated.
+     * It is the cheapest structure when the colliders have about the same size, like the circles of the samples.
+     *
+     * The class has the following members:
+     * - `HeapAllocator heapAllocator`: An allocator for managing memory used by the grid.
+     * - `AllocatedVector<GridProxy> proxies`: The registered colliders, indexed by collider index.
+     * - `AllocatedVector<GridEntry> entries`: The colliders of every bucket, stored bucket after bucket.
+     * - `AllocatedVector<std::uint32_t> bucketStarts`: The first entry of each bucket, plus the end of the last bucket.
+     * - `AllocatedVector<ColliderPair> colliderPairs`: The pairs of colliders whose AABBs overlap.
+     * - `float cellSize`: The size of the cells computed on the last FindPossiblePairs.
+     * - `static constexpr float CellSizePercentile`: The percentile of the collider sizes used as cell size.
+     *
+     * The class provides the following methods:
+     * - `void Init() noexcept`: Preallocates the grid storage.
+     * - `void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept`: Registers a collider or updates its AABB.
+     * - `void RemoveCollider(std::size_t colliderIndex) noexcept`: Removes a collider from the grid.
+     * - `void FindPossiblePairs() noexcept`: Rebuilds the grid and fills colliderPairs with the overlapping colliders.
+     * - `void FindPossiblePairs(PairCallback& callback) noexcept`: Streams the overlapping colliders to a callback in chunks of PairChunkSize pairs.
+     * - `const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept`: Returns colliderPairs.
+     * - `void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept`: Finds the colliders whose AABB overlaps an AABB.
+     * - `void Clear() noexcept`: Clears the grid, resetting it to an empty state.
+     */
+    class SpatialHashGrid final : public BroadPhase
+    {
+    public:
+        HeapAllocator heapAllocator;
+        AllocatedVector <GridProxy> proxies{StandardAllocator < GridProxy > {heapAllocator}};
+        AllocatedVector <GridEntry> entries{StandardAllocator < GridEntry > {heapAllocator}};
+        AllocatedVector <std::uint32_t> bucketStarts{StandardAllocator < std::uint32_t > {heapAllocator}};
+        AllocatedVector <ColliderPair> colliderPairs{StandardAllocator < ColliderPair > {heapAllocator}};
+        float cellSize = 1.0f;
+
+        static constexpr float CellSizePercentile = 0.9f;
+
+        SpatialHashGrid() noexcept = default;
+
+        /**
+         * @brief Preallocates the grid storage and the collider pairs.
+         */
+        void Init() noexcept override;
+
+        /**
+         * @brief Registers a collider or updates its AABB, the grid is rebuilt on the next FindPossiblePairs.
+         * @param simplifedCollider The simplified collider with its tight AABB.
+         */
+        void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept override;
+
+        /**
+         * @brief Removes a collider from the grid, does nothing if the collider is not registered.
+         * @param colliderIndex The index of the collider to remove.
+         */
+        void RemoveCollider(std::size_t colliderIndex) noexcept override;
+
+        /**
+         * @brief Rebuilds the grid and fills colliderPairs with every pair of colliders whose AABBs overlap.
+         * \n Note : Each pair is reported once, the pairs whose filters do not collide are left out.
+         */
+        void FindPossiblePairs() noexcept override;
+
+        /**
+         * @brief Finds the same pairs as FindPossiblePairs, handing them to the callback each time PairChunkSize of them
+         * are found instead of keeping them all.
+         * \n Note : colliderPairs is the chunk buffer, it is left empty.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        void FindPossiblePairs(PairCallback& callback) noexcept override;
+
+        /**
+         * @return colliderPairs, the pairs of the last FindPossiblePairs.
+         */
+        [[nodiscard]] const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept override;
+
+        /**
+         * @brief Gives to the callback every collider whose AABB overlaps the given AABB, walking the cells it covers.
+         * \n Note : A collider covering several of these cells is only reported by the first of them. A query covering
+         * more cells than there are entries scans the colliders instead.
+         * @param aabb The AABB to query.
+         * @param queryIndex The index given back to the callback with each collider found.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Clears the grid, resetting it to an empty state.
+         */
+        void Clear() noexcept override;
+
+    private:
+        PairCallback* _pairCallback = nullptr;
+        AllocatedVector <float> _colliderSizes{StandardAllocator < float > {heapAllocator}};
+        AllocatedVector <std::uint32_t> _activeColliders{StandardAllocator < std::uint32_t > {heapAllocator}};
+        std::uint32_t _bucketMask = 0;
+
+        void computeCellSize() noexcept;
+
+        [[nodiscard]] std::int32_t cellCoordinate(float coordinate) const noexcept;
+
+        [[nodiscard]] std::uint32_t bucketIndex(std::int32_t cellX, std::int32_t cellY) const noexcept;
+    };
+}
@@ -0,0 +1,152 @@
+#pragma once
+
+#include "Shape.h"
+#include "Collider.h"
+#include "QueryCallback.h"
+#include "PairCallback.h"
+#include "BroadPhase.h"
+#include "Allocator.h"
+#include <cstdint>
+#include <vector>
+#ifdef TRACY_ENABLE
+#include <Tracy.hpp>
+#include <TracyC.h>
+#endif
+
+namespace Engine
+{
+    /**
+     * @struct SweepEndpoint
+     * @brief Represents one end of a collider AABB projected on an axis.
+     *
+     * The struct has the following members:
+     * - `float value`: The coordinate of the endpoint on its axis.
+     * - `std::uint32_t colliderIndex`: The index of the collider the endpoint belongs to.
+     * - `std::uint32_t isMax`: 1 for the max endpoint of the interval, 0 for the min endpoint.
+     */
+    struct SweepEndpoint
+    {
+        float value;
+        std::uint32_t colliderIndex;
+        std::uint32_t isMax;
+    };
+
+    /**
+     * @struct SweepProxy
+     * @brief Represents a collider registered in the sweep and prune.
+     *
+     * The struct has the following members:
+     * - `SimplifedCollider simplifedCollider`: The collider reference with its current AABB.
+     * - `bool isActive`: True while the collider is in the sweep and prune.
+     * - `bool hasEndpoints`: True while the endpoints of the collider are in the endpoint arrays.
+     * - `std::size_t activeIndex`: The index of the collider in the list of intervals open during the sweep.
+     */
+    struct SweepProxy
+    {
+        SimplifedCollider simplifedCollider{ColliderRef{}, Math::RectangleF(Math::Vec2F::Zero(), Math::Vec2F::Zero())};
+        bool isActive = false;
+        bool hasEndpoints = false;
+        std::size_t activeIndex = 0;
+    };
+
+    /**
+     * @class SweepAndPrune
+     * @brief Represents a sweep and prune BroadPhase exploiting frame-to-frame coherence.
+     *
+     * The colliders AABBs are projected on both axes and their endpoints are kept sorted in one array per axis.
+     * As bodies only move a little between two steps, the arrays are almost sorted and an insertion sort restores
+     * them in close to linear time. The pairs are then found by sweeping the axis along which the colliders are the most
+     * spread, keeping the list of open intervals and only reporting the colliders whose intervals overlap on both axes.
+     *
+     * The class has the following members:
+     * - `HeapAllocator heapAllocator`: An allocator for managing memory used by the sweep and prune.
+     * - `AllocatedVector<SweepProxy> proxies`: The registered colliders, indexed by collider index.
+     * - `AllocatedVector<SweepEndpoint> endpointsX`, `endpointsY`: The sorted endpoints on each axis.
+     * - `AllocatedVector<ColliderPair> colliderPairs`: The pairs of colliders whose AABBs overlap.
+     * - `static constexpr std::size_t FullSortThreshold`: Above this number of new colliders, the endpoints are fully sorted instead of insertion sorted.
+     *
+     * The class provides the following methods:
+     * - `void Init() noexcept`: Preallocates the endpoints and the collider pairs.
+     * - `void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept`: Registers a collider or updates its AABB.
+     * - `void RemoveCollider(std::size_t colliderIndex) noexcept`: Removes a collider from the sweep and prune.
+     * - `void FindPossiblePairs() noexcept`: Sorts the endpoints and fills colliderPairs with the overlapping colliders.
+     * - `void FindPossiblePairs(PairCallback& callback) noexcept`: Streams the overlapping colliders to a callback in chunks of PairChunkSize pairs.
+     * - `const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept`: Returns colliderPairs.
+     * - `void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept`: Finds the colliders whose AABB overlaps an AABB.
+     * - `void Clear() noexcept`: Clears the sweep and prune, resetting it to an empty state.
+     */
+    class SweepAndPrune final : public BroadPhase
+    {
+    public:
+        HeapAllocator heapAllocator;
+        AllocatedVector <SweepProxy> proxies{StandardAllocator < SweepProxy > {heapAllocator}};
+        AllocatedVector <SweepEndpoint> endpointsX{StandardAllocator < SweepEndpoint > {heapAllocator}};
+        AllocatedVector <SweepEndpoint> endpointsY{StandardAllocator < SweepEndpoint > {heapAllocator}};
+        AllocatedVector <ColliderPair> colliderPairs{StandardAllocator < ColliderPair > {heapAllocator}};
+
+        static constexpr std::size_t FullSortThreshold = 64;
+
+        SweepAndPrune() noexcept = default;
+
+        /**
+         * @brief Preallocates the endpoints and the collider pairs.
+         */
+        void Init() noexcept override;
+
+        /**
+         * @brief Registers a collider or updates its AABB, its endpoints are moved on the next FindPossiblePairs.
+         * @param simplifedCollider The simplified collider with its tight AABB.
+         */
+        void UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept override;
+
+        /**
+         * @brief Removes a collider from the sweep and prune, does nothing if the collider is not registered.
+         * @param colliderIndex The index of the collider to remove.
+         */
+        void RemoveCollider(std::size_t colliderIndex) noexcept override;
+
+        /**
+         * @brief Sorts the endpoints and fills colliderPairs with every pair of colliders whose AABBs overlap.
+         * \n Note : Each pair is reported once, a pair is only reported if ShouldCollide accepts its filters.
+         */
+        void FindPossiblePairs() noexcept override;
+
+        /**
+         * @brief Finds the same pairs as FindPossiblePairs, handing them to the callback each time PairChunkSize of them
+         * are found instead of keeping them all.
+         * \n Note : colliderPairs is the chunk buffer, it is left empty.
+         * @param callback The callback consuming the chunks of pairs.
+         */
+        void FindPossiblePairs(PairCallback& callback) noexcept override;
+
+        /**
+         * @return colliderPairs, the pairs of the last FindPossiblePairs.
+         */
+        [[nodiscard]] const AllocatedVector<ColliderPair>& ColliderPairs() const noexcept override;
+
+        /**
+         * @brief Gives to the callback every collider whose AABB overlaps the given AABB.
+         * \n Note : The min endpoints on X are walked in order until the first one past the query, the endpoints are
+         * the ones sorted by the last FindPossiblePairs.
+         * @param aabb The AABB to query.
+         * @param queryIndex The index given back to the callback with each collider found.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept override;
+
+        /**
+         * @brief Clears the sweep and prune, resetting it to an empty state.
+         */
+        void Clear() noexcept override;
+
+    private:
+        PairCallback* _pairCallback = nullptr;
+        AllocatedVector <std::uint32_t> _activeColliders{StandardAllocator < std::uint32_t > {heapAllocator}};
+        std::size_t _addedCount = 0;
+        bool _hasRemovedColliders = false;
+
+        void sortEndpoints(AllocatedVector <SweepEndpoint>& endpoints, bool isAxisX) noexcept;
+
+        void sweep(const AllocatedVector <SweepEndpoint>& endpoints, bool isAxisX) noexcept;
+    };
+}
@@ -1,38 +1,140 @@
 #pragma once
 
 #include "QuadTree.h"
+#include "AABBTree.h"
+#include "SweepAndPrune.h"
+#include "SpatialHashGrid.h"
+#include "LinearQuadTree.h"
+#include "KdTree.h"
+#include "BruteForceBroadPhase.h"
+#include "BroadPhase.h"
 #include "Body.h"
 #include "Collider.h"
 #include "ContactListener.h"
+#include "QueryCallback.h"
+#include "RayCast.h"
+#include "NearestCallback.h"
 #include "Contact.h"
+#include "ContactManifold.h"
 #ifdef TRACY_ENABLE
 #include <Tracy.hpp>
 #include <TracyC.h>
 #endif
 
+#include <array>
+#include <cstdint>
 #include <cstdlib>
+#include <unordered_map>
 #include <vector>
 
 namespace Engine
 {
+    /**
+     * @enum BroadPhaseType
+     * @brief Enumerates the BroadPhase implementations built in the World, a structure given to World::SetBroadPhase
+     * is used instead of any of them.
+     * - QUAD_TREE: A persistent QuadTree, fast when colliders are spread over a bounded world.
+     * - AABB_TREE: A dynamic AABB tree, robust when colliders of very different sizes are mixed.
+     * - SWEEP_AND_PRUNE: Sorted endpoint lists, fast when bodies only move a little between two steps.
+     * - SPATIAL_HASH_GRID: A hashed uniform grid, the cheapest when the colliders have about the same size.
+     * - LINEAR_QUAD_TREE: A quadtree rebuilt each step from sorted Morton keys, for large scenes.
+     * - KD_TREE: A k-d tree rebuilt each step by median splits, its leaves stay balanced when the colliders cluster.
+     */
+    enum class BroadPhaseType
+    {
+        QUAD_TREE,
+        AABB_TREE,
+        SWEEP_AND_PRUNE,
+        SPATIAL_HASH_GRID,
+        LINEAR_QUAD_TREE,
+        KD_TREE
+    };
+
+    /**
+     * @enum ContactSolverType
+     * @brief Enumerates the ways the World runs the velocity iterations on the contacts gathered in a step.
+     * - SEQUENTIAL: Each iteration resolves the contacts one at a time, in the order of the broad phase.
+     * - WIDE: The contacts are grouped in batches of ContactBatchSize contacts that share no dynamic body, each
+     *   batch is solved at once by SolveContacts8 on velocities packed as structure of arrays, for large piles.
+     */
+    enum class ContactSolverType
+    {
+        SEQUENTIAL,
+        WIDE
+    };
+
+    /**
+     * @struct ColliderPairState
+     * @brief Represents what the World keeps of a colliding pair from one step to the next.
+     *
+     * The struct has the following members:
+     * - `std::size_t stepIndex`: The last step the pair was reported colliding in.
+     * - `float normalImpulse`: The impulse accumulated by the solver on the contact of the pair that step.
+     */
+    struct ColliderPairState
+    {
+        std::size_t stepIndex = 0;
+        float normalImpulse = 0.0f;
+    };
+
     /**
      * @class World
      * @brief Represents the simulation world containing bodies, colliders, and managing collision detection.
      *
      * The World class represents the simulation world, containing bodies, colliders, and managing the physics simulation,
-     * including collision detection and resolution. It uses a QuadTree for spatial partitioning to optimize collision detection.
+     * including collision detection and resolution. Its broad phase is any BroadPhase implementation, a QuadTree by default.
      *
      * The class has the following private members:
      * - `std::vector<Body> _bodies`: Vector storing the bodies in the world.
      * - `std::vector<std::size_t> _genIndices`: Vector storing the generation indices of bodies.
      * - `std::vector<Collider> _colliders`: Vector storing the colliders in the world.
      * - `std::vector<std::size_t> _collidersGenIndices`: Vector storing the generation indices of colliders.
-     * - `std::unordered_set<ColliderPair, ColliderPairHash> _colliderPairs`: Unordered set storing collider pairs.
+     * - `std::unordered_map<ColliderPair, ColliderPairState, ColliderPairHash> _colliderPairs`: The colliding pairs with their state.
+     * - `AllocatedVector<SimplifedCollider> _dynamicColliders`: The non static colliders of the current step, queried against the staticTree.
+     * - `AllocatedVector<ColliderPair> _staticPairs`: The pairs of a non static collider with a static collider found this step.
+     * - `AllocatedVector<Math::RectangleF> _queryAabbs`: The AABBs of the points of the last QueryPoints.
+     * - `Math::RectangleF _dynamicBounds`: The bounds of the non static colliders of the current step.
+     * - `AllocatedVector<float> _circleCenterAX, _circleCenterAY, _circleCenterBX, _circleCenterBY, _circleRadiusSums`: The circle-circle pairs of the pairs being resolved, packed for CircleContacts8.
+     * - `AllocatedVector<float> _circleNormalX, _circleNormalY, _circlePenetrations`: The contacts computed for the packed circle-circle pairs.
+     * - `AllocatedVector<std::uint8_t> _pairShapes`: The ShapePairIndex of each pair being resolved.
+     * - `std::array<std::uint32_t, ShapePairCount + 1> _bucketStarts`: The start of the bucket of each shape pair in _bucketedPairs.
+     * - `AllocatedVector<std::uint32_t> _bucketedPairs`: The indices of the pairs being resolved, bucketed by shape pair.
+     * - `AllocatedVector<ContactManifold> _manifolds`: The manifold of each pair being resolved.
+     * - `AllocatedVector<Contact> _contacts`: The contacts gathered this step, solved together once every pair is measured.
+     * - `AllocatedVector<ColliderPairState*> _contactStates`: The state of the pair of each contact, to warm start it and store its impulse.
+     * - `static constexpr std::size_t ContactColorCount = 64`: The number of colors of the wide solver, a contact that fits none is solved alone.
+     * - `AllocatedVector<std::uint64_t> _bodyColors`: The colors already taken by the contacts of each body.
+     * - `AllocatedVector<std::uint8_t> _contactColors`: The color of each contact, ContactColorCount when it fits none.
+     * - `std::array<std::uint32_t, ContactColorCount + 2> _colorStarts`: The start of each color in _coloredContacts.
+     * - `AllocatedVector<std::uint32_t> _coloredContacts`: The indices of the contacts, sorted by color.
+     * - `AllocatedVector<float> _rowNormalX, _rowNormalY, _rowNormalMass, _rowVelocityBias, _rowInverseMassA, _rowInverseMassB, _rowNormalImpulse`: The contacts packed for SolveContacts8, in batches of ContactBatchSize.
+     * - `AllocatedVector<std::int32_t> _rowBodyA, _rowBodyB`: The bodies of the packed contacts, as indices in the packed velocities.
+     * - `AllocatedVector<std::uint32_t> _rowContacts`: The contact of each packed row, NoContactRow for the padding.
+     * - `AllocatedVector<float> _solverVelocityX, _solverVelocityY`: The velocities of the bodies packed by body index, followed by a still padding body.
+     * - `BroadPhase* _customBroadPhase`: The broad phase given to SetBroadPhase, nullptr to use broadPhaseType.
+     * - `BroadPhase* _activeBroadPhase`: The broad phase of the last step, cleared when another one takes over.
+     * - `AllocatedVector<ColliderPair> _checkedPairs`: The pairs streamed by the broad phase this step, kept while isCheckingBroadPhase is set.
+     * - `AllocatedVector<std::uint64_t> _checkedPairKeys, _referencePairKeys`: The sorted keys of the pairs compared by checkBroadPhase.
      * - `static constexpr std::size_t initSizeForVector = 500`: Constant defining the initial size for vectors.
      *
      * The class also has the following public members:
      * - `ContactListener* contactListener`: Pointer to a contact listener for handling collision events.
      * - `QuadTree tree`: QuadTree for spatial partitioning.
+     * - `AABBTree aabbTree`: Dynamic AABB tree for spatial partitioning.
+     * - `SweepAndPrune sweepAndPrune`: Sweep and prune on the colliders AABBs.
+     * - `SpatialHashGrid spatialHashGrid`: Uniform grid hashed in buckets.
+     * - `LinearQuadTree linearQuadTree`: Pointer-free quadtree built from Morton keys.
+     * - `KdTree kdTree`: Median split k-d tree with fixed size leaves.
+     * - `AABBTree staticTree`: The colliders of static bodies, kept out of the broad phase structure chosen by broadPhaseType.
+     * - `BroadPhaseType broadPhaseType`: The built in structure used by the broad phase, the QuadTree by default.
+     * - `BruteForceBroadPhase referenceBroadPhase`: The O(n²) broad phase the active one is checked against.
+     * - `bool isCheckingBroadPhase`: Debug mode running referenceBroadPhase next to the active broad phase each step.
+     * - `AllocatedVector<ColliderPair> missedPairs`: The pairs of the last checked step found by the reference only.
+     * - `AllocatedVector<ColliderPair> duplicatePairs`: The pairs of the last checked step reported more than once, once per extra report.
+     * - `std::size_t solverIterations`: The number of velocity iterations run on the contacts of a step.
+     * - `bool isWarmStarting`: Starts the contacts from the impulse of their pair on the previous step.
+     * - `ContactSolverType contactSolverType`: The way the velocity iterations run, SEQUENTIAL by default.
+     * - `static constexpr std::size_t DefaultSolverIterations`: The default value of solverIterations.
      *
      * The class provides the following methods:
      * - `void Init() noexcept`: Initializes the World vector size bodies, colliders, and related data structures.
@@ -46,8 +148,21 @@ namespace Engine
      * - `Collider& GetCollider(ColliderRef colliderRef)`: Retrieves the reference to a specific collider in the World.
      * - `void DestroyCollider(ColliderRef colliderRef) noexcept`: Destroys the specified collider in the World.
      * - `static bool IsContact(const Engine::Collider& colliderA, const Engine::Collider& colliderB) noexcept`: Checks if there is a contact/overlap between two colliders.
-     * - `void ResolveBroadPhase() noexcept`: Resolves broad-phase collision detection using a QuadTree.
-     * - `void ResolveNarrowPhase() noexcept`: Resolves narrow-phase collision detection and applies it if necessary using a QuadTree.
+     * - `void ResolveBroadPhase() noexcept`: Updates the broad-phase structure chosen by broadPhaseType and finds the possible collider pairs.
+     * - `void ResolveNarrowPhase() noexcept`: Resolves narrow-phase collision detection on the broad-phase pairs and applies it if necessary.
+     * - `void ResolveCollisions() noexcept`: Runs both phases as one pipeline, resolving the broad-phase pairs chunk by chunk.
+     * - `BroadPhase& GetBroadPhase() noexcept`: Returns the broad phase the next step uses.
+     * - `void SetBroadPhase(BroadPhase* broadPhase) noexcept`: Replaces the built in broad phases by another implementation.
+     * - `std::size_t QueryAABB(const Math::RectangleF& aabb, ColliderRef* colliderRefs, std::size_t capacity) noexcept`: Finds the colliders whose AABB overlaps an AABB.
+     * - `void QueryAABB(const Math::RectangleF& aabb, QueryCallback& callback) noexcept`: Finds the colliders whose AABB overlaps an AABB.
+     * - `void QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept`: Answers a batch of AABB queries.
+     * - `std::size_t QueryPoint(Math::Vec2F point, ColliderRef* colliderRefs, std::size_t capacity) noexcept`: Finds the colliders containing a point.
+     * - `void QueryPoint(Math::Vec2F point, QueryCallback& callback) noexcept`: Finds the colliders containing a point.
+     * - `void QueryPoints(const Math::Vec2F* points, std::size_t queryCount, QueryCallback& callback) noexcept`: Answers a batch of point queries.
+     * - `RayCastHit RayCast(const Ray& ray) noexcept`: Finds the first collider hit by a ray or a cast circle.
+     * - `void RayCasts(const Ray* rays, std::size_t rayCount, RayCastHit* hits) noexcept`: Finds the first collider hit by each ray of a batch.
+     * - `std::size_t QueryNearest(Math::Vec2F point, std::size_t k, NearestCollider* nearest) noexcept`: Finds the k colliders nearest to a point.
+     * - `void QueryNearests(const Math::Vec2F* points, std::size_t queryCount, std::size_t k, NearestCollider* nearest, std::size_t* counts) noexcept`: Answers a batch of nearest neighbour queries.
      *
      * This class encapsulates the functionality of a physics simulation world with collision detection and resolution.
      */
@@ -61,16 +176,75 @@ namespace Engine
         std::vector<std::size_t> _collidersGenIndices;
 
         HeapAllocator heapAlloc;
-        std::unordered_set<ColliderPair, ColliderPairHash, std::equal_to<ColliderPair>, StandardAllocator<ColliderPair>> _colliderPairs{
+        std::unordered_map<ColliderPair, ColliderPairState, ColliderPairHash, std::equal_to<ColliderPair>,
+                StandardAllocator<std::pair<const ColliderPair, ColliderPairState>>> _colliderPairs{
                 heapAlloc
         };
+        std::size_t _stepIndex = 0;
+        AllocatedVector<SimplifedCollider> _dynamicColliders{StandardAllocator<SimplifedCollider>{heapAlloc}};
+        AllocatedVector<ColliderPair> _staticPairs{StandardAllocator<ColliderPair>{heapAlloc}};
+        AllocatedVector<Math::RectangleF> _queryAabbs{StandardAllocator<Math::RectangleF>{heapAlloc}};
+        Math::RectangleF _dynamicBounds{Math::Vec2F::Zero(), Math::Vec2F::Zero()};
+        AllocatedVector<float> _circleCenterAX{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _circleCenterAY{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _circleCenterBX{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _circleCenterBY{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _circleRadiusSums{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _circleNormalX{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _circleNormalY{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _circlePenetrations{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<std::uint8_t> _pairShapes{StandardAllocator<std::uint8_t>{heapAlloc}};
+        std::array<std::uint32_t, ShapePairCount + 1> _bucketStarts{};
+        AllocatedVector<std::uint32_t> _bucketedPairs{StandardAllocator<std::uint32_t>{heapAlloc}};
+        AllocatedVector<ContactManifold> _manifolds{StandardAllocator<ContactManifold>{heapAlloc}};
+        AllocatedVector<Contact> _contacts{StandardAllocator<Contact>{heapAlloc}};
+        AllocatedVector<ColliderPairState*> _contactStates{StandardAllocator<ColliderPairState*>{heapAlloc}};
+        static constexpr std::size_t ContactColorCount = 64;
+        static constexpr std::uint32_t NoContactRow = UINT32_MAX;
+        AllocatedVector<std::uint64_t> _bodyColors{StandardAllocator<std::uint64_t>{heapAlloc}};
+        AllocatedVector<std::uint8_t> _contactColors{StandardAllocator<std::uint8_t>{heapAlloc}};
+        std::array<std::uint32_t, ContactColorCount + 2> _colorStarts{};
+        AllocatedVector<std::uint32_t> _coloredContacts{StandardAllocator<std::uint32_t>{heapAlloc}};
+        AllocatedVector<float> _rowNormalX{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _rowNormalY{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _rowNormalMass{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _rowVelocityBias{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _rowInverseMassA{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _rowInverseMassB{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _rowNormalImpulse{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<std::int32_t> _rowBodyA{StandardAllocator<std::int32_t>{heapAlloc}};
+        AllocatedVector<std::int32_t> _rowBodyB{StandardAllocator<std::int32_t>{heapAlloc}};
+        AllocatedVector<std::uint32_t> _rowContacts{StandardAllocator<std::uint32_t>{heapAlloc}};
+        AllocatedVector<float> _solverVelocityX{StandardAllocator<float>{heapAlloc}};
+        AllocatedVector<float> _solverVelocityY{StandardAllocator<float>{heapAlloc}};
+        BroadPhase* _customBroadPhase = nullptr;
+        BroadPhase* _activeBroadPhase = nullptr;
+        AllocatedVector<ColliderPair> _checkedPairs{StandardAllocator<ColliderPair>{heapAlloc}};
+        AllocatedVector<std::uint64_t> _checkedPairKeys{StandardAllocator<std::uint64_t>{heapAlloc}};
+        AllocatedVector<std::uint64_t> _referencePairKeys{StandardAllocator<std::uint64_t>{heapAlloc}};
 
         static constexpr std::size_t initSizeForVector = 500;
 
 
     public :
+        static constexpr std::size_t DefaultSolverIterations = 8;
+
         ContactListener* contactListener = nullptr;
         QuadTree tree;
+        AABBTree aabbTree;
+        SweepAndPrune sweepAndPrune;
+        SpatialHashGrid spatialHashGrid;
+        LinearQuadTree linearQuadTree;
+        KdTree kdTree;
+        AABBTree staticTree;
+        BroadPhaseType broadPhaseType = BroadPhaseType::QUAD_TREE;
+        BruteForceBroadPhase referenceBroadPhase;
+        bool isCheckingBroadPhase = false;
+        AllocatedVector<ColliderPair> missedPairs{StandardAllocator<ColliderPair>{heapAlloc}};
+        AllocatedVector<ColliderPair> duplicatePairs{StandardAllocator<ColliderPair>{heapAlloc}};
+        std::size_t solverIterations = DefaultSolverIterations;
+        bool isWarmStarting = true;
+        ContactSolverType contactSolverType = ContactSolverType::SEQUENTIAL;
 
         World() noexcept = default;
 
@@ -154,15 +328,207 @@ namespace Engine
         static bool IsContact(const Engine::Collider& colliderA, const Engine::Collider& colliderB) noexcept;
 
         /**
-         * @brief Resolves broad-phase collision detection and only detection using a QuadTree.
+         * @brief Resolves broad-phase collision detection and only detection using the structure of GetBroadPhase.
+         * \n Note : The structures persist across steps, only the colliders that left their fat AABB are moved.
+         * The colliders of static bodies are kept in the staticTree, which only changes when they are added, removed or
+         * moved, and is queried with the other colliders, so two static colliders are never paired.
+         * The structures only report the pairs whose collision filters collide, the other pairs never reach the narrow phase.
+         * With isCheckingBroadPhase set, referenceBroadPhase runs on the same colliders and missedPairs and
+         * duplicatePairs list the differences.
          */
         void ResolveBroadPhase() noexcept;
 
         /**
-         * @brief Resolves narrow-phase collision detection and Apply it if necessary using a QuadTree.
+         * @brief Resolves narrow-phase collision detection on the broad-phase pairs and Apply it if necessary.
+         * \n Note : A colliding pair that is no longer reported by the broad phase has separated and gets its exit event.
+         * Each pair is measured once into a ContactManifold that decides the contact and feeds the Contact. The pairs
+         * are bucketed by shape pair first: the circle-circle bucket is measured ContactBatchSize pairs at a time with
+         * CircleContacts8, the other buckets with their loop of CollideBucketTable, then the contacts are gathered in
+         * the order of the broad phase. Once every pair is measured, solverIterations sequential impulse iterations run
+         * over all the contacts, one by one or in batches depending on contactSolverType, warm started with the impulses
+         * of the previous step if isWarmStarting is set, and the interpenetrations are corrected last.
          */
         void ResolveNarrowPhase() noexcept;
 
+        /**
+         * @brief Updates the broad-phase structures like ResolveBroadPhase, then resolves the pairs like ResolveNarrowPhase
+         * while the broad phase finds them: the pairs come in chunks of PairChunkSize and each chunk is resolved as soon
+         * as it is full, so the pairs are still in cache and the pair buffer never grows past a chunk.
+         * \n Note : Update uses it, ResolveBroadPhase and ResolveNarrowPhase are kept to run or time the phases apart.
+         * The chunks only gather the contacts, they are solved together at the end of the step, so the events and
+         * the bodies are the same as with the two phases in a row. With isCheckingBroadPhase set, the streamed pairs
+         * are also kept to be checked against referenceBroadPhase once the step is resolved.
+         */
+        void ResolveCollisions() noexcept;
+
+        /**
+         * @brief Returns the broad phase used by the steps and the queries: the one given to SetBroadPhase if any, the
+         * built in structure chosen by broadPhaseType otherwise.
+         * \n Note : Its VisitNodes lets a debug view draw the structure whatever it is.
+         */
+        [[nodiscard]] BroadPhase& GetBroadPhase() noexcept;
+
+        /**
+         * @brief Replaces the built in broad phases by another implementation, from the next step on.
+         * \n Note : The World neither owns nor initializes it. Switching broad phase, here or with broadPhaseType,
+         * clears the previous one on the next step, the new one receives every collider during that step.
+         * @param broadPhase The broad phase to use, nullptr to go back to the one chosen by broadPhaseType.
+         */
+        void SetBroadPhase(BroadPhase* broadPhase) noexcept;
+
+        /**
+         * @brief Finds the colliders whose AABB overlaps the given AABB, walking the broad phase structures.
+         * \n Note : The structures are the ones of the last ResolveBroadPhase, nothing is allocated.
+         * @param aabb The AABB to query.
+         * @param colliderRefs The buffer receiving the colliders found.
+         * @param capacity The number of colliders the buffer can hold.
+         * @return The number of colliders found, only the first capacity ones are written if it is larger.
+         */
+        std::size_t QueryAABB(const Math::RectangleF& aabb, ColliderRef* colliderRefs, std::size_t capacity) noexcept;
+
+        /**
+         * @brief Gives to the callback the colliders whose AABB overlaps the given AABB, with the query index 0.
+         * @param aabb The AABB to query.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryAABB(const Math::RectangleF& aabb, QueryCallback& callback) noexcept;
+
+        /**
+         * @brief Answers a batch of AABB queries, the trees are walked once for the whole batch.
+         * @param aabbs The AABBs to query, the index of an AABB in the array is its query index.
+         * @param queryCount The number of AABBs.
+         * @param callback The callback receiving the colliders found with the index of their query.
+         */
+        void QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept;
+
+        /**
+         * @brief Finds the colliders whose shape contains the given point.
+         * @param point The point to query.
+         * @param colliderRefs The buffer receiving the colliders found.
+         * @param capacity The number of colliders the buffer can hold.
+         * @return The number of colliders found, only the first capacity ones are written if it is larger.
+         */
+        std::size_t QueryPoint(Math::Vec2F point, ColliderRef* colliderRefs, std::size_t capacity) noexcept;
+
+        /**
+         * @brief Gives to the callback the colliders whose shape contains the given point, with the query index 0.
+         * @param point The point to query.
+         * @param callback The callback receiving the colliders found.
+         */
+        void QueryPoint(Math::Vec2F point, QueryCallback& callback) noexcept;
+
+        /**
+         * @brief Answers a batch of point queries, the trees are walked once for the whole batch.
+         * @param points The points to query, the index of a point in the array is its query index.
+         * @param queryCount The number of points.
+         * @param callback The callback receiving the colliders found with the index of their query.
+         */
+        void QueryPoints(const Math::Vec2F* points, std::size_t queryCount, QueryCallback& callback) noexcept;
+
+        /**
+         * @brief Finds the first collider hit by a ray, or by a circle swept along it when the ray has a radius.
+         * @param ray The ray to cast.
+         * @return The closest hit, hasHit is false if the ray does not hit any collider.
+         */
+        [[nodiscard]] RayCastHit RayCast(const Ray& ray) noexcept;
+
+        /**
+         * @brief Finds the first collider hit by each ray of a batch.
+         * The rays traverse the trees in packets of RayPacket::Size, each node being tested against the whole packet
+         * at once, and the colliders reached are tested against every lane of the packet at once.
+         * \n Note : A ray starting inside a collider does not hit it.
+         * @param rays The rays to cast.
+         * @param rayCount The number of rays.
+         * @param hits Receives the closest hit of each ray, at the index of the ray.
+         */
+        void RayCasts(const Ray* rays, std::size_t rayCount, RayCastHit* hits) noexcept;
+
+        /**
+         * @brief Finds the k colliders nearest to a point, walking the broad phase structures closest nodes first.
+         * \n Note : The distance is measured to the collider shape, it is 0 for the colliders containing the point.
+         * @param point The query point.
+         * @param k The number of colliders wanted.
+         * @param nearest The buffer of k colliders receiving the colliders found, sorted from the nearest.
+         * @return The number of colliders found, less than k if the World has fewer colliders.
+         */
+        std::size_t QueryNearest(Math::Vec2F point, std::size_t k, NearestCollider* nearest) noexcept;
+
+        /**
+         * @brief Answers a batch of nearest neighbour queries, reusing the traversal storage between the queries.
+         * @param points The query points, the index of a point in the array is its query index.
+         * @param queryCount The number of points.
+         * @param k The number of colliders wanted for each point.
+         * @param nearest The buffer of queryCount * k colliders, the colliders of query i start at i * k.
+         * @param counts The buffer of queryCount counts, receiving the number of colliders found for each query.
+         */
+        void QueryNearests(const Math::Vec2F* points, std::size_t queryCount, std::size_t k, NearestCollider* nearest,
+                           std::size_t* counts) noexcept;
+
         const std::size_t GetInitSizeForVector() noexcept;
+
+    private:
+        [[nodiscard]] Math::RectangleF colliderAabb(const Collider& collider);
+
+        [[nodiscard]] bool isColliderAlive(ColliderRef colliderRef) const noexcept;
+
+        void queryBroadPhase(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept;
+
+        void rayCastBroadPhase(RayPacket& packet, RayCastCallback& callback) noexcept;
+
+        void updateBroadPhase() noexcept;
+
+        /**
+         * @brief Compares the pairs of the active broad phase with the pairs of referenceBroadPhase, filling
+         * missedPairs and duplicatePairs.
+         * \n Note : The pairs the reference does not find are not reported, a structure may pair fat AABBs.
+         */
+        void checkBroadPhase(const ColliderPair* pairs, std::size_t pairCount) noexcept;
+
+        void resolveSeparatedPairs() noexcept;
+
+        /**
+         * @brief Resolves the pairs in order, PairChunkSize pairs at a time.
+         */
+        void resolvePairs(const ColliderPair* pairs, std::size_t pairCount) noexcept;
+
+        /**
+         * @brief Computes the manifolds of at most PairChunkSize pairs bucket by bucket, then resolves the pairs in order.
+         */
+        void resolvePairChunk(const ColliderPair* pairs, std::size_t pairCount) noexcept;
+
+        /**
+         * @brief Computes the manifolds of the circle-circle bucket ContactBatchSize pairs at a time with CircleContacts8.
+         */
+        void collideCircleBucket(const ColliderPair* pairs, const std::uint32_t* pairIndices,
+                                 std::size_t pairCount) noexcept;
+
+        /**
+         * @brief Updates the state of a pair, then gathers its contact if its manifold has one and neither collider
+         * is a trigger.
+         */
+        void resolveManifold(const ColliderPair& pair, Collider& colliderA, Collider& colliderB,
+                             const ContactManifold& manifold) noexcept;
+
+        /**
+         * @brief Records whether the colliders of a pair touch this step and sends the matching events.
+         * @return The state of the pair, nullptr if the colliders do not touch.
+         */
+        ColliderPairState* updatePairState(const ColliderPair& pair, const Collider& colliderA,
+                                           const Collider& colliderB, bool isContact) noexcept;
+
+        /**
+         * @brief Solves the contacts gathered this step, then stores the impulse of each one in the state of its pair.
+         */
+        void solveContacts() noexcept;
+
+        /**
+         * @brief Runs the velocity iterations of the WIDE contact solver.
+         * The contacts are colored greedily so that two contacts of a color share no dynamic body, each color is cut
+         * in batches of ContactBatchSize rows, and the velocities are gathered once and written back to the bodies
+         * once the iterations are done.
+         */
+        void solveContactsWide() noexcept;
+
+        void onPairSeparated(const ColliderPair& pair) noexcept;
     };
 }
\ No newline at end of file
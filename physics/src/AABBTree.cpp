@@ -0,0 +1,651 @@
+#include "AABBTree.h"
+
+namespace Engine
+{
+    void AABBTree::Init() noexcept
+    {
+        Clear();
+        nodes.reserve(1024);
+        colliderPairs.reserve(1024);
+        _stack.reserve(256);
+        _activeQueries.reserve(1024);
+    }
+
+    void AABBTree::UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        const auto colliderIndex = simplifedCollider.colliderRef.index;
+        if (colliderIndex >= proxies.size())
+        {
+            proxies.resize(colliderIndex + 1, NullNode);
+        }
+
+        int leaf = proxies[colliderIndex];
+        if (leaf != NullNode)
+        {
+            nodes[leaf].filter = simplifedCollider.filter;
+            if (nodes[leaf].colliderRef == simplifedCollider.colliderRef &&
+                ContainsAABB(nodes[leaf].aabb, simplifedCollider.aabb))
+            {
+                return;
+            }
+            removeLeaf(leaf);
+        }
+        else
+        {
+            leaf = allocateNode();
+            proxies[colliderIndex] = leaf;
+        }
+
+        nodes[leaf].colliderRef = simplifedCollider.colliderRef;
+        nodes[leaf].filter = simplifedCollider.filter;
+        nodes[leaf].aabb = FattenAABB(simplifedCollider.aabb, FatAABBMargin);
+        nodes[leaf].height = 0;
+        insertLeaf(leaf);
+    }
+
+    void AABBTree::RemoveCollider(std::size_t colliderIndex) noexcept
+    {
+        if (colliderIndex >= proxies.size() || proxies[colliderIndex] == NullNode)
+        {
+            return;
+        }
+
+        const int leaf = proxies[colliderIndex];
+        removeLeaf(leaf);
+        freeNode(leaf);
+        proxies[colliderIndex] = NullNode;
+    }
+
+    void AABBTree::FindPossiblePairs(PairCallback& callback) noexcept
+    {
+        _pairCallback = &callback;
+        FindPossiblePairs();
+        FlushPairs(colliderPairs, _pairCallback);
+        _pairCallback = nullptr;
+    }
+
+    const AllocatedVector<ColliderPair>& AABBTree::ColliderPairs() const noexcept
+    {
+        return colliderPairs;
+    }
+
+    void AABBTree::FindPossiblePairs() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        colliderPairs.clear();
+        for (const int leaf: proxies)
+        {
+            if (leaf == NullNode)
+            {
+                continue;
+            }
+
+            const auto& leafNode = nodes[leaf];
+            _stack.clear();
+            _stack.push_back(root);
+            while (!_stack.empty())
+            {
+                const int nodeIndex = _stack.back();
+                _stack.pop_back();
+
+                const auto& node = nodes[nodeIndex];
+                if (!Math::Intersect(node.aabb, leafNode.aabb))
+                {
+                    continue;
+                }
+
+                if (node.child1 == NullNode)
+                {
+                    // Only report the pair from the collider with the lowest index.
+                    if (node.colliderRef.index > leafNode.colliderRef.index && ShouldCollide(leafNode.filter, node.filter))
+                    {
+                        AddPair(colliderPairs, ColliderPair{leafNode.colliderRef, node.colliderRef}, _pairCallback);
+                    }
+                }
+                else
+                {
+                    _stack.push_back(node.child1);
+                    _stack.push_back(node.child2);
+                }
+            }
+        }
+    }
+
+    void AABBTree::QueryPairs(const SimplifedCollider& simplifedCollider, AllocatedVector <ColliderPair>& pairs) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (root == NullNode)
+        {
+            return;
+        }
+
+        _stack.clear();
+        _stack.push_back(root);
+        while (!_stack.empty())
+        {
+            const int nodeIndex = _stack.back();
+            _stack.pop_back();
+
+            const auto& node = nodes[nodeIndex];
+            if (!Math::Intersect(node.aabb, simplifedCollider.aabb))
+            {
+                continue;
+            }
+
+            if (node.child1 == NullNode)
+            {
+                if (ShouldCollide(simplifedCollider.filter, node.filter))
+                {
+                    pairs.push_back(ColliderPair{simplifedCollider.colliderRef, node.colliderRef});
+                }
+            }
+            else
+            {
+                _stack.push_back(node.child1);
+                _stack.push_back(node.child2);
+            }
+        }
+    }
+
+    void AABBTree::QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (root == NullNode)
+        {
+            return;
+        }
+
+        _stack.clear();
+        _stack.push_back(root);
+        while (!_stack.empty())
+        {
+            const int nodeIndex = _stack.back();
+            _stack.pop_back();
+
+            const auto& node = nodes[nodeIndex];
+            if (!Math::Intersect(node.aabb, aabb))
+            {
+                continue;
+            }
+
+            if (node.child1 == NullNode)
+            {
+                callback.OnColliderFound(queryIndex, node.colliderRef);
+            }
+            else
+            {
+                _stack.push_back(node.child1);
+                _stack.push_back(node.child2);
+            }
+        }
+    }
+
+    void AABBTree::QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (root == NullNode)
+        {
+            return;
+        }
+
+        _activeQueries.clear();
+        for (std::size_t i = 0; i < queryCount; i++)
+        {
+            if (Math::Intersect(nodes[root].aabb, aabbs[i]))
+            {
+                _activeQueries.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+        if (!_activeQueries.empty())
+        {
+            queryNodeBatch(root, 0, aabbs, callback);
+        }
+    }
+
+    void AABBTree::RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (root == NullNode || packet.laneMask == 0)
+        {
+            return;
+        }
+
+        _stack.clear();
+        _stack.push_back(root);
+        while (!_stack.empty())
+        {
+            const int nodeIndex = _stack.back();
+            _stack.pop_back();
+
+            // The node is tested when it is popped, with the maxFraction lowered by the hits found since it was pushed.
+            const auto& node = nodes[nodeIndex];
+            const auto laneMask = RaySlabMask8(node.aabb, packet) & packet.laneMask;
+            if (laneMask == 0)
+            {
+                continue;
+            }
+
+            if (node.child1 == NullNode)
+            {
+                callback.OnRayCandidate(packet, laneMask, node.colliderRef);
+            }
+            else
+            {
+                _stack.push_back(node.child1);
+                _stack.push_back(node.child2);
+            }
+        }
+    }
+
+    bool AABBTree::QueryNearest(Math::Vec2F point, std::size_t queryIndex, float maxSquareDistance,
+                                NearestCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (root == NullNode)
+        {
+            return true;
+        }
+
+        const auto isFarther = [](const NearestEntry<int>& entryA, const NearestEntry<int>& entryB)
+        {
+            return entryA.squareDistance > entryB.squareDistance;
+        };
+
+        _nearestQueue.clear();
+        _nearestQueue.push_back(NearestEntry<int>{SquareDistanceAABB(nodes[root].aabb, point), root});
+        while (!_nearestQueue.empty())
+        {
+            std::pop_heap(_nearestQueue.begin(), _nearestQueue.end(), isFarther);
+            const auto entry = _nearestQueue.back();
+            _nearestQueue.pop_back();
+
+            // Every node left in the queue is at least as far as this one.
+            if (entry.squareDistance > maxSquareDistance)
+            {
+                break;
+            }
+
+            const auto& node = nodes[entry.node];
+            if (node.child1 == NullNode)
+            {
+                maxSquareDistance = callback.OnNearestCandidate(queryIndex, node.colliderRef);
+                continue;
+            }
+
+            for (const int child: {node.child1, node.child2})
+            {
+                const float squareDistance = SquareDistanceAABB(nodes[child].aabb, point);
+                if (squareDistance <= maxSquareDistance)
+                {
+                    _nearestQueue.push_back(NearestEntry<int>{squareDistance, child});
+                    std::push_heap(_nearestQueue.begin(), _nearestQueue.end(), isFarther);
+                }
+            }
+        }
+        return true;
+    }
+
+    void AABBTree::VisitNodes(BroadPhaseVisitor& visitor) const noexcept
+    {
+        if (root != NullNode)
+        {
+            visitNode(root, 0, visitor);
+        }
+    }
+
+    bool AABBTree::HasCollider(std::size_t colliderIndex) const noexcept
+    {
+        return colliderIndex < proxies.size() && proxies[colliderIndex] != NullNode;
+    }
+
+    int AABBTree::Height() const noexcept
+    {
+        return root == NullNode ? 0 : nodes[root].height;
+    }
+
+    void AABBTree::Clear() noexcept
+    {
+        nodes.clear();
+        proxies.clear();
+        colliderPairs.clear();
+        root = NullNode;
+        _freeList = NullNode;
+    }
+
+    void AABBTree::visitNode(int nodeIndex, int depth, BroadPhaseVisitor& visitor) const noexcept
+    {
+        const auto& node = nodes[nodeIndex];
+        visitor.OnNode(node.aabb, depth);
+        if (node.child1 != NullNode)
+        {
+            visitNode(node.child1, depth + 1, visitor);
+            visitNode(node.child2, depth + 1, visitor);
+        }
+    }
+
+    int AABBTree::allocateNode() noexcept
+    {
+        if (_freeList == NullNode)
+        {
+            nodes.emplace_back();
+            return static_cast<int>(nodes.size()) - 1;
+        }
+
+        const int nodeIndex = _freeList;
+        _freeList = nodes[nodeIndex].parent;
+        nodes[nodeIndex] = AABBTreeNode{};
+        return nodeIndex;
+    }
+
+    void AABBTree::freeNode(int nodeIndex) noexcept
+    {
+        nodes[nodeIndex].parent = _freeList;
+        nodes[nodeIndex].height = -1;
+        _freeList = nodeIndex;
+    }
+
+    void AABBTree::insertLeaf(int leaf) noexcept
+    {
+        if (root == NullNode)
+        {
+            root = leaf;
+            nodes[root].parent = NullNode;
+            return;
+        }
+
+        // Descend towards the sibling with the lowest surface area heuristic cost.
+        const auto leafAabb = nodes[leaf].aabb;
+        int index = root;
+        while (nodes[index].child1 != NullNode)
+        {
+            const int child1 = nodes[index].child1;
+            const int child2 = nodes[index].child2;
+
+            const float area = PerimeterAABB(nodes[index].aabb);
+            const float combinedArea = PerimeterAABB(MergeAABB(nodes[index].aabb, leafAabb));
+
+            // Cost of creating a new parent for this node and the new leaf.
+            const float cost = 2.0f * combinedArea;
+            // Minimum cost of pushing the leaf further down the tree.
+            const float inheritanceCost = 2.0f * (combinedArea - area);
+
+            float cost1 = PerimeterAABB(MergeAABB(leafAabb, nodes[child1].aabb)) + inheritanceCost;
+            if (nodes[child1].child1 != NullNode)
+            {
+                cost1 -= PerimeterAABB(nodes[child1].aabb);
+            }
+
+            float cost2 = PerimeterAABB(MergeAABB(leafAabb, nodes[child2].aabb)) + inheritanceCost;
+            if (nodes[child2].child1 != NullNode)
+            {
+                cost2 -= PerimeterAABB(nodes[child2].aabb);
+            }
+
+            if (cost < cost1 && cost < cost2)
+            {
+                break;
+            }
+
+            index = cost1 < cost2 ? child1 : child2;
+        }
+
+        const int sibling = index;
+        const int oldParent = nodes[sibling].parent;
+        const int newParent = allocateNode();
+        nodes[newParent].parent = oldParent;
+        nodes[newParent].aabb = MergeAABB(leafAabb, nodes[sibling].aabb);
+        nodes[newParent].height = nodes[sibling].height + 1;
+        nodes[newParent].child1 = sibling;
+        nodes[newParent].child2 = leaf;
+        nodes[sibling].parent = newParent;
+        nodes[leaf].parent = newParent;
+
+        if (oldParent != NullNode)
+        {
+            if (nodes[oldParent].child1 == sibling)
+            {
+                nodes[oldParent].child1 = newParent;
+            }
+            else
+            {
+                nodes[oldParent].child2 = newParent;
+            }
+        }
+        else
+        {
+            root = newParent;
+        }
+
+        // Walk back up the tree fixing heights and AABBs.
+        index = nodes[leaf].parent;
+        while (index != NullNode)
+        {
+            index = balance(index);
+
+            const int child1 = nodes[index].child1;
+            const int child2 = nodes[index].child2;
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+            nodes[index].aabb = MergeAABB(nodes[child1].aabb, nodes[child2].aabb);
+
+            index = nodes[index].parent;
+        }
+    }
+
+    void AABBTree::removeLeaf(int leaf) noexcept
+    {
+        if (leaf == root)
+        {
+            root = NullNode;
+            return;
+        }
+
+        const int parent = nodes[leaf].parent;
+        const int grandParent = nodes[parent].parent;
+        const int sibling = nodes[parent].child1 == leaf ? nodes[parent].child2 : nodes[parent].child1;
+
+        if (grandParent == NullNode)
+        {
+            root = sibling;
+            nodes[sibling].parent = NullNode;
+            freeNode(parent);
+            return;
+        }
+
+        // Destroy the parent and connect the sibling to the grand parent.
+        if (nodes[grandParent].child1 == parent)
+        {
+            nodes[grandParent].child1 = sibling;
+        }
+        else
+        {
+            nodes[grandParent].child2 = sibling;
+        }
+        nodes[sibling].parent = grandParent;
+        freeNode(parent);
+
+        int index = grandParent;
+        while (index != NullNode)
+        {
+            index = balance(index);
+
+            const int child1 = nodes[index].child1;
+            const int child2 = nodes[index].child2;
+            nodes[index].aabb = MergeAABB(nodes[child1].aabb, nodes[child2].aabb);
+            nodes[index].height = 1 + std::max(nodes[child1].height, nodes[child2].height);
+
+            index = nodes[index].parent;
+        }
+    }
+
+    int AABBTree::balance(int nodeIndex) noexcept
+    {
+        const int iA = nodeIndex;
+        auto& a = nodes[iA];
+        if (a.child1 == NullNode || a.height < 2)
+        {
+            return iA;
+        }
+
+        const int iB = a.child1;
+        const int iC = a.child2;
+        auto& b = nodes[iB];
+        auto& c = nodes[iC];
+
+        const int heightBalance = c.height - b.height;
+
+        // Rotate C up.
+        if (heightBalance > 1)
+        {
+            const int iF = c.child1;
+            const int iG = c.child2;
+            auto& f = nodes[iF];
+            auto& g = nodes[iG];
+
+            c.child1 = iA;
+            c.parent = a.parent;
+            a.parent = iC;
+
+            if (c.parent != NullNode)
+            {
+                if (nodes[c.parent].child1 == iA)
+                {
+                    nodes[c.parent].child1 = iC;
+                }
+                else
+                {
+                    nodes[c.parent].child2 = iC;
+                }
+            }
+            else
+            {
+                root = iC;
+            }
+
+            if (f.height > g.height)
+            {
+                c.child2 = iF;
+                a.child2 = iG;
+                g.parent = iA;
+                a.aabb = MergeAABB(b.aabb, g.aabb);
+                c.aabb = MergeAABB(a.aabb, f.aabb);
+                a.height = 1 + std::max(b.height, g.height);
+                c.height = 1 + std::max(a.height, f.height);
+            }
+            else
+            {
+                c.child2 = iG;
+                a.child2 = iF;
+                f.parent = iA;
+                a.aabb = MergeAABB(b.aabb, f.aabb);
+                c.aabb = MergeAABB(a.aabb, g.aabb);
+                a.height = 1 + std::max(b.height, f.height);
+                c.height = 1 + std::max(a.height, g.height);
+            }
+
+            return iC;
+        }
+
+        // Rotate B up.
+        if (heightBalance < -1)
+        {
+            const int iD = b.child1;
+            const int iE = b.child2;
+            auto& d = nodes[iD];
+            auto& e = nodes[iE];
+
+            b.child1 = iA;
+            b.parent = a.parent;
+            a.parent = iB;
+
+            if (b.parent != NullNode)
+            {
+                if (nodes[b.parent].child1 == iA)
+                {
+                    nodes[b.parent].child1 = iB;
+                }
+                else
+                {
+                    nodes[b.parent].child2 = iB;
+                }
+            }
+            else
+            {
+                root = iB;
+            }
+
+            if (d.height > e.height)
+            {
+                b.child2 = iD;
+                a.child1 = iE;
+                e.parent = iA;
+                a.aabb = MergeAABB(c.aabb, e.aabb);
+                b.aabb = MergeAABB(a.aabb, d.aabb);
+                a.height = 1 + std::max(c.height, e.height);
+                b.height = 1 + std::max(a.height, d.height);
+            }
+            else
+            {
+                b.child2 = iE;
+                a.child1 = iD;
+                d.parent = iA;
+                a.aabb = MergeAABB(c.aabb, d.aabb);
+                b.aabb = MergeAABB(a.aabb, e.aabb);
+                a.height = 1 + std::max(c.height, d.height);
+                b.height = 1 + std::max(a.height, e.height);
+            }
+
+            return iB;
+        }
+
+        return iA;
+    }
+
+    void AABBTree::queryNodeBatch(int nodeIndex, std::size_t activeBegin, const Math::RectangleF* aabbs,
+                                  QueryCallback& callback) noexcept
+    {
+        // The queries reaching the node are at the end of _activeQueries, the children push their subset after them.
+        const auto activeEnd = _activeQueries.size();
+        const auto& node = nodes[nodeIndex];
+        if (node.child1 == NullNode)
+        {
+            for (auto i = activeBegin; i < activeEnd; i++)
+            {
+                callback.OnColliderFound(_activeQueries[i], node.colliderRef);
+            }
+            return;
+        }
+
+        for (const int child: {node.child1, node.child2})
+        {
+            const auto childAabb = nodes[child].aabb;
+            for (auto i = activeBegin; i < activeEnd; i++)
+            {
+                if (Math::Intersect(childAabb, aabbs[_activeQueries[i]]))
+                {
+                    _activeQueries.push_back(_activeQueries[i]);
+                }
+            }
+
+            if (_activeQueries.size() > activeEnd)
+            {
+                queryNodeBatch(child, activeEnd, aabbs, callback);
+                _activeQueries.resize(activeEnd);
+            }
+        }
+    }
+}
@@ -0,0 +1,57 @@
+#include "BroadPhase.h"
+
+namespace Engine
+{
+    namespace
+    {
+        /**
+         * @brief Turns the colliders found by the AABB query of one lane into ray candidates of that lane.
+         */
+        class LaneQueryCallback final : public QueryCallback
+        {
+        public:
+            LaneQueryCallback(RayPacket& packet, RayCastCallback& callback) noexcept:
+                    _packet(packet), _callback(callback)
+            {}
+
+            void OnColliderFound(std::size_t queryIndex, ColliderRef colliderRef) noexcept override
+            {
+                _callback.OnRayCandidate(_packet, 1u << queryIndex, colliderRef);
+            }
+
+        private:
+            RayPacket& _packet;
+            RayCastCallback& _callback;
+        };
+    }
+
+    void BroadPhase::QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept
+    {
+        for (std::size_t i = 0; i < queryCount; i++)
+        {
+            QueryAABB(aabbs[i], i, callback);
+        }
+    }
+
+    void BroadPhase::RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept
+    {
+        LaneQueryCallback laneCallback(packet, callback);
+        for (std::size_t lane = 0; lane < RayPacket::Size; lane++)
+        {
+            if (packet.laneMask & (1u << lane))
+            {
+                const Ray ray{Math::Vec2F(packet.originX[lane], packet.originY[lane]),
+                              Math::Vec2F(packet.translationX[lane], packet.translationY[lane]), packet.radius[lane]};
+                QueryAABB(RayAABB(ray), lane, laneCallback);
+            }
+        }
+    }
+
+    bool BroadPhase::QueryNearest(Math::Vec2F, std::size_t, float, NearestCallback&) noexcept
+    {
+        return false;
+    }
+
+    void BroadPhase::VisitNodes(BroadPhaseVisitor&) const noexcept
+    {}
+}
@@ -0,0 +1,91 @@
+#include "BruteForceBroadPhase.h"
+
+namespace Engine
+{
+    void BruteForceBroadPhase::Init() noexcept
+    {
+        Clear();
+        proxies.reserve(1024);
+        colliderPairs.reserve(1024);
+    }
+
+    void BruteForceBroadPhase::UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept
+    {
+        const auto colliderIndex = simplifedCollider.colliderRef.index;
+        if (colliderIndex >= proxies.size())
+        {
+            proxies.resize(colliderIndex + 1);
+        }
+
+        proxies[colliderIndex].simplifedCollider = simplifedCollider;
+        proxies[colliderIndex].isActive = true;
+    }
+
+    void BruteForceBroadPhase::RemoveCollider(std::size_t colliderIndex) noexcept
+    {
+        if (colliderIndex < proxies.size())
+        {
+            proxies[colliderIndex].isActive = false;
+        }
+    }
+
+    void BruteForceBroadPhase::FindPossiblePairs() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        colliderPairs.clear();
+        for (std::size_t i = 0; i < proxies.size(); i++)
+        {
+            if (!proxies[i].isActive)
+            {
+                continue;
+            }
+
+            const auto& colliderA = proxies[i].simplifedCollider;
+            for (std::size_t j = i + 1; j < proxies.size(); j++)
+            {
+                const auto& colliderB = proxies[j].simplifedCollider;
+                if (proxies[j].isActive && Math::Intersect(colliderA.aabb, colliderB.aabb) &&
+                    ShouldCollide(colliderA.filter, colliderB.filter))
+                {
+                    AddPair(colliderPairs, ColliderPair{colliderA.colliderRef, colliderB.colliderRef}, _pairCallback);
+                }
+            }
+        }
+    }
+
+    void BruteForceBroadPhase::FindPossiblePairs(PairCallback& callback) noexcept
+    {
+        _pairCallback = &callback;
+        FindPossiblePairs();
+        FlushPairs(colliderPairs, _pairCallback);
+        _pairCallback = nullptr;
+    }
+
+    const AllocatedVector<ColliderPair>& BruteForceBroadPhase::ColliderPairs() const noexcept
+    {
+        return colliderPairs;
+    }
+
+    void BruteForceBroadPhase::QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex,
+                                         QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        for (const auto& proxy: proxies)
+        {
+            if (proxy.isActive && Math::Intersect(proxy.simplifedCollider.aabb, aabb))
+            {
+                callback.OnColliderFound(queryIndex, proxy.simplifedCollider.colliderRef);
+            }
+        }
+    }
+
+    void BruteForceBroadPhase::Clear() noexcept
+    {
+        proxies.clear();
+        colliderPairs.clear();
+    }
+}
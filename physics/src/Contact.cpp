@@ -1,172 +1,105 @@
 #include "Contact.h"
 
+#include <algorithm>
+
 float Engine::Contact::CalculateSeparateVelocity() const noexcept
 {
     const auto relativeVelocity = collidingBodies[0] . body -> Velocity() - collidingBodies[1] . body -> Velocity();
     return relativeVelocity . Dot(contactNormal);
 }
 
-void Engine::Contact::ResolveVelocity() const noexcept
+void Engine::Contact::Prepare(const ContactManifold& manifold) noexcept
 {
-    const auto separatingVelocity = CalculateSeparateVelocity();
-    if (separatingVelocity > 0)
+    contactNormal = manifold . normal;
+    penetration = manifold . depth;
+    contactPosition = manifold . points[0];
+    if (manifold . pointCount == ContactManifold::MaxPointCount)
     {
-        return;
+        contactPosition = (manifold . points[0] + manifold . points[1]) * 0.5f;
     }
-    //Restitution Implementation
-    const auto newSeparateVelocity = -separatingVelocity * restitution;
-    const auto deltaVelocity = newSeparateVelocity - separatingVelocity;
-
-    const auto inverseMassBody1 = 1 / collidingBodies[0] . body -> Mass();
-    const auto inverseMassBody2 = 1 / collidingBodies[1] . body -> Mass();
-    const auto totalInverseMass = inverseMassBody1 + inverseMassBody2;
 
-    const auto impulse = deltaVelocity / totalInverseMass;
-    const auto impulsePerIMass = contactNormal * impulse;
+    const auto mass1 = collidingBodies[0] . body -> Mass(), mass2 = collidingBodies[1] . body -> Mass();
+    const auto rest1 = collidingBodies[0] . collider -> restitution, rest2 = collidingBodies[1] . collider -> restitution;
+    restitution = (mass1 * rest1 + mass2 * rest2) / (mass1 + mass2);
 
-    if (collidingBodies[0] . body -> type == BodyType::DYNAMIC)
+    // Only a dynamic body with a mass is moved, the other bodies act as an infinite mass.
+    for (std::size_t i = 0; i < collidingBodies . size(); i++)
     {
-        collidingBodies[0] . body -> SetVelocity(
-                collidingBodies[0] . body -> Velocity() + impulsePerIMass * inverseMassBody1);
-    }
-    else if (collidingBodies[0] . body -> type == BodyType::STATIC)
-    {
-        collidingBodies[1] . body -> SetVelocity(
-                collidingBodies[1] . body -> Velocity() - impulsePerIMass * inverseMassBody1);
+        const auto* body = collidingBodies[i] . body;
+        inverseMasses[i] = body -> type == BodyType::DYNAMIC && body -> Mass() > 0 ? 1 / body -> Mass() : 0.0f;
     }
+    const auto totalInverseMass = inverseMasses[0] + inverseMasses[1];
+    normalMass = totalInverseMass > 0 ? 1 / totalInverseMass : 0.0f;
 
-    if (collidingBodies[1] . body -> type == BodyType::DYNAMIC)
-    {
-        collidingBodies[1] . body -> SetVelocity(
-                collidingBodies[1] . body -> Velocity() - impulsePerIMass * inverseMassBody2);
-    }
-    else if (collidingBodies[1] . body -> type == BodyType::STATIC)
-    {
-        collidingBodies[0] . body -> SetVelocity(
-                collidingBodies[0] . body -> Velocity() + impulsePerIMass * inverseMassBody2);
-    }
+    // The bounce is measured before any impulse, the iterations must not feed it back into itself.
+    const auto separatingVelocity = CalculateSeparateVelocity();
+    velocityBias = separatingVelocity < 0 ? -separatingVelocity * restitution : 0.0f;
 }
 
-void Engine::Contact::ResolveInterpenetration() const noexcept
+void Engine::Contact::WarmStart() const noexcept
+{
+    applyImpulse(normalImpulse);
+}
+
+void Engine::Contact::ResolveVelocity() noexcept
 {
-    if (penetration <= 0)
+    if (normalMass <= 0)
     {
         return;
     }
 
-    const auto inverseMassBody1 = 1 / collidingBodies[0] . body -> Mass();
-    const auto inverseMassBody2 = 1 / collidingBodies[1] . body -> Mass();
-    const auto totalInverseMass = inverseMassBody1 + inverseMassBody2;
+    const auto separatingVelocity = CalculateSeparateVelocity();
+    const auto impulse = (velocityBias - separatingVelocity) * normalMass;
+
+    // The accumulated impulse is clamped rather than each correction, an iteration may take back part of a previous one.
+    const auto accumulatedImpulse = std::max(normalImpulse + impulse, 0.0f);
+    applyImpulse(accumulatedImpulse - normalImpulse);
+    normalImpulse = accumulatedImpulse;
+}
 
-    if (totalInverseMass <= 0)
+void Engine::Contact::ResolveInterpenetration() const noexcept
+{
+    if (penetration <= 0 || normalMass <= 0)
     {
         return;
     }
 
-    const auto movePerIMass = contactNormal * (penetration / totalInverseMass);
-    if (collidingBodies[0] . body -> type == BodyType::DYNAMIC)
+    const auto movePerIMass = contactNormal * (penetration * normalMass);
+    if (inverseMasses[0] > 0)
     {
         collidingBodies[0] . body -> SetPosition(
-                collidingBodies[0] . body -> Position() + movePerIMass * inverseMassBody1);
+                collidingBodies[0] . body -> Position() + movePerIMass * inverseMasses[0]);
     }
-    if (collidingBodies[1] . body -> type == BodyType::DYNAMIC)
+    if (inverseMasses[1] > 0)
     {
         collidingBodies[1] . body -> SetPosition(
-                collidingBodies[1] . body -> Position() - movePerIMass * inverseMassBody2);
+                collidingBodies[1] . body -> Position() - movePerIMass * inverseMasses[1]);
     }
 }
 
 void Engine::Contact::Resolve()
 {
-    const auto delta = collidingBodies[0] . body -> Position() - collidingBodies[1] . body -> Position();
-    switch (collidingBodies[0] . collider -> _shape)
-    {
-        case (Math::ShapeType::Circle):
-            switch (collidingBodies[1] . collider -> _shape)
-            {
-                case (Math::ShapeType::Circle):
-                {
-                    contactNormal = delta . Normalized();
-                    penetration = collidingBodies[0] . collider -> circleShape . Radius() +
-                                  collidingBodies[1] . collider -> circleShape . Radius() - delta . Length();
-                }
-                    break;
-                case Math::ShapeType::Rectangle:
-                {
-                    const auto circleCenter = collidingBodies[0] . collider -> circleShape . Center();
-                    const auto rectCenter = collidingBodies[1] . collider -> rectangleShape . Center();
-                    const auto rectHalfSize = collidingBodies[1] . collider -> rectangleShape . HalfSize();
-
-                    const auto delta = circleCenter - rectCenter;
-
-                    Math::Vec2F closestPoint;
-
-                    closestPoint . X = Math::Clamp(delta . X, -rectHalfSize . X, rectHalfSize . X);
-                    closestPoint . Y = Math::Clamp(delta . Y, -rectHalfSize . Y, rectHalfSize . Y);
-
-                    const auto distance = (closestPoint - delta) . Length();
-                    const auto closestPointOnRect = rectCenter + closestPoint;
-
-                    auto circleToRectClosestPoint = (circleCenter - closestPointOnRect);
-
-                    if (circleToRectClosestPoint . Length() <= Math::Epsilon)
-                    {
-                        circleToRectClosestPoint = Math::Vec2F(0.f, 1.f);
-                    }
-
-                    contactNormal = circleToRectClosestPoint . Normalized();
-                    penetration = collidingBodies[0] . collider -> circleShape . Radius() - distance;
-                }
-
-
-                default:
-                    break;
-            }
-            break;
-        case Math::ShapeType::Rectangle:
-            switch (collidingBodies[1] . collider -> _shape)
-            {
-                case (Math::ShapeType::Circle):
-                {
-                    std::swap(collidingBodies[0], collidingBodies[1]);
-                    Resolve();
-                }
-                    break;
-                case (Math::ShapeType::Rectangle):
-                {
-                    const Math::Vec2F penetrationVec2F(
-                            collidingBodies[0] . collider -> rectangleShape . HalfSize() +
-                            collidingBodies[1] . collider -> rectangleShape . HalfSize() -
-                            Math::Vec2F(std::abs(delta . X), std::abs(delta . Y))
-                    );
-
-                    if (penetrationVec2F . X < penetrationVec2F . Y)
-                    {
-                        contactNormal = delta . X > 0 ? Math::Vec2F(1.0f, 0.0f) : Math::Vec2F(-1.0f, 0.0f);
-
-                        penetration = penetrationVec2F . Normalized() . X;
-                    }
-                    else
-                    {
-                        contactNormal = delta . Y > 0 ? Math::Vec2F(0.f, 1.0f) : Math::Vec2F(0.f, -1.0f);
-
-                        penetration = penetrationVec2F . Normalized() . Y;
-                    }
-                }
-                    break;
-                default:
-                    break;
-
-            }
-            break;
-        default:
-            break;
-    }
-
-    const auto mass1 = collidingBodies[0] . body -> Mass(), mass2 = collidingBodies[1] . body -> Mass();
-    const auto rest1 = collidingBodies[0] . collider -> restitution, rest2 = collidingBodies[1] . collider -> restitution;
+    Resolve(Collide(*collidingBodies[0] . collider, *collidingBodies[1] . collider));
+}
 
-    restitution = (mass1 * rest1 + mass2 * rest2) / (mass1 + mass2);
+void Engine::Contact::Resolve(const ContactManifold& manifold) noexcept
+{
+    Prepare(manifold);
     ResolveVelocity();
     ResolveInterpenetration();
 }
+
+void Engine::Contact::applyImpulse(float impulse) const noexcept
+{
+    const auto impulsePerIMass = contactNormal * impulse;
+    if (inverseMasses[0] > 0)
+    {
+        collidingBodies[0] . body -> SetVelocity(
+                collidingBodies[0] . body -> Velocity() + impulsePerIMass * inverseMasses[0]);
+    }
+    if (inverseMasses[1] > 0)
+    {
+        collidingBodies[1] . body -> SetVelocity(
+                collidingBodies[1] . body -> Velocity() - impulsePerIMass * inverseMasses[1]);
+    }
+}
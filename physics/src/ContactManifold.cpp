@@ -0,0 +1,128 @@
+#include "ContactManifold.h"
+#include "Const.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine
+{
+    ContactManifold CollideCircles(const Math::CircleF& circleA, const Math::CircleF& circleB) noexcept
+    {
+        ContactManifold manifold;
+        const auto delta = circleA.Center() - circleB.Center();
+        const auto radiusSum = circleA.Radius() + circleB.Radius();
+        const auto squareDistance = delta.SquareLength();
+        if (squareDistance > radiusSum * radiusSum)
+        {
+            return manifold;
+        }
+
+        const auto distance = std::sqrt(squareDistance);
+        if (distance > Math::Epsilon)
+        {
+            manifold.normal = delta / distance;
+        }
+        manifold.depth = radiusSum - distance;
+        manifold.points[0] = circleB.Center() + manifold.normal * (circleB.Radius() - manifold.depth * 0.5f);
+        manifold.pointCount = 1;
+        return manifold;
+    }
+
+    ContactManifold CollideCircleRectangle(const Math::CircleF& circle, const Math::RectangleF& rectangle) noexcept
+    {
+        ContactManifold manifold;
+        const auto rectangleCenter = rectangle.Center();
+        const auto halfSize = rectangle.HalfSize();
+        const auto delta = circle.Center() - rectangleCenter;
+
+        // The center is inside, the circle leaves through the side it is closest to.
+        if (std::abs(delta.X) <= halfSize.X && std::abs(delta.Y) <= halfSize.Y)
+        {
+            const auto distanceX = halfSize.X - std::abs(delta.X);
+            const auto distanceY = halfSize.Y - std::abs(delta.Y);
+            if (distanceX < distanceY)
+            {
+                const auto side = delta.X < 0.0f ? -1.0f : 1.0f;
+                manifold.normal = Math::Vec2F(side, 0.0f);
+                manifold.depth = circle.Radius() + distanceX;
+                manifold.points[0] = rectangleCenter + Math::Vec2F(side * halfSize.X, delta.Y);
+            }
+            else
+            {
+                const auto side = delta.Y < 0.0f ? -1.0f : 1.0f;
+                manifold.normal = Math::Vec2F(0.0f, side);
+                manifold.depth = circle.Radius() + distanceY;
+                manifold.points[0] = rectangleCenter + Math::Vec2F(delta.X, side * halfSize.Y);
+            }
+            manifold.pointCount = 1;
+            return manifold;
+        }
+
+        const auto closestPoint = rectangleCenter + Math::Vec2F(std::clamp(delta.X, -halfSize.X, halfSize.X),
+                                                                std::clamp(delta.Y, -halfSize.Y, halfSize.Y));
+        const auto toCircle = circle.Center() - closestPoint;
+        const auto squareDistance = toCircle.SquareLength();
+        if (squareDistance > circle.Radius() * circle.Radius())
+        {
+            return manifold;
+        }
+
+        const auto distance = std::sqrt(squareDistance);
+        if (distance > Math::Epsilon)
+        {
+            manifold.normal = toCircle / distance;
+        }
+        manifold.depth = circle.Radius() - distance;
+        manifold.points[0] = closestPoint;
+        manifold.pointCount = 1;
+        return manifold;
+    }
+
+    ContactManifold CollideRectangleCircle(const Math::RectangleF& rectangle, const Math::CircleF& circle) noexcept
+    {
+        auto manifold = CollideCircleRectangle(circle, rectangle);
+        manifold.normal = -manifold.normal;
+        return manifold;
+    }
+
+    ContactManifold CollideRectangles(const Math::RectangleF& rectangleA, const Math::RectangleF& rectangleB) noexcept
+    {
+        ContactManifold manifold;
+        const auto delta = rectangleA.Center() - rectangleB.Center();
+        const auto overlap = rectangleA.HalfSize() + rectangleB.HalfSize() -
+                             Math::Vec2F(std::abs(delta.X), std::abs(delta.Y));
+        if (overlap.X < 0.0f || overlap.Y < 0.0f)
+        {
+            return manifold;
+        }
+
+        // The touching sides are replaced by the line halfway between them, clipped to the overlap on the other axis.
+        if (overlap.X < overlap.Y)
+        {
+            const auto side = delta.X > 0.0f ? 1.0f : -1.0f;
+            const auto x = side > 0.0f ? (rectangleA.MinBound().X + rectangleB.MaxBound().X) * 0.5f :
+                           (rectangleA.MaxBound().X + rectangleB.MinBound().X) * 0.5f;
+            const auto minY = std::max(rectangleA.MinBound().Y, rectangleB.MinBound().Y);
+            const auto maxY = std::min(rectangleA.MaxBound().Y, rectangleB.MaxBound().Y);
+            manifold.normal = Math::Vec2F(side, 0.0f);
+            manifold.depth = overlap.X;
+            manifold.points[0] = Math::Vec2F(x, minY);
+            manifold.points[1] = Math::Vec2F(x, maxY);
+            manifold.pointCount = minY < maxY ? 2 : 1;
+        }
+        else
+        {
+            const auto side = delta.Y > 0.0f ? 1.0f : -1.0f;
+            const auto y = side > 0.0f ? (rectangleA.MinBound().Y + rectangleB.MaxBound().Y) * 0.5f :
+                           (rectangleA.MaxBound().Y + rectangleB.MinBound().Y) * 0.5f;
+            const auto minX = std::max(rectangleA.MinBound().X, rectangleB.MinBound().X);
+            const auto maxX = std::min(rectangleA.MaxBound().X, rectangleB.MaxBound().X);
+            manifold.normal = Math::Vec2F(0.0f, side);
+            manifold.depth = overlap.Y;
+            manifold.points[0] = Math::Vec2F(minX, y);
+            manifold.points[1] = Math::Vec2F(maxX, y);
+            manifold.pointCount = minX < maxX ? 2 : 1;
+        }
+        return manifold;
+    }
+}
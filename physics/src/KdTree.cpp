@@ -0,0 +1,299 @@
+#include "KdTree.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    void KdTree::Init() noexcept
+    {
+        Clear();
+        leafSize = std::max(leafSize, 1u);
+        proxies.reserve(1024);
+        entries.reserve(1024);
+        nodes.reserve(2 * (1024 / leafSize + 1));
+        colliderPairs.reserve(1024);
+        for (auto* packedBounds: {&_packedMinX, &_packedMinY, &_packedMaxX, &_packedMaxY})
+        {
+            packedBounds->reserve(1024 + OverlapBatchSize);
+        }
+        for (auto* packedFilterBits: {&_packedCategoryBits, &_packedMaskBits})
+        {
+            packedFilterBits->reserve(1024 + OverlapBatchSize);
+        }
+        _packedGroupIndices.reserve(1024 + OverlapBatchSize);
+    }
+
+    void KdTree::UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept
+    {
+        const auto colliderIndex = simplifedCollider.colliderRef.index;
+        if (colliderIndex >= proxies.size())
+        {
+            proxies.resize(colliderIndex + 1);
+        }
+
+        proxies[colliderIndex].simplifedCollider = simplifedCollider;
+        proxies[colliderIndex].isActive = true;
+    }
+
+    void KdTree::RemoveCollider(std::size_t colliderIndex) noexcept
+    {
+        if (colliderIndex < proxies.size())
+        {
+            proxies[colliderIndex].isActive = false;
+        }
+    }
+
+    void KdTree::FindPossiblePairs(PairCallback& callback) noexcept
+    {
+        _pairCallback = &callback;
+        FindPossiblePairs();
+        FlushPairs(colliderPairs, _pairCallback);
+        _pairCallback = nullptr;
+    }
+
+    const AllocatedVector<ColliderPair>& KdTree::ColliderPairs() const noexcept
+    {
+        return colliderPairs;
+    }
+
+    void KdTree::FindPossiblePairs() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        colliderPairs.clear();
+        entries.clear();
+        nodes.clear();
+
+        for (std::size_t i = 0; i < proxies.size(); i++)
+        {
+            if (proxies[i].isActive)
+            {
+                const auto center = proxies[i].simplifedCollider.aabb.Center();
+                entries.push_back(KdTreeEntry{center.X, center.Y, static_cast<std::uint32_t>(i)});
+            }
+        }
+        if (entries.empty())
+        {
+            return;
+        }
+
+        // The build only reorders the entries, packing them afterwards lays out each leaf contiguously.
+        const auto colliderCount = static_cast<std::uint32_t>(entries.size());
+        buildNode(0, colliderCount, 0);
+
+        // OverlapMask8 and FilterMask8 always read a full batch.
+        _packedMinX.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMinY.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMaxX.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMaxY.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedCategoryBits.resize(colliderCount + OverlapBatchSize, 0);
+        _packedMaskBits.resize(colliderCount + OverlapBatchSize, 0);
+        _packedGroupIndices.resize(colliderCount + OverlapBatchSize, 0);
+        for (std::uint32_t i = 0; i < colliderCount; i++)
+        {
+            const auto& simplifedCollider = proxies[entries[i].colliderIndex].simplifedCollider;
+            _packedMinX[i] = simplifedCollider.aabb.MinBound().X;
+            _packedMinY[i] = simplifedCollider.aabb.MinBound().Y;
+            _packedMaxX[i] = simplifedCollider.aabb.MaxBound().X;
+            _packedMaxY[i] = simplifedCollider.aabb.MaxBound().Y;
+            _packedCategoryBits[i] = simplifedCollider.filter.categoryBits;
+            _packedMaskBits[i] = simplifedCollider.filter.maskBits;
+            _packedGroupIndices[i] = simplifedCollider.filter.groupIndex;
+        }
+
+        findPairs(0);
+    }
+
+    void KdTree::QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (nodes.empty())
+        {
+            return;
+        }
+
+        queryNode(aabb, 0, queryIndex, callback);
+    }
+
+    void KdTree::Clear() noexcept
+    {
+        proxies.clear();
+        entries.clear();
+        nodes.clear();
+        colliderPairs.clear();
+    }
+
+    void KdTree::VisitNodes(BroadPhaseVisitor& visitor) const noexcept
+    {
+        if (!nodes.empty())
+        {
+            visitNode(0, 0, visitor);
+        }
+    }
+
+    std::uint32_t KdTree::buildNode(std::uint32_t begin, std::uint32_t end, std::uint32_t depth) noexcept
+    {
+        const auto nodeIndex = static_cast<std::uint32_t>(nodes.size());
+        nodes.push_back(KdTreeNode{});
+        nodes[nodeIndex].begin = begin;
+        nodes[nodeIndex].end = end;
+
+        if (end - begin <= std::max(leafSize, 1u))
+        {
+            auto bounds = proxies[entries[begin].colliderIndex].simplifedCollider.aabb;
+            for (std::uint32_t i = begin + 1; i < end; i++)
+            {
+                bounds = MergeAABB(bounds, proxies[entries[i].colliderIndex].simplifedCollider.aabb);
+            }
+            nodes[nodeIndex].bounds = bounds;
+            return nodeIndex;
+        }
+
+        const auto middle = begin + (end - begin) / 2;
+        const bool isSplitOnX = depth % 2 == 0;
+        std::nth_element(entries.begin() + begin, entries.begin() + middle, entries.begin() + end,
+                         [isSplitOnX](const KdTreeEntry& entryA, const KdTreeEntry& entryB)
+                         {
+                             return isSplitOnX ? entryA.centerX < entryB.centerX : entryA.centerY < entryB.centerY;
+                         });
+
+        // The children push nodes, nodes is only indexed once they are built.
+        const auto leftChild = buildNode(begin, middle, depth + 1);
+        const auto rightChild = buildNode(middle, end, depth + 1);
+        nodes[nodeIndex].rightChild = rightChild;
+        nodes[nodeIndex].bounds = MergeAABB(nodes[leftChild].bounds, nodes[rightChild].bounds);
+        return nodeIndex;
+    }
+
+    void KdTree::findPairs(std::uint32_t nodeIndex) noexcept
+    {
+        const auto& node = nodes[nodeIndex];
+        if (node.IsLeaf())
+        {
+            for (std::uint32_t i = node.begin; i < node.end; i++)
+            {
+                addOverlappingPairs(i, i + 1, node.end);
+            }
+            return;
+        }
+
+        const auto leftChild = nodeIndex + 1;
+        const auto rightChild = node.rightChild;
+        findPairs(leftChild);
+        findPairs(rightChild);
+        findPairs(leftChild, rightChild);
+    }
+
+    void KdTree::findPairs(std::uint32_t nodeIndexA, std::uint32_t nodeIndexB) noexcept
+    {
+        const auto& nodeA = nodes[nodeIndexA];
+        const auto& nodeB = nodes[nodeIndexB];
+        if (!Math::Intersect(nodeA.bounds, nodeB.bounds))
+        {
+            return;
+        }
+
+        if (nodeA.IsLeaf() && nodeB.IsLeaf())
+        {
+            for (std::uint32_t i = nodeA.begin; i < nodeA.end; i++)
+            {
+                addOverlappingPairs(i, nodeB.begin, nodeB.end);
+            }
+            return;
+        }
+
+        const bool isDescendingB = nodeA.IsLeaf() ||
+                                   (!nodeB.IsLeaf() && nodeB.end - nodeB.begin > nodeA.end - nodeA.begin);
+        if (isDescendingB)
+        {
+            const auto rightChildB = nodeB.rightChild;
+            findPairs(nodeIndexA, nodeIndexB + 1);
+            findPairs(nodeIndexA, rightChildB);
+        }
+        else
+        {
+            const auto rightChildA = nodeA.rightChild;
+            findPairs(nodeIndexA + 1, nodeIndexB);
+            findPairs(rightChildA, nodeIndexB);
+        }
+    }
+
+    void KdTree::addOverlappingPairs(std::uint32_t i, std::uint32_t begin, std::uint32_t end) noexcept
+    {
+        const auto& colliderA = proxies[entries[i].colliderIndex].simplifedCollider;
+        for (std::uint32_t batchStart = begin; batchStart < end; batchStart += OverlapBatchSize)
+        {
+            auto mask = OverlapMask8(colliderA.aabb, &_packedMinX[batchStart], &_packedMinY[batchStart],
+                                     &_packedMaxX[batchStart], &_packedMaxY[batchStart]);
+            const auto batchCount = end - batchStart;
+            if (batchCount < OverlapBatchSize)
+            {
+                mask &= (1u << batchCount) - 1;
+            }
+            if (mask != 0)
+            {
+                mask &= FilterMask8(colliderA.filter, &_packedCategoryBits[batchStart], &_packedMaskBits[batchStart],
+                                    &_packedGroupIndices[batchStart]);
+            }
+
+            for (std::uint32_t j = batchStart; mask != 0; j++, mask >>= 1)
+            {
+                if (mask & 1)
+                {
+                    const auto& colliderB = proxies[entries[j].colliderIndex].simplifedCollider;
+                    AddPair(colliderPairs, ColliderPair{colliderA.colliderRef, colliderB.colliderRef}, _pairCallback);
+                }
+            }
+        }
+    }
+
+    void KdTree::visitNode(std::uint32_t nodeIndex, int depth, BroadPhaseVisitor& visitor) const noexcept
+    {
+        const auto& node = nodes[nodeIndex];
+        visitor.OnNode(node.bounds, depth);
+        if (!node.IsLeaf())
+        {
+            visitNode(nodeIndex + 1, depth + 1, visitor);
+            visitNode(node.rightChild, depth + 1, visitor);
+        }
+    }
+
+    void KdTree::queryNode(const Math::RectangleF& aabb, std::uint32_t nodeIndex, std::size_t queryIndex,
+                           QueryCallback& callback) const noexcept
+    {
+        const auto& node = nodes[nodeIndex];
+        if (!Math::Intersect(node.bounds, aabb))
+        {
+            return;
+        }
+
+        if (!node.IsLeaf())
+        {
+            queryNode(aabb, nodeIndex + 1, queryIndex, callback);
+            queryNode(aabb, node.rightChild, queryIndex, callback);
+            return;
+        }
+
+        for (std::uint32_t batchStart = node.begin; batchStart < node.end; batchStart += OverlapBatchSize)
+        {
+            auto mask = OverlapMask8(aabb, &_packedMinX[batchStart], &_packedMinY[batchStart],
+                                     &_packedMaxX[batchStart], &_packedMaxY[batchStart]);
+            const auto batchCount = node.end - batchStart;
+            if (batchCount < OverlapBatchSize)
+            {
+                mask &= (1u << batchCount) - 1;
+            }
+
+            for (std::uint32_t j = batchStart; mask != 0; j++, mask >>= 1)
+            {
+                if (mask & 1)
+                {
+                    callback.OnColliderFound(queryIndex, proxies[entries[j].colliderIndex].simplifedCollider.colliderRef);
+                }
+            }
+        }
+    }
+}
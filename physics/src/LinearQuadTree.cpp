@@ -0,0 +1,326 @@
+#include "LinearQuadTree.h"
+
+#include <algorithm>
+#include <array>
+
+namespace Engine
+{
+    static_assert(LinearQuadTree::MaxLevel < 1u << LinearQuadTree::LevelBitCount,
+                  "The node level must fit in the level bits of the key");
+
+    static std::uint32_t SpreadBits(std::uint32_t value) noexcept
+    {
+        value = (value | (value << 8)) & 0x00FF00FFu;
+        value = (value | (value << 4)) & 0x0F0F0F0Fu;
+        value = (value | (value << 2)) & 0x33333333u;
+        value = (value | (value << 1)) & 0x55555555u;
+        return value;
+    }
+
+    static std::uint32_t MortonCode(std::uint32_t x, std::uint32_t y) noexcept
+    {
+        return SpreadBits(x) | (SpreadBits(y) << 1);
+    }
+
+    void LinearQuadTree::Init() noexcept
+    {
+        Clear();
+        proxies.reserve(1024);
+        entries.reserve(1024);
+        _sortBuffer.reserve(1024);
+        colliderPairs.reserve(1024);
+        for (auto* packedBounds: {&_packedMinX, &_packedMinY, &_packedMaxX, &_packedMaxY})
+        {
+            packedBounds->reserve(1024 + OverlapBatchSize);
+        }
+        for (auto* packedFilterBits: {&_packedCategoryBits, &_packedMaskBits})
+        {
+            packedFilterBits->reserve(1024 + OverlapBatchSize);
+        }
+        _packedGroupIndices.reserve(1024 + OverlapBatchSize);
+    }
+
+    void LinearQuadTree::UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept
+    {
+        const auto colliderIndex = simplifedCollider.colliderRef.index;
+        if (colliderIndex >= proxies.size())
+        {
+            proxies.resize(colliderIndex + 1);
+        }
+
+        proxies[colliderIndex].simplifedCollider = simplifedCollider;
+        proxies[colliderIndex].isActive = true;
+    }
+
+    void LinearQuadTree::RemoveCollider(std::size_t colliderIndex) noexcept
+    {
+        if (colliderIndex < proxies.size())
+        {
+            proxies[colliderIndex].isActive = false;
+        }
+    }
+
+    void LinearQuadTree::FindPossiblePairs(PairCallback& callback) noexcept
+    {
+        _pairCallback = &callback;
+        FindPossiblePairs();
+        FlushPairs(colliderPairs, _pairCallback);
+        _pairCallback = nullptr;
+    }
+
+    const AllocatedVector<ColliderPair>& LinearQuadTree::ColliderPairs() const noexcept
+    {
+        return colliderPairs;
+    }
+
+    void LinearQuadTree::FindPossiblePairs() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        colliderPairs.clear();
+        entries.clear();
+
+        bool isFirstCollider = true;
+        for (const auto& proxy: proxies)
+        {
+            if (proxy.isActive)
+            {
+                bounds = isFirstCollider ? proxy.simplifedCollider.aabb : MergeAABB(bounds, proxy.simplifedCollider.aabb);
+                isFirstCollider = false;
+            }
+        }
+        if (isFirstCollider)
+        {
+            return;
+        }
+
+        constexpr float CellCount = static_cast<float>(1u << MaxLevel);
+        const auto size = bounds.Size();
+        _scaleX = CellCount / std::max(size.X, 1.0f);
+        _scaleY = CellCount / std::max(size.Y, 1.0f);
+
+        for (std::size_t i = 0; i < proxies.size(); i++)
+        {
+            if (proxies[i].isActive)
+            {
+                entries.push_back(LinearQuadTreeEntry{computeKey(proxies[i].simplifedCollider.aabb),
+                                                      static_cast<std::uint32_t>(i)});
+            }
+        }
+        radixSort();
+
+        // OverlapMask8 and FilterMask8 always read a full batch.
+        const auto colliderCount = static_cast<std::uint32_t>(entries.size());
+        _packedMinX.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMinY.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMaxX.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMaxY.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedCategoryBits.resize(colliderCount + OverlapBatchSize, 0);
+        _packedMaskBits.resize(colliderCount + OverlapBatchSize, 0);
+        _packedGroupIndices.resize(colliderCount + OverlapBatchSize, 0);
+        for (std::uint32_t i = 0; i < colliderCount; i++)
+        {
+            const auto& simplifedCollider = proxies[entries[i].colliderIndex].simplifedCollider;
+            _packedMinX[i] = simplifedCollider.aabb.MinBound().X;
+            _packedMinY[i] = simplifedCollider.aabb.MinBound().Y;
+            _packedMaxX[i] = simplifedCollider.aabb.MaxBound().X;
+            _packedMaxY[i] = simplifedCollider.aabb.MaxBound().Y;
+            _packedCategoryBits[i] = simplifedCollider.filter.categoryBits;
+            _packedMaskBits[i] = simplifedCollider.filter.maskBits;
+            _packedGroupIndices[i] = simplifedCollider.filter.groupIndex;
+        }
+
+        // A collider can only overlap the colliders of its subtree, which follow it in the sorted entries.
+        for (std::uint32_t i = 0; i < colliderCount; i++)
+        {
+            const auto subtreeEndKey = SubtreeEndKey(entries[i].key);
+            const auto subtreeEndIterator = std::lower_bound(
+                    entries.begin() + i + 1, entries.end(), subtreeEndKey,
+                    [](const LinearQuadTreeEntry& entry, std::uint64_t key)
+                    {
+                        return entry.key < key;
+                    });
+            const auto subtreeEnd = static_cast<std::uint32_t>(subtreeEndIterator - entries.begin());
+
+            const auto& colliderA = proxies[entries[i].colliderIndex].simplifedCollider;
+            for (std::uint32_t batchStart = i + 1; batchStart < subtreeEnd; batchStart += OverlapBatchSize)
+            {
+                auto mask = OverlapMask8(colliderA.aabb, &_packedMinX[batchStart], &_packedMinY[batchStart],
+                                         &_packedMaxX[batchStart], &_packedMaxY[batchStart]);
+                const auto batchCount = subtreeEnd - batchStart;
+                if (batchCount < OverlapBatchSize)
+                {
+                    mask &= (1u << batchCount) - 1;
+                }
+                if (mask != 0)
+                {
+                    mask &= FilterMask8(colliderA.filter, &_packedCategoryBits[batchStart], &_packedMaskBits[batchStart],
+                                        &_packedGroupIndices[batchStart]);
+                }
+
+                for (std::uint32_t j = batchStart; mask != 0; j++, mask >>= 1)
+                {
+                    if (mask & 1)
+                    {
+                        const auto& colliderB = proxies[entries[j].colliderIndex].simplifedCollider;
+                        AddPair(colliderPairs, ColliderPair{colliderA.colliderRef, colliderB.colliderRef},
+                                _pairCallback);
+                    }
+                }
+            }
+        }
+    }
+
+    void LinearQuadTree::QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex,
+                                   QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (entries.empty())
+        {
+            return;
+        }
+
+        const auto keyLess = [](const LinearQuadTreeEntry& entry, std::uint64_t key)
+        {
+            return entry.key < key;
+        };
+        const auto entryIndex = [this](auto iterator)
+        {
+            return static_cast<std::uint32_t>(iterator - entries.begin());
+        };
+
+        // The subtree of the query node, the node included.
+        const auto queryKey = computeKey(aabb);
+        const auto subtreeBegin = std::lower_bound(entries.begin(), entries.end(), queryKey, keyLess);
+        const auto subtreeEnd = std::lower_bound(subtreeBegin, entries.end(), SubtreeEndKey(queryKey), keyLess);
+        queryRange(aabb, entryIndex(subtreeBegin), entryIndex(subtreeEnd), queryIndex, callback);
+
+        // The ancestors of the query node, each one is the first cell of the query node at a shallower level.
+        const auto queryCell = queryKey >> LevelBitCount;
+        for (std::uint32_t level = 0; level < Level(queryKey); level++)
+        {
+            const auto cellMask = ~((std::uint64_t{1} << 2 * (MaxLevel - level)) - 1);
+            const auto ancestorKey = ((queryCell & cellMask) << LevelBitCount) | level;
+            const auto ancestorBegin = std::lower_bound(entries.begin(), subtreeBegin, ancestorKey, keyLess);
+            const auto ancestorEnd = std::lower_bound(ancestorBegin, subtreeBegin, ancestorKey + 1, keyLess);
+            queryRange(aabb, entryIndex(ancestorBegin), entryIndex(ancestorEnd), queryIndex, callback);
+        }
+    }
+
+    void LinearQuadTree::Clear() noexcept
+    {
+        proxies.clear();
+        entries.clear();
+        _sortBuffer.clear();
+        colliderPairs.clear();
+        bounds = Math::RectangleF(Math::Vec2F::Zero(), Math::Vec2F::Zero());
+    }
+
+    std::uint32_t LinearQuadTree::Level(std::uint64_t key) noexcept
+    {
+        return static_cast<std::uint32_t>(key & ((1u << LevelBitCount) - 1));
+    }
+
+    std::uint64_t LinearQuadTree::SubtreeEndKey(std::uint64_t key) noexcept
+    {
+        const auto firstCell = key >> LevelBitCount;
+        const auto cellCount = std::uint64_t{1} << 2 * (MaxLevel - Level(key));
+        return (firstCell + cellCount) << LevelBitCount;
+    }
+
+    std::uint64_t LinearQuadTree::computeKey(const Math::RectangleF& aabb) const noexcept
+    {
+        static constexpr std::uint32_t MaxCell = (1u << MaxLevel) - 1;
+        const auto quantize = [](float coordinate, float origin, float scale)
+        {
+            const float cell = (coordinate - origin) * scale;
+            return cell <= 0.0f ? 0u : std::min(static_cast<std::uint32_t>(cell), MaxCell);
+        };
+
+        const auto origin = bounds.MinBound();
+        const auto minX = quantize(aabb.MinBound().X, origin.X, _scaleX);
+        const auto minY = quantize(aabb.MinBound().Y, origin.Y, _scaleY);
+        const auto maxX = quantize(aabb.MaxBound().X, origin.X, _scaleX);
+        const auto maxY = quantize(aabb.MaxBound().Y, origin.Y, _scaleY);
+
+        // The deepest node containing both bounds is above the highest bit that differs between them.
+        auto differentBits = (minX ^ maxX) | (minY ^ maxY);
+        std::uint32_t levelsBelow = 0;
+        while (differentBits != 0)
+        {
+            levelsBelow++;
+            differentBits >>= 1;
+        }
+
+        const auto cellMask = ~((1u << levelsBelow) - 1);
+        const auto firstCell = MortonCode(minX & cellMask, minY & cellMask);
+        return (static_cast<std::uint64_t>(firstCell) << LevelBitCount) | (MaxLevel - levelsBelow);
+    }
+
+    void LinearQuadTree::radixSort() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        constexpr std::uint32_t KeyBitCount = 2 * MaxLevel + LevelBitCount;
+        constexpr std::uint32_t DigitBitCount = 8;
+        constexpr std::uint32_t DigitCount = 1u << DigitBitCount;
+
+        _sortBuffer.resize(entries.size());
+        std::array<std::uint32_t, DigitCount> digitStarts{};
+        for (std::uint32_t shift = 0; shift < KeyBitCount; shift += DigitBitCount)
+        {
+            digitStarts.fill(0);
+            for (const auto& entry: entries)
+            {
+                digitStarts[(entry.key >> shift) & (DigitCount - 1)]++;
+            }
+
+            // Every key has the same digit, the pass would not change the order.
+            if (digitStarts[(entries.front().key >> shift) & (DigitCount - 1)] == entries.size())
+            {
+                continue;
+            }
+
+            std::uint32_t digitStart = 0;
+            for (auto& start: digitStarts)
+            {
+                const auto count = start;
+                start = digitStart;
+                digitStart += count;
+            }
+
+            for (const auto& entry: entries)
+            {
+                _sortBuffer[digitStarts[(entry.key >> shift) & (DigitCount - 1)]++] = entry;
+            }
+            entries.swap(_sortBuffer);
+        }
+    }
+
+    void LinearQuadTree::queryRange(const Math::RectangleF& aabb, std::uint32_t begin, std::uint32_t end,
+                                    std::size_t queryIndex, QueryCallback& callback) const noexcept
+    {
+        for (std::uint32_t batchStart = begin; batchStart < end; batchStart += OverlapBatchSize)
+        {
+            auto mask = OverlapMask8(aabb, &_packedMinX[batchStart], &_packedMinY[batchStart],
+                                     &_packedMaxX[batchStart], &_packedMaxY[batchStart]);
+            const auto batchCount = end - batchStart;
+            if (batchCount < OverlapBatchSize)
+            {
+                mask &= (1u << batchCount) - 1;
+            }
+
+            for (std::uint32_t j = batchStart; mask != 0; j++, mask >>= 1)
+            {
+                if (mask & 1)
+                {
+                    callback.OnColliderFound(queryIndex, proxies[entries[j].colliderIndex].simplifedCollider.colliderRef);
+                }
+            }
+        }
+    }
+}
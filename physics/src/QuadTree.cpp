@@ -1,5 +1,10 @@
 #include "QuadTree.h"
 
+#include <algorithm>
+#include <system_error>
+#include <thread>
+#include <vector>
+
 namespace Engine
 {
     void QuadTree::Subdivide(QuadNode& node)
@@ -19,178 +24,1041 @@ namespace Engine
         const auto topMiddle = Math::Vec2F(center.X, center.Y + halfSize.Y);
         const auto bottomMiddle = Math::Vec2F(center.X, center.Y - halfSize.Y);
 
-        node.children[0] = &nodes[nodeIndex];
+        QuadNode* block = allocateNodeBlock();
+
+        node.children[0] = block;
         node.children[0]->bounds = Math::RectangleF(leftMiddle, topMiddle);
-        node.children[1] = &nodes[nodeIndex + 1];
+        node.children[1] = block + 1;
         node.children[1]->bounds = Math::RectangleF(center, topRightCorner);
-        node.children[2] = &nodes[nodeIndex + 2];
+        node.children[2] = block + 2;
         node.children[2]->bounds = Math::RectangleF(bottomLeftCorner, center);
-        node.children[3] = &nodes[nodeIndex + 3];
+        node.children[3] = block + 3;
         node.children[3]->bounds = Math::RectangleF(bottomMiddle, rightMiddle);
 
-        nodeIndex += 4;
+        for (std::size_t i = 0; i < node.children.size(); i++)
+        {
+            auto* child = node.children[i];
+            child->parent = &node;
+            child->depth = node.depth + 1;
+
+            const auto childBounds = LooseBounds(*child);
+            node.childMinX[i] = childBounds.MinBound().X;
+            node.childMinY[i] = childBounds.MinBound().Y;
+            node.childMaxX[i] = childBounds.MaxBound().X;
+            node.childMaxY[i] = childBounds.MaxBound().Y;
+        }
     };
 
+    void QuadTree::UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        const auto colliderIndex = simplifedCollider.colliderRef.index;
+        if (colliderIndex >= proxies.size())
+        {
+            proxies.resize(colliderIndex + 1);
+        }
+
+        const auto fatAabb = FattenAABB(simplifedCollider.aabb, FatAABBMargin);
+        auto& proxy = proxies[colliderIndex];
+        if (proxy.node != nullptr)
+        {
+            auto& node = *proxy.node;
+            auto& storedCollider = proxy.collider;
+            if (storedCollider.colliderRef == simplifedCollider.colliderRef)
+            {
+                storedCollider.filter = simplifedCollider.filter;
+                if (ContainsAABB(storedCollider.aabb, simplifedCollider.aabb))
+                {
+                    return;
+                }
+
+                // The collider left its fat AABB but may still belong to the same node.
+                if (ContainsAABB(LooseBounds(node), fatAabb) && findContainingChild(node, fatAabb) == nullptr)
+                {
+                    storedCollider.aabb = fatAabb;
+                    return;
+                }
+            }
+            removeFromNode(colliderIndex);
+        }
+
+        InsertInRootNode(SimplifedCollider{simplifedCollider.colliderRef, fatAabb, simplifedCollider.filter});
+    }
+
+    void QuadTree::RemoveCollider(std::size_t colliderIndex) noexcept
+    {
+        if (colliderIndex < proxies.size() && proxies[colliderIndex].node != nullptr)
+        {
+            removeFromNode(colliderIndex);
+        }
+    }
+
+    void QuadTree::Rebalance() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (_isRootOutgrown || isLoose != _isTreeLoose)
+        {
+            rebuild();
+        }
+        layoutColliders();
+
+        // The subtree of a node is contiguous in colliders, merging it only changes the node of its proxies.
+        for (auto* node: _mergeCandidates)
+        {
+            if (node->children[0] != nullptr && node->subtreeColliderCount <= maxColliderInNode / 2)
+            {
+                mergeChildren(*node);
+            }
+        }
+        _mergeCandidates.clear();
+
+        splitOverflowingLeaves(root);
+    }
+
     void QuadTree::InsertInRootNode(const SimplifedCollider& simplifedCollider) noexcept
     {
 #ifdef TRACY_ENABLE
         ZoneScoped;
 #endif
+        QuadNode* node = &root;
+
+        if (!ContainsAABB(node->bounds, simplifedCollider.aabb))
+        {
+            _isRootOutgrown = true;
+        }
+        else
+        {
+            while (QuadNode* containingChild = findContainingChild(*node, simplifedCollider.aabb))
+            {
+                node = containingChild;
+            }
+        }
+
+        addInNode(*node, simplifedCollider);
+    }
+
+    void QuadTree::SubdivideNodeRecursively(QuadNode& node) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        // While the root is outgrown the whole tree is rebuilt on the next Rebalance, no need to split now.
+        if (node.colliderCount <= maxColliderInNode || node.depth >= maxDepth || node.children[0] != nullptr ||
+            _isRootOutgrown)
+        {
+            return;
+        }
 
-        auto& node = nodes[0];
+        Subdivide(node);
 
-        const Math::RectangleF& nodeBounds = node.bounds;
-        const Math::RectangleF& colliderBounds = simplifedCollider.aabb;
+        // Bucket 0 holds the colliders staying in the node, bucket i + 1 the ones moving down to the child i.
+        const auto begin = node.colliderBegin;
+        const auto count = node.colliderCount;
+        _partitionBuffer.assign(colliders.begin() + begin, colliders.begin() + begin + count);
+        _partitionBuckets.resize(count);
+        std::array<std::uint32_t, 5> bucketCounts{};
+        for (std::uint32_t i = 0; i < count; i++)
+        {
+            // The four children are one block of the node pool, a child index is its offset in the block.
+            const QuadNode* childNode = findContainingChild(node, _partitionBuffer[i].aabb);
+            _partitionBuckets[i] = childNode != nullptr ? static_cast<std::uint8_t>(childNode - node.children[0] + 1) : 0;
+            bucketCounts[_partitionBuckets[i]]++;
+        }
 
-        if (colliderBounds.MinBound().X < nodeBounds.MinBound().X)
+        std::array<std::uint32_t, 5> bucketOffsets{};
+        bucketOffsets[0] = begin;
+        for (std::size_t bucket = 1; bucket < bucketOffsets.size(); bucket++)
         {
-            node.bounds.SetMinBound(Math::Vec2F(colliderBounds.MinBound().X, nodeBounds.MinBound().Y));
+            bucketOffsets[bucket] = bucketOffsets[bucket - 1] + bucketCounts[bucket - 1];
         }
-        if (colliderBounds.MinBound().Y < nodeBounds.MinBound().Y)
+
+        node.colliderCount = bucketCounts[0];
+        for (std::size_t i = 0; i < node.children.size(); i++)
         {
-            node.bounds.SetMinBound(Math::Vec2F(nodeBounds.MinBound().X, colliderBounds.MinBound().Y));
+            auto* child = node.children[i];
+            child->colliderBegin = bucketOffsets[i + 1];
+            child->colliderCount = bucketCounts[i + 1];
+            child->subtreeColliderCount = bucketCounts[i + 1];
         }
-        if (colliderBounds.MaxBound().X > nodeBounds.MaxBound().X)
+
+        for (std::uint32_t i = 0; i < count; i++)
         {
-            node.bounds.SetMaxBound(Math::Vec2F(colliderBounds.MaxBound().X, nodeBounds.MaxBound().Y));
+            const auto bucket = _partitionBuckets[i];
+            const auto& col = _partitionBuffer[i];
+            colliders[bucketOffsets[bucket]++] = col;
+            proxies[col.colliderRef.index].node = bucket == 0 ? &node : node.children[bucket - 1];
         }
-        if (colliderBounds.MaxBound().Y > nodeBounds.MaxBound().Y)
+
+        for (auto* child: node.children)
         {
-            node.bounds.SetMaxBound(Math::Vec2F(nodeBounds.MaxBound().X, colliderBounds.MaxBound().Y));
+            SubdivideNodeRecursively(*child);
         }
-        node.colliders.push_back(simplifedCollider);
     }
 
-    void QuadTree::SubdivideNodeRecursively(QuadNode& node, int depth) noexcept
+    void QuadTree::FindPossiblePairs(QuadNode& node) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        findPossiblePairs(node, nullptr);
+    }
+
+    void QuadTree::FindPossiblePairs(QuadNode& node, PairCallback& callback) noexcept
     {
 #ifdef TRACY_ENABLE
         ZoneScoped;
 #endif
-        if (node.colliders.size() > MaxColliderInNode && depth != MaxDepth)
+        nodeColliderPairs.clear();
+        findPossiblePairs(node, &callback);
+        FlushPairs(nodeColliderPairs, &callback);
+    }
+
+    void QuadTree::FindPossiblePairs() noexcept
+    {
+        nodeColliderPairs.clear();
+        FindPossiblePairs(root);
+    }
+
+    void QuadTree::FindPossiblePairs(PairCallback& callback) noexcept
+    {
+        FindPossiblePairs(root, callback);
+    }
+
+    const AllocatedVector<ColliderPair>& QuadTree::ColliderPairs() const noexcept
+    {
+        return nodeColliderPairs;
+    }
+
+    void QuadTree::findPossiblePairs(QuadNode& node, PairCallback* callback) noexcept
+    {
+        _packedMinX.clear();
+        _packedMinY.clear();
+        _packedMaxX.clear();
+        _packedMaxY.clear();
+        _packedCategoryBits.clear();
+        _packedMaskBits.clear();
+        _packedGroupIndices.clear();
+        _packedColliderRefs.clear();
+        _packedSubtreeEnds.clear();
+        _packedNodes.clear();
+        packSubtree(node);
+
+        // OverlapMask8 and FilterMask8 always read a full batch.
+        const auto colliderCount = static_cast<std::uint32_t>(_packedColliderRefs.size());
+        _packedMinX.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMinY.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMaxX.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedMaxY.resize(colliderCount + OverlapBatchSize, 0.0f);
+        _packedCategoryBits.resize(colliderCount + OverlapBatchSize, 0);
+        _packedMaskBits.resize(colliderCount + OverlapBatchSize, 0);
+        _packedGroupIndices.resize(colliderCount + OverlapBatchSize, 0);
+
+        const std::size_t threadCount = workerCount != 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency());
+        if (threadCount - 1 != _requestedWorkerCount)
+        {
+            startWorkers();
+        }
+        if (colliderCount < ParallelColliderThreshold || _workers.empty())
+        {
+            findPackedPairs(0, colliderCount, nodeColliderPairs, callback);
+            return;
+        }
+
+        // The tasks only depend on the collider count, the threads pick them in any order. A task writes in the
+        // buffer of its index modulo the buffer count, which is only reused once the calling thread has handed it over.
+        const std::size_t taskCount = (colliderCount + PairTaskColliderCount - 1) / PairTaskColliderCount;
+        const std::size_t bufferCount = TaskBuffersPerThread * (_workers.size() + 1);
+        while (_taskPairs.size() < bufferCount)
+        {
+            _taskPairs.emplace_back(StandardAllocator < ColliderPair > {heapAllocator});
+        }
+
+        // The workers are only woken up, the calling thread takes tasks like them and hands the finished ones over.
+        std::unique_lock<std::mutex> lock(_taskMutex);
+        _taskCount = taskCount;
+        _taskDone.assign(taskCount, 0);
+        _nextTask = 0;
+        _handedTaskCount = 0;
+        _taskBufferCount = bufferCount;
+        _taskColliderCount = colliderCount;
+        _taskCallback = callback;
+        _taskWorkerCount = std::min(_workers.size(), taskCount - 1);
+        _busyWorkerCount = _taskWorkerCount;
+        _taskGeneration++;
+        _tasksPosted.notify_all();
+        runPairTasks(lock, true);
+        while (_handedTaskCount < _taskCount)
+        {
+            _tasksProgressed.wait(lock, [this]()
+            {
+                return _taskDone[_handedTaskCount] != 0;
+            });
+            handOverDoneTasks(lock);
+        }
+        _tasksProgressed.wait(lock, [this]()
+        {
+            return _busyWorkerCount == 0;
+        });
+    }
+
+    void QuadTree::startWorkers() noexcept
+    {
+        stopWorkers();
+        const std::size_t threadCount = workerCount != 0 ? workerCount : std::max(1u, std::thread::hardware_concurrency());
+        _requestedWorkerCount = threadCount - 1;
+        _workers.reserve(_requestedWorkerCount);
+        for (std::size_t i = 0; i < _requestedWorkerCount; i++)
         {
-            Subdivide(node);
-            std::vector<SimplifedCollider> collidersStayInNodes;
+            // Without more threads, the tasks are shared among the workers already started.
+            try
+            {
+                _workers.emplace_back(&QuadTree::runWorker, this, i, _taskGeneration);
+            }
+            catch (const std::system_error&)
+            {
+                break;
+            }
+        }
+    }
+
+    void QuadTree::stopWorkers() noexcept
+    {
+        {
+            std::lock_guard<std::mutex> lock(_taskMutex);
+            _isStopping = true;
+        }
+        _tasksPosted.notify_all();
+        for (auto& worker: _workers)
+        {
+            worker.join();
+        }
+        _workers.clear();
+        _isStopping = false;
+    }
 
-            for (const auto& col: node.colliders)
+    void QuadTree::runWorker(std::size_t workerIndex, std::size_t generation) noexcept
+    {
+        std::unique_lock<std::mutex> lock(_taskMutex);
+        while (true)
+        {
+            _tasksPosted.wait(lock, [this, generation]()
+            {
+                return _isStopping || _taskGeneration != generation;
+            });
+            if (_isStopping)
+            {
+                return;
+            }
+
+            // A worker beyond the number of tasks sits the step out, it is not counted in _busyWorkerCount.
+            generation = _taskGeneration;
+            if (workerIndex >= _taskWorkerCount)
+            {
+                continue;
+            }
+            runPairTasks(lock, false);
+            _busyWorkerCount--;
+            _tasksProgressed.notify_all();
+        }
+    }
+
+    void QuadTree::runPairTasks(std::unique_lock<std::mutex>& lock, bool isCallingThread) noexcept
+    {
+        while (_nextTask < _taskCount)
+        {
+            if (isCallingThread)
             {
-                int childNodePossible = 0;
-                QuadNode* childNode = nullptr;
-                for (const auto& child: node.children)
+                handOverDoneTasks(lock);
+            }
+
+            // Every buffer holds a task not handed over yet, the oldest one is always running so this only waits
+            // for it to finish.
+            if (_nextTask >= _handedTaskCount + _taskBufferCount)
+            {
+                _tasksProgressed.wait(lock);
+                continue;
+            }
+
+            const auto task = _nextTask++;
+            lock.unlock();
+
+            auto& pairs = _taskPairs[task % _taskBufferCount];
+            pairs.clear();
+            const auto begin = static_cast<std::uint32_t>(task * PairTaskColliderCount);
+            const auto end = std::min(static_cast<std::uint32_t>(begin + PairTaskColliderCount), _taskColliderCount);
+            findPackedPairs(begin, end, pairs, nullptr);
+
+            lock.lock();
+            _taskDone[task] = 1;
+            _tasksProgressed.notify_all();
+        }
+    }
+
+    void QuadTree::handOverDoneTasks(std::unique_lock<std::mutex>& lock) noexcept
+    {
+        // The buffer of a done task is only touched again once _handedTaskCount moves past it.
+        while (_handedTaskCount < _taskCount && _taskDone[_handedTaskCount] != 0)
+        {
+            const auto& pairs = _taskPairs[_handedTaskCount % _taskBufferCount];
+            lock.unlock();
+            if (_taskCallback == nullptr)
+            {
+                nodeColliderPairs.insert(nodeColliderPairs.end(), pairs.begin(), pairs.end());
+            }
+            else
+            {
+                for (std::size_t chunkBegin = 0; chunkBegin < pairs.size(); chunkBegin += PairChunkSize)
                 {
-                    if (Math::Intersect(child->bounds, col.aabb))
-                    {
-                        childNode = child;
-                        childNodePossible++;
-                    }
+                    _taskCallback->OnPairs(pairs.data() + chunkBegin, std::min(PairChunkSize, pairs.size() - chunkBegin));
                 }
+            }
+            lock.lock();
+            _handedTaskCount++;
+            _tasksProgressed.notify_all();
+        }
+    }
+
+    void QuadTree::QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        // The root is always visited, its colliders can reach outside its bounds until the next Rebalance.
+        queryNode(root, aabb, queryIndex, callback);
+    }
+
+    void QuadTree::QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        _activeQueries.clear();
+        for (std::size_t i = 0; i < queryCount; i++)
+        {
+            _activeQueries.push_back(static_cast<std::uint32_t>(i));
+        }
+        queryNodeBatch(root, 0, aabbs, callback);
+    }
+
+    void QuadTree::RayCastPacket(RayPacket& packet, RayCastCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        // The root is always visited, its colliders can reach outside its bounds until the next Rebalance.
+        if (packet.laneMask != 0)
+        {
+            rayCastNode(root, packet.laneMask, packet, callback);
+        }
+    }
+
+    bool QuadTree::QueryNearest(Math::Vec2F point, std::size_t queryIndex, float maxSquareDistance,
+                                NearestCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        const auto isFarther = [](const NearestEntry<const QuadNode*>& entryA, const NearestEntry<const QuadNode*>& entryB)
+        {
+            return entryA.squareDistance > entryB.squareDistance;
+        };
+
+        // The root is always visited, its colliders can reach outside its bounds until the next Rebalance.
+        _nearestQueue.clear();
+        _nearestQueue.push_back(NearestEntry<const QuadNode*>{0.0f, &root});
+        while (!_nearestQueue.empty())
+        {
+            std::pop_heap(_nearestQueue.begin(), _nearestQueue.end(), isFarther);
+            const auto entry = _nearestQueue.back();
+            _nearestQueue.pop_back();
+
+            if (entry.squareDistance > maxSquareDistance)
+            {
+                break;
+            }
 
-                if (childNodePossible == 1)
+            const auto& node = *entry.node;
+            for (auto i = node.colliderBegin; i < node.colliderBegin + node.colliderCount; i++)
+            {
+                const auto& col = colliders[i];
+                if (SquareDistanceAABB(col.aabb, point) <= maxSquareDistance)
                 {
-                    childNode->colliders.push_back(col);
+                    maxSquareDistance = callback.OnNearestCandidate(queryIndex, col.colliderRef);
                 }
-                else
+            }
+
+            if (node.children[0] == nullptr)
+            {
+                continue;
+            }
+
+            for (const auto* child: node.children)
+            {
+                const float squareDistance = SquareDistanceAABB(LooseBounds(*child), point);
+                if (child->subtreeColliderCount != 0 && squareDistance <= maxSquareDistance)
                 {
-                    collidersStayInNodes.push_back(col);
+                    _nearestQueue.push_back(NearestEntry<const QuadNode*>{squareDistance, child});
+                    std::push_heap(_nearestQueue.begin(), _nearestQueue.end(), isFarther);
                 }
             }
+        }
+        return true;
+    }
+
+    void QuadTree::VisitNodes(BroadPhaseVisitor& visitor) const noexcept
+    {
+        visitNode(root, visitor);
+    }
+
+    std::size_t QuadTree::NodeCount() const noexcept
+    {
+        return 1 + 4 * (_usedNodeBlockCount - _freeNodeBlocks.size());
+    }
+
+    std::size_t QuadTree::AllocatedNodeCount() const noexcept
+    {
+        return 1 + _nodeChunks.size() * NodeChunkSize;
+    }
+
+    void QuadTree::Clear() noexcept
+    {
+        nodeColliderPairs.clear();
+        colliders.clear();
+
+        const auto resetNode = [](QuadNode& node)
+        {
+            std::fill(node.children.begin(), node.children.end(), nullptr);
+            node.parent = nullptr;
+            node.colliderBegin = 0;
+            node.colliderCount = 0;
+            node.subtreeColliderCount = 0;
+        };
+        resetNode(root);
+        root.bounds = Math::RectangleF(Math::Vec2F::Zero(), Math::Vec2F::Zero());
 
-            node.colliders.clear();
-            for (auto& colliders: collidersStayInNodes)
+        // Only the nodes handed out since the last Clear can hold data, the allocated chunks are kept for reuse.
+        constexpr std::size_t BlocksPerChunk = NodeChunkSize / 4;
+        for (std::size_t blockIndex = 0; blockIndex < _usedNodeBlockCount; blockIndex++)
+        {
+            auto* block = &_nodeChunks[blockIndex / BlocksPerChunk][(blockIndex % BlocksPerChunk) * 4];
+            for (std::size_t i = 0; i < 4; i++)
             {
-                node.colliders.push_back(colliders);
+                resetNode(block[i]);
             }
+        }
+        _usedNodeBlockCount = 0;
+        _freeNodeBlocks.clear();
+        _mergeCandidates.clear();
+        proxies.clear();
+        _isRootOutgrown = false;
+        _isTreeLoose = isLoose;
+    }
+
+    Math::RectangleF QuadTree::LooseBounds(const QuadNode& node) const noexcept
+    {
+        if (!_isTreeLoose || node.parent == nullptr)
+        {
+            return node.bounds;
+        }
+        return Math::RectangleF::FromCenter(node.bounds.Center(), node.bounds.Size() * (LooseFactor / 2));
+    }
+
+    QuadTree::~QuadTree() noexcept
+    {
+        stopWorkers();
+    }
+
+    void QuadTree::Init() noexcept
+    {
+        Clear();
+        startWorkers();
+        nodeColliderPairs.reserve(1024);
+        colliders.reserve(1024);
+        _partitionBuffer.reserve(1024);
+        _partitionBuckets.reserve(1024);
+        for (auto* packedBounds: {&_packedMinX, &_packedMinY, &_packedMaxX, &_packedMaxY})
+        {
+            packedBounds->reserve(1024 + OverlapBatchSize);
+        }
+        for (auto* packedFilterBits: {&_packedCategoryBits, &_packedMaskBits})
+        {
+            packedFilterBits->reserve(1024 + OverlapBatchSize);
+        }
+        _packedGroupIndices.reserve(1024 + OverlapBatchSize);
+        _packedColliderRefs.reserve(1024);
+        _packedSubtreeEnds.reserve(1024);
+        _packedNodes.reserve(1024);
+        _activeQueries.reserve(1024);
+        _activeChildMasks.reserve(1024);
+    }
 
-            for (const auto& child: node.children)
+    QuadNode* QuadTree::findContainingChild(const QuadNode& node, const Math::RectangleF& aabb) const noexcept
+    {
+        if (node.children[0] == nullptr)
+        {
+            return nullptr;
+        }
+
+        const auto containsMask = ContainsMask4(aabb, node.childMinX.data(), node.childMinY.data(),
+                                                node.childMaxX.data(), node.childMaxY.data());
+        if (!_isTreeLoose)
+        {
+            for (std::size_t i = 0; i < node.children.size(); i++)
             {
-                if (child->colliders.size() > MaxColliderInNode)
+                if ((containsMask >> i) & 1)
                 {
-                    SubdivideNodeRecursively(*child, depth + 1);
+                    return node.children[i];
                 }
             }
+            return nullptr;
         }
+
+        // The loose bounds of the children overlap, the child holding the center is the one whose bounds fit best.
+        const auto center = node.bounds.Center();
+        const auto aabbCenter = aabb.Center();
+        const auto childIndex = (aabbCenter.Y >= center.Y ? 0 : 2) + (aabbCenter.X >= center.X ? 1 : 0);
+        return (containsMask >> childIndex) & 1 ? node.children[childIndex] : nullptr;
     }
 
-    void QuadTree::FindPossiblePairs(QuadNode& node) noexcept
+    void QuadTree::addInNode(QuadNode& node, const SimplifedCollider& simplifedCollider) noexcept
+    {
+        proxies[simplifedCollider.colliderRef.index] = QuadProxy{&node, simplifedCollider};
+
+        for (QuadNode* ancestor = &node; ancestor != nullptr; ancestor = ancestor->parent)
+        {
+            ancestor->subtreeColliderCount++;
+        }
+    }
+
+    void QuadTree::removeFromNode(std::size_t colliderIndex) noexcept
+    {
+        auto& proxy = proxies[colliderIndex];
+        for (QuadNode* ancestor = proxy.node; ancestor != nullptr; ancestor = ancestor->parent)
+        {
+            ancestor->subtreeColliderCount--;
+            if (ancestor->children[0] != nullptr && ancestor->subtreeColliderCount == maxColliderInNode / 2)
+            {
+                _mergeCandidates.push_back(ancestor);
+            }
+        }
+
+        proxy = QuadProxy{};
+    }
+
+    void QuadTree::mergeChildren(QuadNode& node) noexcept
+    {
+        for (auto i = node.colliderBegin; i < node.colliderBegin + node.subtreeColliderCount; i++)
+        {
+            proxies[colliders[i].colliderRef.index].node = &node;
+        }
+        node.colliderCount = static_cast<std::uint32_t>(node.subtreeColliderCount);
+        releaseChildren(node);
+    }
+
+    void QuadTree::releaseChildren(QuadNode& node) noexcept
+    {
+        for (auto* child: node.children)
+        {
+            if (child->children[0] != nullptr)
+            {
+                releaseChildren(*child);
+            }
+            child->parent = nullptr;
+            child->colliderBegin = 0;
+            child->colliderCount = 0;
+            child->subtreeColliderCount = 0;
+        }
+        _freeNodeBlocks.push_back(node.children[0]);
+        std::fill(node.children.begin(), node.children.end(), nullptr);
+    }
+
+    QuadNode* QuadTree::allocateNodeBlock() noexcept
+    {
+        if (!_freeNodeBlocks.empty())
+        {
+            QuadNode* block = _freeNodeBlocks.back();
+            _freeNodeBlocks.pop_back();
+            return block;
+        }
+
+        // A chunk is never resized once filled, so the nodes already handed out keep their address.
+        constexpr std::size_t BlocksPerChunk = NodeChunkSize / 4;
+        if (_usedNodeBlockCount == _nodeChunks.size() * BlocksPerChunk)
+        {
+            auto& chunk = _nodeChunks.emplace_back(StandardAllocator < QuadNode > {heapAllocator});
+            chunk.reserve(NodeChunkSize);
+            for (std::size_t i = 0; i < NodeChunkSize; i++)
+            {
+                chunk.emplace_back();
+            }
+        }
+
+        const auto blockIndex = _usedNodeBlockCount++;
+        return &_nodeChunks[blockIndex / BlocksPerChunk][(blockIndex % BlocksPerChunk) * 4];
+    }
+
+    void QuadTree::rebuild() noexcept
     {
 #ifdef TRACY_ENABLE
         ZoneScoped;
 #endif
-        for (std::size_t i = 0; i < node.colliders.size(); i++)
+        // The partition buffer is only used while splitting, it holds the colliders while the tree is cleared.
+        _partitionBuffer.clear();
+        for (const auto& proxy: proxies)
         {
-            auto& colliderA = node.colliders[i];
+            if (proxy.node != nullptr)
+            {
+                _partitionBuffer.push_back(proxy.collider);
+            }
+        }
 
-            for (std::size_t j = i + 1; j < node.colliders.size(); j++)
+        Clear();
+        if (_partitionBuffer.empty())
+        {
+            return;
+        }
+
+        auto rootBounds = _partitionBuffer.front().aabb;
+        for (const auto& col: _partitionBuffer)
+        {
+            rootBounds = MergeAABB(rootBounds, col.aabb);
+        }
+
+        // Leave some room around the colliders so the root does not have to be refitted every step.
+        const auto slack = rootBounds.Size() / 4;
+        root.bounds = Math::RectangleF(rootBounds.MinBound() - slack, rootBounds.MaxBound() + slack);
+
+        // The root has no children yet, every collider goes in it and Rebalance splits it afterwards.
+        proxies.resize(_partitionBuffer.back().colliderRef.index + 1);
+        for (const auto& col: _partitionBuffer)
+        {
+            addInNode(root, col);
+        }
+    }
+
+    void QuadTree::layoutColliders() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        // Counting sort of the proxies by node: count, turn the counts into range ends, then fill the ranges backward.
+        resetColliderCounts(root);
+        for (const auto& proxy: proxies)
+        {
+            if (proxy.node != nullptr)
             {
-                auto& colliderB = node.colliders[j];
+                proxy.node->colliderCount++;
+            }
+        }
 
-                nodeColliderPairs.push_back(
-                        Engine::ColliderPair{colliderA.colliderRef, colliderB.colliderRef}); // now i et j
+        colliders.resize(assignColliderRanges(root, 0), QuadProxy{}.collider);
+        for (auto proxy = proxies.rbegin(); proxy != proxies.rend(); ++proxy)
+        {
+            if (proxy->node != nullptr)
+            {
+                colliders[--proxy->node->colliderBegin] = proxy->collider;
             }
+        }
+    }
 
-            if (node.children[0] != nullptr)
+    void QuadTree::resetColliderCounts(QuadNode& node) noexcept
+    {
+        node.colliderCount = 0;
+        if (node.children[0] != nullptr)
+        {
+            for (auto* child: node.children)
             {
-                for (const auto& child: node.children)
-                {
-                    FindInChildrenNodePossiblePairs(*child, colliderA.colliderRef);
-                }
+                resetColliderCounts(*child);
+            }
+        }
+    }
+
+    std::uint32_t QuadTree::assignColliderRanges(QuadNode& node, std::uint32_t offset) noexcept
+    {
+        // The begin is set past the range, filling the range backward brings it back to the first collider.
+        offset += node.colliderCount;
+        node.colliderBegin = offset;
+        if (node.children[0] != nullptr)
+        {
+            for (auto* child: node.children)
+            {
+                offset = assignColliderRanges(*child, offset);
             }
         }
+        return offset;
+    }
+
+    void QuadTree::splitOverflowingLeaves(QuadNode& node) noexcept
+    {
+        if (node.children[0] == nullptr)
+        {
+            SubdivideNodeRecursively(node);
+            return;
+        }
+
+        for (auto* child: node.children)
+        {
+            splitOverflowingLeaves(*child);
+        }
+    }
+
+    void QuadTree::packSubtree(const QuadNode& node) noexcept
+    {
+        const auto nodeBegin = _packedColliderRefs.size();
+        const auto packedNodeIndex = _packedNodes.size();
+        if (_isTreeLoose)
+        {
+            const auto colliderBegin = static_cast<std::uint32_t>(nodeBegin);
+            const auto colliderEnd = static_cast<std::uint32_t>(nodeBegin + node.colliderCount);
+            _packedNodes.push_back(PackedQuadNode{node.childMinX, node.childMinY, node.childMaxX, node.childMaxY,
+                                                  colliderBegin, colliderEnd, 0, 0});
+        }
+        for (auto i = node.colliderBegin; i < node.colliderBegin + node.colliderCount; i++)
+        {
+            const auto& col = colliders[i];
+            _packedMinX.push_back(col.aabb.MinBound().X);
+            _packedMinY.push_back(col.aabb.MinBound().Y);
+            _packedMaxX.push_back(col.aabb.MaxBound().X);
+            _packedMaxY.push_back(col.aabb.MaxBound().Y);
+            _packedCategoryBits.push_back(col.filter.categoryBits);
+            _packedMaskBits.push_back(col.filter.maskBits);
+            _packedGroupIndices.push_back(col.filter.groupIndex);
+            _packedColliderRefs.push_back(col.colliderRef);
+            _packedSubtreeEnds.push_back(0);
+        }
 
         if (node.children[0] != nullptr)
         {
-            for (const auto& child: node.children)
+            for (const auto* child: node.children)
             {
-                FindPossiblePairs(*child);
+                packSubtree(*child);
             }
         }
+
+        const auto subtreeEnd = static_cast<std::uint32_t>(_packedColliderRefs.size());
+        std::fill(_packedSubtreeEnds.begin() + nodeBegin, _packedSubtreeEnds.begin() + nodeBegin + node.colliderCount,
+                  subtreeEnd);
+        if (_isTreeLoose)
+        {
+            _packedNodes[packedNodeIndex].subtreeColliderEnd = subtreeEnd;
+            _packedNodes[packedNodeIndex].subtreeNodeEnd = static_cast<std::uint32_t>(_packedNodes.size());
+        }
     }
 
-    void QuadTree::FindInChildrenNodePossiblePairs(QuadNode& node, Engine::ColliderRef& colliderRef) noexcept
+    void QuadTree::findPackedPairs(std::uint32_t begin, std::uint32_t end, AllocatedVector <ColliderPair>& pairs,
+                                   PairCallback* callback) const noexcept
     {
 #ifdef TRACY_ENABLE
         ZoneScoped;
 #endif
-        for (auto& nodeCollider: node.colliders)
+        if (!_isTreeLoose)
         {
-            nodeColliderPairs.push_back(Engine::ColliderPair{colliderRef, nodeCollider.colliderRef});
+            for (std::uint32_t i = begin; i < end; i++)
+            {
+                addOverlappingPairs(i, i + 1, _packedSubtreeEnds[i], pairs, callback);
+            }
+            return;
         }
 
-        if (node.children[0] != nullptr)
+        for (std::uint32_t i = begin; i < end; i++)
         {
-            for (const auto& child: node.children)
+            const Math::RectangleF aabb(Math::Vec2F(_packedMinX[i], _packedMinY[i]),
+                                        Math::Vec2F(_packedMaxX[i], _packedMaxY[i]));
+            // The first node is not tested, the colliders of the root can reach outside its bounds.
+            findLoosePairs(i, aabb, 0, pairs, callback);
+        }
+    }
+
+    void QuadTree::findLoosePairs(std::uint32_t colliderIndex, const Math::RectangleF& aabb, std::uint32_t nodeIndex,
+                                  AllocatedVector <ColliderPair>& pairs, PairCallback* callback) const noexcept
+    {
+        const auto& packedNode = _packedNodes[nodeIndex];
+        addOverlappingPairs(colliderIndex, std::max(packedNode.colliderBegin, colliderIndex + 1),
+                            packedNode.colliderEnd, pairs, callback);
+
+        // The children are packed right after their parent, each one followed by its subtree.
+        if (packedNode.subtreeNodeEnd == nodeIndex + 1)
+        {
+            return;
+        }
+        const auto childMask = OverlapMask4(aabb, packedNode.childMinX.data(), packedNode.childMinY.data(),
+                                            packedNode.childMaxX.data(), packedNode.childMaxY.data());
+        auto childIndex = nodeIndex + 1;
+        for (std::size_t i = 0; i < ChildBatchSize; i++)
+        {
+            const auto& child = _packedNodes[childIndex];
+            if (((childMask >> i) & 1) && child.subtreeColliderEnd > colliderIndex + 1)
             {
-                FindInChildrenNodePossiblePairs(*child, colliderRef);
+                findLoosePairs(colliderIndex, aabb, childIndex, pairs, callback);
             }
+            childIndex = child.subtreeNodeEnd;
         }
     }
 
-    void QuadTree::Clear() noexcept
+    void QuadTree::queryNode(const QuadNode& node, const Math::RectangleF& aabb, std::size_t queryIndex,
+                             QueryCallback& callback) const noexcept
     {
-        nodeColliderPairs.clear();
-        for (auto& node: nodes)
+        for (auto i = node.colliderBegin; i < node.colliderBegin + node.colliderCount; i++)
         {
-            std::fill(node.children.begin(), node.children.end(), nullptr);
-            node.colliders.clear();
+            const auto& col = colliders[i];
+            if (Math::Intersect(col.aabb, aabb))
+            {
+                callback.OnColliderFound(queryIndex, col.colliderRef);
+            }
+        }
+
+        if (node.children[0] == nullptr)
+        {
+            return;
         }
-        nodeIndex = 1;
 
-        nodes[0].bounds.SetMinBound(Math::Vec2F(Metrics::WIDTH, Metrics::HEIGHT));
-        nodes[0].bounds.SetMaxBound(Math::Vec2F(0.0f, 0.0f));
+        const auto childMask = OverlapMask4(aabb, node.childMinX.data(), node.childMinY.data(), node.childMaxX.data(),
+                                            node.childMaxY.data());
+        for (std::size_t i = 0; i < node.children.size(); i++)
+        {
+            if (((childMask >> i) & 1) && node.children[i]->subtreeColliderCount != 0)
+            {
+                queryNode(*node.children[i], aabb, queryIndex, callback);
+            }
+        }
     }
 
-    void QuadTree::Init() noexcept
+    void QuadTree::queryNodeBatch(const QuadNode& node, std::size_t activeBegin, const Math::RectangleF* aabbs,
+                                  QueryCallback& callback) noexcept
+    {
+        // The queries reaching the node are at the end of _activeQueries, the children push their subset after them.
+        const auto activeEnd = _activeQueries.size();
+        for (auto colliderIndex = node.colliderBegin; colliderIndex < node.colliderBegin + node.colliderCount;
+             colliderIndex++)
+        {
+            const auto& col = colliders[colliderIndex];
+            for (auto i = activeBegin; i < activeEnd; i++)
+            {
+                if (Math::Intersect(col.aabb, aabbs[_activeQueries[i]]))
+                {
+                    callback.OnColliderFound(_activeQueries[i], col.colliderRef);
+                }
+            }
+        }
+
+        if (node.children[0] == nullptr)
+        {
+            return;
+        }
+
+        // Each query is classified against the four children once, its mask sits next to it in _activeChildMasks.
+        _activeChildMasks.resize(activeEnd);
+        for (auto i = activeBegin; i < activeEnd; i++)
+        {
+            _activeChildMasks[i] = OverlapMask4(aabbs[_activeQueries[i]], node.childMinX.data(), node.childMinY.data(),
+                                                node.childMaxX.data(), node.childMaxY.data());
+        }
+
+        for (std::size_t childIndex = 0; childIndex < node.children.size(); childIndex++)
+        {
+            const auto* child = node.children[childIndex];
+            if (child->subtreeColliderCount == 0)
+            {
+                continue;
+            }
+
+            for (auto i = activeBegin; i < activeEnd; i++)
+            {
+                if ((_activeChildMasks[i] >> childIndex) & 1)
+                {
+                    _activeQueries.push_back(_activeQueries[i]);
+                }
+            }
+
+            if (_activeQueries.size() > activeEnd)
+            {
+                queryNodeBatch(*child, activeEnd, aabbs, callback);
+                _activeQueries.resize(activeEnd);
+            }
+        }
+    }
+
+    void QuadTree::visitNode(const QuadNode& node, BroadPhaseVisitor& visitor) const noexcept
     {
-        std::size_t maxChildrenPossible = 0;
-        for (int i = 0; i <= MaxDepth; i++)
+        visitor.OnNode(node.bounds, node.depth);
+        if (node.children[0] == nullptr)
         {
-            maxChildrenPossible += Math::Pow(4, i);
+            return;
         }
-        nodes.resize(maxChildrenPossible, QuadNode({heapAllocator}));
 
-        for (auto& node: nodes)
+        for (const auto* child: node.children)
         {
-            node.colliders.reserve(MaxColliderInNode);
+            visitNode(*child, visitor);
+        }
+    }
+
+    void QuadTree::rayCastNode(const QuadNode& node, std::uint32_t laneMask, RayPacket& packet,
+                               RayCastCallback& callback) const noexcept
+    {
+        for (auto i = node.colliderBegin; i < node.colliderBegin + node.colliderCount; i++)
+        {
+            const auto& col = colliders[i];
+            const auto colliderMask = RaySlabMask8(col.aabb, packet) & laneMask;
+            if (colliderMask != 0)
+            {
+                callback.OnRayCandidate(packet, colliderMask, col.colliderRef);
+            }
+        }
+
+        if (node.children[0] == nullptr)
+        {
+            return;
+        }
+
+        // The lanes that hit a collider of this node have a lower maxFraction when the children are tested.
+        for (const auto* child: node.children)
+        {
+            if (child->subtreeColliderCount == 0)
+            {
+                continue;
+            }
+
+            const auto childMask = RaySlabMask8(LooseBounds(*child), packet) & laneMask;
+            if (childMask != 0)
+            {
+                rayCastNode(*child, childMask, packet, callback);
+            }
+        }
+    }
+
+    void QuadTree::addOverlappingPairs(std::uint32_t colliderIndex, std::uint32_t begin, std::uint32_t end,
+                                       AllocatedVector <ColliderPair>& pairs, PairCallback* callback) const noexcept
+    {
+        const auto i = colliderIndex;
+        const Math::RectangleF aabb(Math::Vec2F(_packedMinX[i], _packedMinY[i]),
+                                    Math::Vec2F(_packedMaxX[i], _packedMaxY[i]));
+        const CollisionFilter filter{_packedCategoryBits[i], _packedMaskBits[i], _packedGroupIndices[i]};
+        for (std::uint32_t batchStart = begin; batchStart < end; batchStart += OverlapBatchSize)
+        {
+            auto mask = OverlapMask8(aabb, &_packedMinX[batchStart], &_packedMinY[batchStart],
+                                     &_packedMaxX[batchStart], &_packedMaxY[batchStart]);
+            const auto batchCount = end - batchStart;
+            if (batchCount < OverlapBatchSize)
+            {
+                mask &= (1u << batchCount) - 1;
+            }
+            if (mask != 0)
+            {
+                mask &= FilterMask8(filter, &_packedCategoryBits[batchStart], &_packedMaskBits[batchStart],
+                                    &_packedGroupIndices[batchStart]);
+            }
+
+            for (std::uint32_t j = batchStart; mask != 0; j++, mask >>= 1)
+            {
+                if (mask & 1)
+                {
+                    AddPair(pairs, ColliderPair{_packedColliderRefs[i], _packedColliderRefs[j]}, callback);
+                }
+            }
         }
-        nodeColliderPairs.reserve(maxChildrenPossible * 4);
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,294 @@
+#include "RayCast.h"
+#include "AABB.h"
+#include "Intrinsics.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine
+{
+    namespace
+    {
+        /**
+         * @brief The inverse used for a translation component of zero, the slab of that axis is then crossed at an
+         * infinite fraction or never, keeping the products finite.
+         */
+        constexpr float InfiniteInverse = 1e30f;
+
+#if !defined(__AVX__)
+        bool castCircleLane(const RayPacket& packet, std::size_t lane, Math::Vec2F center, float radius,
+                            float& fraction) noexcept
+        {
+            const float offsetX = packet.originX[lane] - center.X;
+            const float offsetY = packet.originY[lane] - center.Y;
+            const float translationX = packet.translationX[lane];
+            const float translationY = packet.translationY[lane];
+            const float castRadius = radius + packet.radius[lane];
+
+            const float a = translationX * translationX + translationY * translationY;
+            const float b = offsetX * translationX + offsetY * translationY;
+            const float c = offsetX * offsetX + offsetY * offsetY - castRadius * castRadius;
+            const float discriminant = b * b - a * c;
+            if (a <= 0.0f || c <= 0.0f || discriminant < 0.0f)
+            {
+                return false;
+            }
+
+            fraction = (-b - std::sqrt(discriminant)) / a;
+            return fraction >= 0.0f && fraction <= packet.maxFraction[lane];
+        }
+#endif
+    }
+
+    void RayPacket::Load(const Ray* rays, std::size_t firstRay, std::size_t rayCount) noexcept
+    {
+        firstRayIndex = firstRay;
+        laneMask = 0;
+        for (std::size_t lane = 0; lane < Size; lane++)
+        {
+            // The empty lanes hold a zero ray out of laneMask, so the SIMD tests never read garbage.
+            const Ray ray = firstRay + lane < rayCount ? rays[firstRay + lane] : Ray{};
+            laneMask |= static_cast<std::uint32_t>(firstRay + lane < rayCount) << lane;
+
+            originX[lane] = ray.origin.X;
+            originY[lane] = ray.origin.Y;
+            translationX[lane] = ray.translation.X;
+            translationY[lane] = ray.translation.Y;
+            inverseX[lane] = ray.translation.X != 0.0f ? 1.0f / ray.translation.X : InfiniteInverse;
+            inverseY[lane] = ray.translation.Y != 0.0f ? 1.0f / ray.translation.Y : InfiniteInverse;
+            radius[lane] = ray.radius;
+            maxFraction[lane] = 1.0f;
+        }
+    }
+
+    std::uint32_t RaySlabMask8(const Math::RectangleF& aabb, const RayPacket& packet) noexcept
+    {
+#if defined(__AVX__)
+        const __m256 radius = _mm256_loadu_ps(packet.radius.data());
+        const __m256 originX = _mm256_loadu_ps(packet.originX.data());
+        const __m256 originY = _mm256_loadu_ps(packet.originY.data());
+        const __m256 inverseX = _mm256_loadu_ps(packet.inverseX.data());
+        const __m256 inverseY = _mm256_loadu_ps(packet.inverseY.data());
+
+        const __m256 slabMinX = _mm256_mul_ps(
+                _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(aabb.MinBound().X), radius), originX), inverseX);
+        const __m256 slabMaxX = _mm256_mul_ps(
+                _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(aabb.MaxBound().X), radius), originX), inverseX);
+        const __m256 slabMinY = _mm256_mul_ps(
+                _mm256_sub_ps(_mm256_sub_ps(_mm256_set1_ps(aabb.MinBound().Y), radius), originY), inverseY);
+        const __m256 slabMaxY = _mm256_mul_ps(
+                _mm256_sub_ps(_mm256_add_ps(_mm256_set1_ps(aabb.MaxBound().Y), radius), originY), inverseY);
+
+        const __m256 enter = _mm256_max_ps(_mm256_max_ps(_mm256_min_ps(slabMinX, slabMaxX),
+                                                         _mm256_min_ps(slabMinY, slabMaxY)), _mm256_setzero_ps());
+        const __m256 exit = _mm256_min_ps(_mm256_min_ps(_mm256_max_ps(slabMinX, slabMaxX),
+                                                        _mm256_max_ps(slabMinY, slabMaxY)),
+                                          _mm256_loadu_ps(packet.maxFraction.data()));
+        return static_cast<std::uint32_t>(_mm256_movemask_ps(_mm256_cmp_ps(enter, exit, _CMP_LE_OQ)));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t lane = 0; lane < RayPacket::Size; lane++)
+        {
+            const float radius = packet.radius[lane];
+            const float slabMinX = (aabb.MinBound().X - radius - packet.originX[lane]) * packet.inverseX[lane];
+            const float slabMaxX = (aabb.MaxBound().X + radius - packet.originX[lane]) * packet.inverseX[lane];
+            const float slabMinY = (aabb.MinBound().Y - radius - packet.originY[lane]) * packet.inverseY[lane];
+            const float slabMaxY = (aabb.MaxBound().Y + radius - packet.originY[lane]) * packet.inverseY[lane];
+
+            const float enter = std::max({std::min(slabMinX, slabMaxX), std::min(slabMinY, slabMaxY), 0.0f});
+            const float exit = std::min({std::max(slabMinX, slabMaxX), std::max(slabMinY, slabMaxY),
+                                         packet.maxFraction[lane]});
+            mask |= static_cast<std::uint32_t>(enter <= exit) << lane;
+        }
+        return mask;
+#endif
+    }
+
+#if defined(__AVX__)
+    namespace
+    {
+        /**
+         * @brief Casts the eight lanes against circles given per lane, the shared part of the circle and rectangle casts.
+         */
+        __m256 castCircles8(const RayPacket& packet, __m256 centerX, __m256 centerY, __m256 castRadius,
+                            __m256& fractions) noexcept
+        {
+            const __m256 offsetX = _mm256_sub_ps(_mm256_loadu_ps(packet.originX.data()), centerX);
+            const __m256 offsetY = _mm256_sub_ps(_mm256_loadu_ps(packet.originY.data()), centerY);
+            const __m256 translationX = _mm256_loadu_ps(packet.translationX.data());
+            const __m256 translationY = _mm256_loadu_ps(packet.translationY.data());
+
+            const __m256 a = _mm256_add_ps(_mm256_mul_ps(translationX, translationX),
+                                           _mm256_mul_ps(translationY, translationY));
+            const __m256 b = _mm256_add_ps(_mm256_mul_ps(offsetX, translationX), _mm256_mul_ps(offsetY, translationY));
+            const __m256 c = _mm256_sub_ps(_mm256_add_ps(_mm256_mul_ps(offsetX, offsetX), _mm256_mul_ps(offsetY, offsetY)),
+                                           _mm256_mul_ps(castRadius, castRadius));
+            const __m256 discriminant = _mm256_sub_ps(_mm256_mul_ps(b, b), _mm256_mul_ps(a, c));
+
+            // The lanes with a zero translation are masked out by a > 0, the clamped divisor keeps them finite.
+            const __m256 zero = _mm256_setzero_ps();
+            fractions = _mm256_div_ps(_mm256_sub_ps(_mm256_sub_ps(zero, b),
+                                                    _mm256_sqrt_ps(_mm256_max_ps(discriminant, zero))),
+                                      _mm256_max_ps(a, _mm256_set1_ps(1e-30f)));
+
+            __m256 hit = _mm256_and_ps(_mm256_cmp_ps(a, zero, _CMP_GT_OQ), _mm256_cmp_ps(c, zero, _CMP_GT_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(discriminant, zero, _CMP_GE_OQ));
+            hit = _mm256_and_ps(hit, _mm256_cmp_ps(fractions, zero, _CMP_GE_OQ));
+            return _mm256_and_ps(hit, _mm256_cmp_ps(fractions, _mm256_loadu_ps(packet.maxFraction.data()), _CMP_LE_OQ));
+        }
+    }
+#endif
+
+    std::uint32_t RayCastCircle8(const RayPacket& packet, Math::Vec2F center, float radius, float* fractions) noexcept
+    {
+#if defined(__AVX__)
+        __m256 circleFractions;
+        const __m256 hit = castCircles8(packet, _mm256_set1_ps(center.X), _mm256_set1_ps(center.Y),
+                                        _mm256_add_ps(_mm256_set1_ps(radius), _mm256_loadu_ps(packet.radius.data())),
+                                        circleFractions);
+        _mm256_storeu_ps(fractions, circleFractions);
+        return static_cast<std::uint32_t>(_mm256_movemask_ps(hit));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t lane = 0; lane < RayPacket::Size; lane++)
+        {
+            mask |= static_cast<std::uint32_t>(castCircleLane(packet, lane, center, radius, fractions[lane])) << lane;
+        }
+        return mask;
+#endif
+    }
+
+    std::uint32_t RayCastRectangle8(const RayPacket& packet, const Math::RectangleF& rectangle, float* fractions) noexcept
+    {
+        // The rectangle enlarged by the lane radius is crossed with the slab method. An entry point beyond the
+        // rectangle on both axes is in a rounded corner, the lane is then cast against the corner circle instead.
+#if defined(__AVX__)
+        const __m256 radius = _mm256_loadu_ps(packet.radius.data());
+        const __m256 originX = _mm256_loadu_ps(packet.originX.data());
+        const __m256 originY = _mm256_loadu_ps(packet.originY.data());
+        const __m256 inverseX = _mm256_loadu_ps(packet.inverseX.data());
+        const __m256 inverseY = _mm256_loadu_ps(packet.inverseY.data());
+        const __m256 minX = _mm256_set1_ps(rectangle.MinBound().X);
+        const __m256 minY = _mm256_set1_ps(rectangle.MinBound().Y);
+        const __m256 maxX = _mm256_set1_ps(rectangle.MaxBound().X);
+        const __m256 maxY = _mm256_set1_ps(rectangle.MaxBound().Y);
+
+        const __m256 slabMinX = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(minX, radius), originX), inverseX);
+        const __m256 slabMaxX = _mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(maxX, radius), originX), inverseX);
+        const __m256 slabMinY = _mm256_mul_ps(_mm256_sub_ps(_mm256_sub_ps(minY, radius), originY), inverseY);
+        const __m256 slabMaxY = _mm256_mul_ps(_mm256_sub_ps(_mm256_add_ps(maxY, radius), originY), inverseY);
+        const __m256 enter = _mm256_max_ps(_mm256_min_ps(slabMinX, slabMaxX), _mm256_min_ps(slabMinY, slabMaxY));
+        const __m256 exit = _mm256_min_ps(_mm256_max_ps(slabMinX, slabMaxX), _mm256_max_ps(slabMinY, slabMaxY));
+
+        __m256 slabHit = _mm256_and_ps(_mm256_cmp_ps(enter, _mm256_setzero_ps(), _CMP_GE_OQ),
+                                       _mm256_cmp_ps(enter, exit, _CMP_LE_OQ));
+        slabHit = _mm256_and_ps(slabHit, _mm256_cmp_ps(enter, _mm256_loadu_ps(packet.maxFraction.data()), _CMP_LE_OQ));
+
+        const __m256 enterX = _mm256_add_ps(originX, _mm256_mul_ps(enter, _mm256_loadu_ps(packet.translationX.data())));
+        const __m256 enterY = _mm256_add_ps(originY, _mm256_mul_ps(enter, _mm256_loadu_ps(packet.translationY.data())));
+        const __m256 isBeforeX = _mm256_cmp_ps(enterX, minX, _CMP_LT_OQ);
+        const __m256 isBeforeY = _mm256_cmp_ps(enterY, minY, _CMP_LT_OQ);
+        const __m256 isCorner = _mm256_and_ps(_mm256_or_ps(isBeforeX, _mm256_cmp_ps(enterX, maxX, _CMP_GT_OQ)),
+                                              _mm256_or_ps(isBeforeY, _mm256_cmp_ps(enterY, maxY, _CMP_GT_OQ)));
+
+        __m256 cornerFractions;
+        const __m256 cornerHit = castCircles8(packet, _mm256_blendv_ps(maxX, minX, isBeforeX),
+                                              _mm256_blendv_ps(maxY, minY, isBeforeY), radius, cornerFractions);
+
+        const __m256 hit = _mm256_blendv_ps(slabHit, _mm256_and_ps(slabHit, cornerHit), isCorner);
+        _mm256_storeu_ps(fractions, _mm256_blendv_ps(enter, cornerFractions, isCorner));
+        return static_cast<std::uint32_t>(_mm256_movemask_ps(hit));
+#else
+        std::uint32_t mask = 0;
+        for (std::size_t lane = 0; lane < RayPacket::Size; lane++)
+        {
+            const float radius = packet.radius[lane];
+            const float originX = packet.originX[lane];
+            const float originY = packet.originY[lane];
+            const float slabMinX = (rectangle.MinBound().X - radius - originX) * packet.inverseX[lane];
+            const float slabMaxX = (rectangle.MaxBound().X + radius - originX) * packet.inverseX[lane];
+            const float slabMinY = (rectangle.MinBound().Y - radius - originY) * packet.inverseY[lane];
+            const float slabMaxY = (rectangle.MaxBound().Y + radius - originY) * packet.inverseY[lane];
+            const float enter = std::max(std::min(slabMinX, slabMaxX), std::min(slabMinY, slabMaxY));
+            const float exit = std::min(std::max(slabMinX, slabMaxX), std::max(slabMinY, slabMaxY));
+            if (enter < 0.0f || enter > exit || enter > packet.maxFraction[lane])
+            {
+                continue;
+            }
+
+            const float enterX = originX + enter * packet.translationX[lane];
+            const float enterY = originY + enter * packet.translationY[lane];
+            const bool isBeforeX = enterX < rectangle.MinBound().X;
+            const bool isBeforeY = enterY < rectangle.MinBound().Y;
+            const bool isCorner = (isBeforeX || enterX > rectangle.MaxBound().X) &&
+                                  (isBeforeY || enterY > rectangle.MaxBound().Y);
+            if (!isCorner)
+            {
+                fractions[lane] = enter;
+                mask |= 1u << lane;
+                continue;
+            }
+
+            const Math::Vec2F corner(isBeforeX ? rectangle.MinBound().X : rectangle.MaxBound().X,
+                                     isBeforeY ? rectangle.MinBound().Y : rectangle.MaxBound().Y);
+            mask |= static_cast<std::uint32_t>(castCircleLane(packet, lane, corner, 0.0f, fractions[lane])) << lane;
+        }
+        return mask;
+#endif
+    }
+
+    RayCastHit CircleHit(const Ray& ray, Math::Vec2F center, float radius, float fraction) noexcept
+    {
+        const auto castCenter = ray.origin + ray.translation * fraction;
+        const auto offset = castCenter - center;
+
+        RayCastHit hit;
+        hit.normal = offset.SquareLength() > 0.0f ? offset.Normalized() : (ray.translation * -1.0f).Normalized();
+        hit.point = center + hit.normal * radius;
+        hit.fraction = fraction;
+        hit.hasHit = true;
+        return hit;
+    }
+
+    RayCastHit RectangleHit(const Ray& ray, const Math::RectangleF& rectangle, float fraction) noexcept
+    {
+        const auto castCenter = ray.origin + ray.translation * fraction;
+        const Math::Vec2F closestPoint(std::clamp(castCenter.X, rectangle.MinBound().X, rectangle.MaxBound().X),
+                                       std::clamp(castCenter.Y, rectangle.MinBound().Y, rectangle.MaxBound().Y));
+        const auto offset = castCenter - closestPoint;
+
+        RayCastHit hit;
+        hit.point = closestPoint;
+        hit.fraction = fraction;
+        hit.hasHit = true;
+
+        // A cast circle stops at a distance of its radius, a ray stops on the face and the face is the last slab entered.
+        if (ray.radius > 0.0f && offset.SquareLength() > 0.0f)
+        {
+            hit.normal = offset.Normalized();
+            return hit;
+        }
+
+        const auto slabEnter = [](float origin, float translation, float min, float max)
+        {
+            if (translation == 0.0f)
+            {
+                return -InfiniteInverse;
+            }
+            return std::min((min - origin) / translation, (max - origin) / translation);
+        };
+        const float enterX = slabEnter(ray.origin.X, ray.translation.X, rectangle.MinBound().X, rectangle.MaxBound().X);
+        const float enterY = slabEnter(ray.origin.Y, ray.translation.Y, rectangle.MinBound().Y, rectangle.MaxBound().Y);
+        hit.normal = enterX > enterY ? Math::Vec2F(ray.translation.X > 0.0f ? -1.0f : 1.0f, 0.0f)
+                                     : Math::Vec2F(0.0f, ray.translation.Y > 0.0f ? -1.0f : 1.0f);
+        return hit;
+    }
+
+    Math::RectangleF RayAABB(const Ray& ray) noexcept
+    {
+        const auto end = ray.origin + ray.translation;
+        return FattenAABB(Math::RectangleF(Math::Vec2F(std::min(ray.origin.X, end.X), std::min(ray.origin.Y, end.Y)),
+                                           Math::Vec2F(std::max(ray.origin.X, end.X), std::max(ray.origin.Y, end.Y))),
+                          ray.radius);
+    }
+}
@@ -0,0 +1,268 @@
+#include "SpatialHashGrid.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace Engine
+{
+    void SpatialHashGrid::Init() noexcept
+    {
+        Clear();
+        proxies.reserve(1024);
+        entries.reserve(4096);
+        bucketStarts.reserve(8193);
+        colliderPairs.reserve(1024);
+        _colliderSizes.reserve(1024);
+        _activeColliders.reserve(1024);
+    }
+
+    void SpatialHashGrid::UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept
+    {
+        const auto colliderIndex = simplifedCollider.colliderRef.index;
+        if (colliderIndex >= proxies.size())
+        {
+            proxies.resize(colliderIndex + 1);
+        }
+
+        proxies[colliderIndex].simplifedCollider = simplifedCollider;
+        proxies[colliderIndex].isActive = true;
+    }
+
+    void SpatialHashGrid::RemoveCollider(std::size_t colliderIndex) noexcept
+    {
+        if (colliderIndex < proxies.size())
+        {
+            proxies[colliderIndex].isActive = false;
+        }
+    }
+
+    void SpatialHashGrid::FindPossiblePairs(PairCallback& callback) noexcept
+    {
+        _pairCallback = &callback;
+        FindPossiblePairs();
+        FlushPairs(colliderPairs, _pairCallback);
+        _pairCallback = nullptr;
+    }
+
+    const AllocatedVector<ColliderPair>& SpatialHashGrid::ColliderPairs() const noexcept
+    {
+        return colliderPairs;
+    }
+
+    void SpatialHashGrid::FindPossiblePairs() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        colliderPairs.clear();
+        entries.clear();
+        bucketStarts.clear();
+
+        _activeColliders.clear();
+        for (std::size_t i = 0; i < proxies.size(); i++)
+        {
+            if (proxies[i].isActive)
+            {
+                _activeColliders.push_back(static_cast<std::uint32_t>(i));
+            }
+        }
+        if (_activeColliders.empty())
+        {
+            return;
+        }
+
+        computeCellSize();
+
+        std::size_t entryCount = 0;
+        for (const auto colliderIndex: _activeColliders)
+        {
+            const auto& aabb = proxies[colliderIndex].simplifedCollider.aabb;
+            const auto cellCountX = cellCoordinate(aabb.MaxBound().X) - cellCoordinate(aabb.MinBound().X) + 1;
+            const auto cellCountY = cellCoordinate(aabb.MaxBound().Y) - cellCoordinate(aabb.MinBound().Y) + 1;
+            entryCount += static_cast<std::size_t>(cellCountX) * static_cast<std::size_t>(cellCountY);
+        }
+
+        // Twice as many buckets as entries keeps the hash collisions between distinct cells rare.
+        std::size_t bucketCount = 16;
+        while (bucketCount < 2 * entryCount)
+        {
+            bucketCount *= 2;
+        }
+        _bucketMask = static_cast<std::uint32_t>(bucketCount - 1);
+        bucketStarts.assign(bucketCount + 1, 0);
+        entries.resize(entryCount);
+
+        // Counting sort of the entries by bucket: count, then prefix sum to the bucket ends, then fill backwards.
+        for (const auto colliderIndex: _activeColliders)
+        {
+            const auto& aabb = proxies[colliderIndex].simplifedCollider.aabb;
+            const auto minCellX = cellCoordinate(aabb.MinBound().X), maxCellX = cellCoordinate(aabb.MaxBound().X);
+            const auto minCellY = cellCoordinate(aabb.MinBound().Y), maxCellY = cellCoordinate(aabb.MaxBound().Y);
+            for (auto cellY = minCellY; cellY <= maxCellY; cellY++)
+            {
+                for (auto cellX = minCellX; cellX <= maxCellX; cellX++)
+                {
+                    bucketStarts[bucketIndex(cellX, cellY)]++;
+                }
+            }
+        }
+
+        for (std::size_t i = 1; i < bucketCount; i++)
+        {
+            bucketStarts[i] += bucketStarts[i - 1];
+        }
+        bucketStarts[bucketCount] = static_cast<std::uint32_t>(entryCount);
+
+        for (const auto colliderIndex: _activeColliders)
+        {
+            const auto& aabb = proxies[colliderIndex].simplifedCollider.aabb;
+            const auto minCellX = cellCoordinate(aabb.MinBound().X), maxCellX = cellCoordinate(aabb.MaxBound().X);
+            const auto minCellY = cellCoordinate(aabb.MinBound().Y), maxCellY = cellCoordinate(aabb.MaxBound().Y);
+            for (auto cellY = minCellY; cellY <= maxCellY; cellY++)
+            {
+                for (auto cellX = minCellX; cellX <= maxCellX; cellX++)
+                {
+                    const auto bucket = bucketIndex(cellX, cellY);
+                    entries[--bucketStarts[bucket]] = GridEntry{cellX, cellY, colliderIndex};
+                }
+            }
+        }
+
+        for (std::size_t bucket = 0; bucket < bucketCount; bucket++)
+        {
+            const auto bucketEnd = bucketStarts[bucket + 1];
+            for (auto i = bucketStarts[bucket]; i < bucketEnd; i++)
+            {
+                const auto& entryA = entries[i];
+                const auto& colliderA = proxies[entryA.colliderIndex].simplifedCollider;
+                for (auto j = i + 1; j < bucketEnd; j++)
+                {
+                    const auto& entryB = entries[j];
+                    // Two different cells can share a bucket.
+                    if (entryA.cellX != entryB.cellX || entryA.cellY != entryB.cellY)
+                    {
+                        continue;
+                    }
+
+                    const auto& colliderB = proxies[entryB.colliderIndex].simplifedCollider;
+                    if (!Math::Intersect(colliderA.aabb, colliderB.aabb) || !ShouldCollide(colliderA.filter, colliderB.filter))
+                    {
+                        continue;
+                    }
+
+                    // Both colliders overlap the cell of the min corner of their intersection, only this cell reports them.
+                    const float intersectionMinX = std::max(colliderA.aabb.MinBound().X, colliderB.aabb.MinBound().X);
+                    const float intersectionMinY = std::max(colliderA.aabb.MinBound().Y, colliderB.aabb.MinBound().Y);
+                    if (cellCoordinate(intersectionMinX) != entryA.cellX || cellCoordinate(intersectionMinY) != entryA.cellY)
+                    {
+                        continue;
+                    }
+
+                    if (entryA.colliderIndex < entryB.colliderIndex)
+                    {
+                        AddPair(colliderPairs, ColliderPair{colliderA.colliderRef, colliderB.colliderRef},
+                                _pairCallback);
+                    }
+                    else
+                    {
+                        AddPair(colliderPairs, ColliderPair{colliderB.colliderRef, colliderA.colliderRef},
+                                _pairCallback);
+                    }
+                }
+            }
+        }
+    }
+
+    void SpatialHashGrid::QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex,
+                                    QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        if (bucketStarts.empty())
+        {
+            return;
+        }
+
+        const auto minCellX = cellCoordinate(aabb.MinBound().X), maxCellX = cellCoordinate(aabb.MaxBound().X);
+        const auto minCellY = cellCoordinate(aabb.MinBound().Y), maxCellY = cellCoordinate(aabb.MaxBound().Y);
+        const auto cellCount = static_cast<std::size_t>(maxCellX - minCellX + 1) *
+                               static_cast<std::size_t>(maxCellY - minCellY + 1);
+        if (cellCount > entries.size())
+        {
+            for (const auto& proxy: proxies)
+            {
+                if (proxy.isActive && Math::Intersect(proxy.simplifedCollider.aabb, aabb))
+                {
+                    callback.OnColliderFound(queryIndex, proxy.simplifedCollider.colliderRef);
+                }
+            }
+            return;
+        }
+
+        for (auto cellY = minCellY; cellY <= maxCellY; cellY++)
+        {
+            for (auto cellX = minCellX; cellX <= maxCellX; cellX++)
+            {
+                const auto bucket = bucketIndex(cellX, cellY);
+                for (auto i = bucketStarts[bucket]; i < bucketStarts[bucket + 1]; i++)
+                {
+                    const auto& entry = entries[i];
+                    const auto& proxy = proxies[entry.colliderIndex];
+                    if (entry.cellX != cellX || entry.cellY != cellY || !proxy.isActive ||
+                        !Math::Intersect(proxy.simplifedCollider.aabb, aabb))
+                    {
+                        continue;
+                    }
+
+                    // The collider is reported by the first cell both the query and the collider cover.
+                    const auto& colliderAabb = proxy.simplifedCollider.aabb;
+                    if (std::max(minCellX, cellCoordinate(colliderAabb.MinBound().X)) == cellX &&
+                        std::max(minCellY, cellCoordinate(colliderAabb.MinBound().Y)) == cellY)
+                    {
+                        callback.OnColliderFound(queryIndex, proxy.simplifedCollider.colliderRef);
+                    }
+                }
+            }
+        }
+    }
+
+    void SpatialHashGrid::Clear() noexcept
+    {
+        proxies.clear();
+        entries.clear();
+        bucketStarts.clear();
+        colliderPairs.clear();
+        _colliderSizes.clear();
+        _activeColliders.clear();
+        _bucketMask = 0;
+        cellSize = 1.0f;
+    }
+
+    void SpatialHashGrid::computeCellSize() noexcept
+    {
+        // A cell as large as most colliders keeps them in at most four cells, the few larger ones span more cells.
+        _colliderSizes.clear();
+        for (const auto colliderIndex: _activeColliders)
+        {
+            const auto size = proxies[colliderIndex].simplifedCollider.aabb.Size();
+            _colliderSizes.push_back(std::max(size.X, size.Y));
+        }
+
+        const auto percentileIndex = static_cast<std::size_t>(
+                CellSizePercentile * static_cast<float>(_colliderSizes.size() - 1));
+        std::nth_element(_colliderSizes.begin(), _colliderSizes.begin() + percentileIndex, _colliderSizes.end());
+        cellSize = std::max(_colliderSizes[percentileIndex], 1.0f);
+    }
+
+    std::int32_t SpatialHashGrid::cellCoordinate(float coordinate) const noexcept
+    {
+        return static_cast<std::int32_t>(std::floor(coordinate / cellSize));
+    }
+
+    std::uint32_t SpatialHashGrid::bucketIndex(std::int32_t cellX, std::int32_t cellY) const noexcept
+    {
+        const auto hash = static_cast<std::uint32_t>(cellX) * 73856093u ^ static_cast<std::uint32_t>(cellY) * 19349663u;
+        return hash & _bucketMask;
+    }
+}
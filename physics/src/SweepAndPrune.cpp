@@ -0,0 +1,249 @@
+#include "SweepAndPrune.h"
+
+#include <algorithm>
+
+namespace Engine
+{
+    static bool EndpointLess(const SweepEndpoint& endpointA, const SweepEndpoint& endpointB) noexcept
+    {
+        // Min endpoints come first on equal values so that touching intervals are reported, like Math::Intersect.
+        return endpointA.value < endpointB.value ||
+               (endpointA.value == endpointB.value && endpointA.isMax < endpointB.isMax);
+    }
+
+    void SweepAndPrune::Init() noexcept
+    {
+        Clear();
+        proxies.reserve(1024);
+        endpointsX.reserve(2048);
+        endpointsY.reserve(2048);
+        colliderPairs.reserve(1024);
+        _activeColliders.reserve(256);
+    }
+
+    void SweepAndPrune::UpdateCollider(const SimplifedCollider& simplifedCollider) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        const auto colliderIndex = simplifedCollider.colliderRef.index;
+        if (colliderIndex >= proxies.size())
+        {
+            proxies.resize(colliderIndex + 1);
+        }
+
+        auto& proxy = proxies[colliderIndex];
+        proxy.simplifedCollider = simplifedCollider;
+        proxy.isActive = true;
+        if (!proxy.hasEndpoints)
+        {
+            const auto index = static_cast<std::uint32_t>(colliderIndex);
+            endpointsX.push_back(SweepEndpoint{simplifedCollider.aabb.MinBound().X, index, 0});
+            endpointsX.push_back(SweepEndpoint{simplifedCollider.aabb.MaxBound().X, index, 1});
+            endpointsY.push_back(SweepEndpoint{simplifedCollider.aabb.MinBound().Y, index, 0});
+            endpointsY.push_back(SweepEndpoint{simplifedCollider.aabb.MaxBound().Y, index, 1});
+            proxy.hasEndpoints = true;
+            _addedCount++;
+        }
+    }
+
+    void SweepAndPrune::RemoveCollider(std::size_t colliderIndex) noexcept
+    {
+        if (colliderIndex >= proxies.size() || !proxies[colliderIndex].isActive)
+        {
+            return;
+        }
+
+        proxies[colliderIndex].isActive = false;
+        _hasRemovedColliders = true;
+    }
+
+    void SweepAndPrune::FindPossiblePairs(PairCallback& callback) noexcept
+    {
+        _pairCallback = &callback;
+        FindPossiblePairs();
+        FlushPairs(colliderPairs, _pairCallback);
+        _pairCallback = nullptr;
+    }
+
+    const AllocatedVector<ColliderPair>& SweepAndPrune::ColliderPairs() const noexcept
+    {
+        return colliderPairs;
+    }
+
+    void SweepAndPrune::FindPossiblePairs() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        colliderPairs.clear();
+
+        // Removing the endpoints keeps the relative order of the others, the arrays stay sorted.
+        if (_hasRemovedColliders)
+        {
+            const auto isRemoved = [this](const SweepEndpoint& endpoint)
+            {
+                return !proxies[endpoint.colliderIndex].isActive;
+            };
+            endpointsX.erase(std::remove_if(endpointsX.begin(), endpointsX.end(), isRemoved), endpointsX.end());
+            endpointsY.erase(std::remove_if(endpointsY.begin(), endpointsY.end(), isRemoved), endpointsY.end());
+            for (auto& proxy: proxies)
+            {
+                proxy.hasEndpoints = proxy.isActive;
+            }
+            _hasRemovedColliders = false;
+        }
+
+        if (endpointsX.empty())
+        {
+            _addedCount = 0;
+            return;
+        }
+
+        sortEndpoints(endpointsX, true);
+        sortEndpoints(endpointsY, false);
+        _addedCount = 0;
+
+        // Sweep the axis along which the colliders are the most spread to keep the open intervals list short.
+        float sumX = 0.0f, sumY = 0.0f, sumSquaredX = 0.0f, sumSquaredY = 0.0f;
+        std::size_t count = 0;
+        for (const auto& proxy: proxies)
+        {
+            if (!proxy.isActive)
+            {
+                continue;
+            }
+            const auto center = proxy.simplifedCollider.aabb.Center();
+            sumX += center.X;
+            sumY += center.Y;
+            sumSquaredX += center.X * center.X;
+            sumSquaredY += center.Y * center.Y;
+            count++;
+        }
+        const float varianceX = sumSquaredX - sumX * sumX / static_cast<float>(count);
+        const float varianceY = sumSquaredY - sumY * sumY / static_cast<float>(count);
+
+        if (varianceX >= varianceY)
+        {
+            sweep(endpointsX, true);
+        }
+        else
+        {
+            sweep(endpointsY, false);
+        }
+    }
+
+    void SweepAndPrune::QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex,
+                                  QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        for (const auto& endpoint: endpointsX)
+        {
+            if (endpoint.value > aabb.MaxBound().X)
+            {
+                break;
+            }
+
+            const auto& proxy = proxies[endpoint.colliderIndex];
+            if (!endpoint.isMax && proxy.isActive && Math::Intersect(proxy.simplifedCollider.aabb, aabb))
+            {
+                callback.OnColliderFound(queryIndex, proxy.simplifedCollider.colliderRef);
+            }
+        }
+    }
+
+    void SweepAndPrune::Clear() noexcept
+    {
+        proxies.clear();
+        endpointsX.clear();
+        endpointsY.clear();
+        colliderPairs.clear();
+        _activeColliders.clear();
+        _addedCount = 0;
+        _hasRemovedColliders = false;
+    }
+
+    void SweepAndPrune::sortEndpoints(AllocatedVector <SweepEndpoint>& endpoints, bool isAxisX) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        for (auto& endpoint: endpoints)
+        {
+            const auto& aabb = proxies[endpoint.colliderIndex].simplifedCollider.aabb;
+            const auto bound = endpoint.isMax ? aabb.MaxBound() : aabb.MinBound();
+            endpoint.value = isAxisX ? bound.X : bound.Y;
+        }
+
+        // The new colliders are appended unsorted at the end, too many of them would make the insertion sort quadratic.
+        if (_addedCount > FullSortThreshold)
+        {
+            std::sort(endpoints.begin(), endpoints.end(), EndpointLess);
+            return;
+        }
+
+        for (std::size_t i = 1; i < endpoints.size(); i++)
+        {
+            const auto endpoint = endpoints[i];
+            std::size_t j = i;
+            while (j > 0 && EndpointLess(endpoint, endpoints[j - 1]))
+            {
+                endpoints[j] = endpoints[j - 1];
+                j--;
+            }
+            endpoints[j] = endpoint;
+        }
+    }
+
+    void SweepAndPrune::sweep(const AllocatedVector <SweepEndpoint>& endpoints, bool isAxisX) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        _activeColliders.clear();
+        for (const auto& endpoint: endpoints)
+        {
+            auto& proxy = proxies[endpoint.colliderIndex];
+            if (endpoint.isMax)
+            {
+                const auto lastCollider = _activeColliders.back();
+                _activeColliders[proxy.activeIndex] = lastCollider;
+                proxies[lastCollider].activeIndex = proxy.activeIndex;
+                _activeColliders.pop_back();
+                continue;
+            }
+
+            // Every open interval overlaps the new one on the swept axis, only the other axis is left to check.
+            const auto& aabb = proxy.simplifedCollider.aabb;
+            const float minBound = isAxisX ? aabb.MinBound().Y : aabb.MinBound().X;
+            const float maxBound = isAxisX ? aabb.MaxBound().Y : aabb.MaxBound().X;
+            for (const auto activeCollider: _activeColliders)
+            {
+                const auto& otherCollider = proxies[activeCollider].simplifedCollider;
+                const float otherMinBound = isAxisX ? otherCollider.aabb.MinBound().Y : otherCollider.aabb.MinBound().X;
+                const float otherMaxBound = isAxisX ? otherCollider.aabb.MaxBound().Y : otherCollider.aabb.MaxBound().X;
+                if (maxBound < otherMinBound || minBound > otherMaxBound ||
+                    !ShouldCollide(proxy.simplifedCollider.filter, otherCollider.filter))
+                {
+                    continue;
+                }
+
+                if (activeCollider < endpoint.colliderIndex)
+                {
+                    AddPair(colliderPairs, ColliderPair{otherCollider.colliderRef, proxy.simplifedCollider.colliderRef},
+                            _pairCallback);
+                }
+                else
+                {
+                    AddPair(colliderPairs, ColliderPair{proxy.simplifedCollider.colliderRef, otherCollider.colliderRef},
+                            _pairCallback);
+                }
+            }
+
+            proxy.activeIndex = _activeColliders.size();
+            _activeColliders.push_back(endpoint.colliderIndex);
+        }
+    }
+}
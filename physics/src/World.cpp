@@ -1,8 +1,206 @@
 #include "World.h"
-#include "../../common/include/Metrics.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <limits>
 
 namespace Engine
 {
+    namespace
+    {
+        /**
+         * @brief Forwards to another callback the colliders found by a broad phase query that pass a filter.
+         */
+        template<typename Filter>
+        class FilteredQueryCallback final : public QueryCallback
+        {
+        public:
+            FilteredQueryCallback(const Filter& filter, QueryCallback& callback) noexcept:
+                    _filter(filter), _callback(callback)
+            {}
+
+            void OnColliderFound(std::size_t queryIndex, ColliderRef colliderRef) noexcept override
+            {
+                if (_filter(queryIndex, colliderRef))
+                {
+                    _callback.OnColliderFound(queryIndex, colliderRef);
+                }
+            }
+
+        private:
+            const Filter& _filter;
+            QueryCallback& _callback;
+        };
+
+        /**
+         * @brief Writes the colliders found by a query in a caller buffer, counting the ones that do not fit.
+         */
+        class BufferQueryCallback final : public QueryCallback
+        {
+        public:
+            BufferQueryCallback(ColliderRef* colliderRefs, std::size_t capacity) noexcept:
+                    _colliderRefs(colliderRefs), _capacity(capacity)
+            {}
+
+            void OnColliderFound(std::size_t, ColliderRef colliderRef) noexcept override
+            {
+                if (count < _capacity)
+                {
+                    _colliderRefs[count] = colliderRef;
+                }
+                count++;
+            }
+
+            std::size_t count = 0;
+
+        private:
+            ColliderRef* _colliderRefs;
+            std::size_t _capacity;
+        };
+
+        /**
+         * @brief Forwards to a function the colliders a ray packet may hit.
+         */
+        template<typename Function>
+        class FunctionRayCastCallback final : public RayCastCallback
+        {
+        public:
+            explicit FunctionRayCastCallback(const Function& function) noexcept: _function(function)
+            {}
+
+            void OnRayCandidate(RayPacket& packet, std::uint32_t laneMask, ColliderRef colliderRef) noexcept override
+            {
+                _function(packet, laneMask, colliderRef);
+            }
+
+        private:
+            const Function& _function;
+        };
+
+        /**
+         * @brief Forwards to a function the chunks of pairs streamed by a broad phase.
+         */
+        template<typename Function>
+        class FunctionPairCallback final : public PairCallback
+        {
+        public:
+            explicit FunctionPairCallback(const Function& function) noexcept: _function(function)
+            {}
+
+            void OnPairs(const ColliderPair* pairs, std::size_t pairCount) noexcept override
+            {
+                _function(pairs, pairCount);
+            }
+
+        private:
+            const Function& _function;
+        };
+
+        /**
+         * @brief Packs the indices of a pair in one key, the smallest index first, so both orders give the same key.
+         */
+        std::uint64_t PairKey(const ColliderPair& pair) noexcept
+        {
+            const auto indexA = static_cast<std::uint64_t>(pair.colliderA.index);
+            const auto indexB = static_cast<std::uint64_t>(pair.colliderB.index);
+            return indexA < indexB ? indexA << 32 | indexB : indexB << 32 | indexA;
+        }
+
+        /**
+         * @brief Gives back the pair of a key, with the generation indices of the colliders it was built from.
+         */
+        ColliderPair PairFromKey(std::uint64_t key, const std::vector<std::size_t>& genIndices) noexcept
+        {
+            const auto indexA = static_cast<std::size_t>(key >> 32);
+            const auto indexB = static_cast<std::size_t>(key & 0xFFFFFFFFu);
+            return ColliderPair{ColliderRef{indexA, genIndices[indexA]}, ColliderRef{indexB, genIndices[indexB]}};
+        }
+
+        /**
+         * @brief Keeps the nearest colliders of a query in a max heap on the caller buffer, the farthest on top.
+         * \n Note : The distances are square distances until Finish.
+         */
+        template<typename SquareDistance>
+        class NearestHeapCallback final : public NearestCallback
+        {
+        public:
+            explicit NearestHeapCallback(const SquareDistance& squareDistance) noexcept: _squareDistance(squareDistance)
+            {}
+
+            void Reset(NearestCollider* nearest, std::size_t k) noexcept
+            {
+                _nearest = nearest;
+                _k = k;
+                count = 0;
+            }
+
+            float OnNearestCandidate(std::size_t queryIndex, ColliderRef colliderRef) noexcept override
+            {
+                float squareDistance;
+                if (!_squareDistance(queryIndex, colliderRef, squareDistance) ||
+                    (count == _k && squareDistance >= _nearest[0].distance))
+                {
+                    return MaxSquareDistance();
+                }
+
+                if (count == _k)
+                {
+                    std::pop_heap(_nearest, _nearest + count, isCloser);
+                    count--;
+                }
+                _nearest[count++] = NearestCollider{colliderRef, squareDistance};
+                std::push_heap(_nearest, _nearest + count, isCloser);
+                return MaxSquareDistance();
+            }
+
+            [[nodiscard]] float MaxSquareDistance() const noexcept
+            {
+                return count < _k ? std::numeric_limits<float>::max() : _nearest[0].distance;
+            }
+
+            std::size_t Finish() noexcept
+            {
+                std::sort_heap(_nearest, _nearest + count, isCloser);
+                for (std::size_t i = 0; i < count; i++)
+                {
+                    _nearest[i].distance = std::sqrt(_nearest[i].distance);
+                }
+                return count;
+            }
+
+            std::size_t count = 0;
+
+        private:
+            static bool isCloser(const NearestCollider& nearestA, const NearestCollider& nearestB) noexcept
+            {
+                return nearestA.distance < nearestB.distance;
+            }
+
+            const SquareDistance& _squareDistance;
+            NearestCollider* _nearest = nullptr;
+            std::size_t _k = 0;
+        };
+
+        /**
+         * @brief Gives the colliders found by an AABB query to a nearest neighbour callback.
+         */
+        class NearestQueryCallback final : public QueryCallback
+        {
+        public:
+            explicit NearestQueryCallback(NearestCallback& callback) noexcept: _callback(callback)
+            {}
+
+            void OnColliderFound(std::size_t queryIndex, ColliderRef colliderRef) noexcept override
+            {
+                _callback.OnNearestCandidate(queryIndex, colliderRef);
+            }
+
+        private:
+            NearestCallback& _callback;
+        };
+    }
+
     void World::Init() noexcept
     {
 #ifdef TRACY_ENABLE
@@ -14,6 +212,18 @@ namespace Engine
         _colliders.resize(initSizeForVector);
         _collidersGenIndices.resize(initSizeForVector, 0);
         tree.Init();
+        aabbTree.Init();
+        sweepAndPrune.Init();
+        spatialHashGrid.Init();
+        linearQuadTree.Init();
+        kdTree.Init();
+        referenceBroadPhase.Init();
+        staticTree.Init();
+        _dynamicColliders.reserve(initSizeForVector);
+        _staticPairs.reserve(initSizeForVector);
+        _queryAabbs.reserve(initSizeForVector);
+        _contacts.reserve(initSizeForVector);
+        _contactStates.reserve(initSizeForVector);
     }
 
     void World::Clear() noexcept
@@ -26,6 +236,25 @@ namespace Engine
         _colliders.clear();
         _collidersGenIndices.clear();
         _colliderPairs.clear();
+        tree.Clear();
+        aabbTree.Clear();
+        sweepAndPrune.Clear();
+        spatialHashGrid.Clear();
+        linearQuadTree.Clear();
+        kdTree.Clear();
+        if (_customBroadPhase != nullptr)
+        {
+            _customBroadPhase->Clear();
+        }
+        _activeBroadPhase = nullptr;
+        referenceBroadPhase.Clear();
+        missedPairs.clear();
+        duplicatePairs.clear();
+        staticTree.Clear();
+        _dynamicColliders.clear();
+        _staticPairs.clear();
+        _contacts.clear();
+        _contactStates.clear();
     }
 
     void World::Update(float deltaTime) noexcept
@@ -46,10 +275,12 @@ namespace Engine
 
         if (contactListener != nullptr)
         {
-            ResolveBroadPhase();
+            ResolveCollisions();
+        }
+        else
+        {
+            ResolveNarrowPhase();
         }
-
-        ResolveNarrowPhase();
     }
 
     BodyRef World::CreateBody() noexcept
@@ -145,120 +376,804 @@ namespace Engine
 #ifdef TRACY_ENABLE
         ZoneScoped;
 #endif
-        if (colliderA._shape == Math::ShapeType::Circle)
+        return IntersectTable[ShapePairIndex(colliderA._shape, colliderB._shape)](colliderA, colliderB);
+    }
+
+    void World::ResolveBroadPhase() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        updateBroadPhase();
+        auto& broadPhase = GetBroadPhase();
+        broadPhase.FindPossiblePairs();
+        if (isCheckingBroadPhase)
+        {
+            checkBroadPhase(broadPhase.ColliderPairs().data(), broadPhase.ColliderPairs().size());
+        }
+    }
+
+    void World::ResolveCollisions() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        updateBroadPhase();
+
+        // Each chunk is resolved as soon as it is full, while its pairs are still in cache.
+        _stepIndex++;
+        _contacts.clear();
+        _contactStates.clear();
+        _checkedPairs.clear();
+        const auto resolveChunk = [this](const ColliderPair* pairs, std::size_t pairCount)
         {
-            if (colliderB._shape == Math::ShapeType::Circle)
+            resolvePairs(pairs, pairCount);
+            if (isCheckingBroadPhase)
             {
-                return Math::Intersect(colliderA.circleShape, colliderB.circleShape);
+                _checkedPairs.insert(_checkedPairs.end(), pairs, pairs + pairCount);
             }
-            if (colliderB._shape == Math::ShapeType::Rectangle)
+        };
+        FunctionPairCallback pairCallback(resolveChunk);
+        GetBroadPhase().FindPossiblePairs(pairCallback);
+
+        resolvePairs(_staticPairs.data(), _staticPairs.size());
+        solveContacts();
+        resolveSeparatedPairs();
+
+        if (isCheckingBroadPhase)
+        {
+            checkBroadPhase(_checkedPairs.data(), _checkedPairs.size());
+        }
+    }
+
+    BroadPhase& World::GetBroadPhase() noexcept
+    {
+        if (_customBroadPhase != nullptr)
+        {
+            return *_customBroadPhase;
+        }
+
+        switch (broadPhaseType)
+        {
+            case BroadPhaseType::AABB_TREE:
+                return aabbTree;
+            case BroadPhaseType::SWEEP_AND_PRUNE:
+                return sweepAndPrune;
+            case BroadPhaseType::SPATIAL_HASH_GRID:
+                return spatialHashGrid;
+            case BroadPhaseType::LINEAR_QUAD_TREE:
+                return linearQuadTree;
+            case BroadPhaseType::KD_TREE:
+                return kdTree;
+            case BroadPhaseType::QUAD_TREE:
+            default:
+                return tree;
+        }
+    }
+
+    void World::SetBroadPhase(BroadPhase* broadPhase) noexcept
+    {
+        _customBroadPhase = broadPhase;
+    }
+
+    void World::updateBroadPhase() noexcept
+    {
+        // The structure left holds the colliders of its last step, it is emptied so it starts over if it comes back.
+        auto& broadPhase = GetBroadPhase();
+        if (_activeBroadPhase != &broadPhase)
+        {
+            if (_activeBroadPhase != nullptr)
             {
-                return Math::Intersect(colliderA.circleShape, colliderB.rectangleShape);
+                _activeBroadPhase->Clear();
             }
+            _activeBroadPhase = &broadPhase;
         }
-        else if (colliderA._shape == Math::ShapeType::Rectangle)
+
+        _dynamicColliders.clear();
+        for (std::size_t i = 0; i < _colliders.size(); i++)
         {
-            if (colliderB._shape == Math::ShapeType::Circle)
+            const auto& collider = _colliders[i];
+            if (!collider.IsValid() ||
+                (collider._shape != Math::ShapeType::Rectangle && collider._shape != Math::ShapeType::Circle))
+            {
+                staticTree.RemoveCollider(i);
+                broadPhase.RemoveCollider(i);
+                referenceBroadPhase.RemoveCollider(i);
+                continue;
+            }
+
+            const SimplifedCollider simplifedCollider{ColliderRef{i, _collidersGenIndices[i]}, colliderAabb(collider),
+                                                      collider.filter};
+            if (GetBody(collider.bodyRef).type == BodyType::STATIC)
             {
-                return Math::Intersect(colliderA.rectangleShape, colliderB.circleShape);
+                // The collider was dynamic until now, or it is a new collider.
+                if (!staticTree.HasCollider(i))
+                {
+                    broadPhase.RemoveCollider(i);
+                }
+                referenceBroadPhase.RemoveCollider(i);
+                staticTree.UpdateCollider(simplifedCollider);
+                continue;
             }
-            if (colliderB._shape == Math::ShapeType::Rectangle)
+
+            staticTree.RemoveCollider(i);
+            _dynamicColliders.push_back(simplifedCollider);
+            broadPhase.UpdateCollider(simplifedCollider);
+            if (isCheckingBroadPhase)
             {
-                return Math::Intersect(colliderA.rectangleShape, colliderB.rectangleShape);
+                referenceBroadPhase.UpdateCollider(simplifedCollider);
+            }
+        }
+        broadPhase.Rebalance();
+
+        // Only the non static colliders look for static colliders, the static colliders never query each other.
+        _staticPairs.clear();
+        for (std::size_t i = 0; i < _dynamicColliders.size(); i++)
+        {
+            const auto& simplifedCollider = _dynamicColliders[i];
+            _dynamicBounds = i == 0 ? simplifedCollider.aabb : MergeAABB(_dynamicBounds, simplifedCollider.aabb);
+            if (staticTree.root != AABBTree::NullNode)
+            {
+                staticTree.QueryPairs(simplifedCollider, _staticPairs);
             }
         }
-        return false;
     }
 
-    void World::ResolveBroadPhase() noexcept
+    void World::checkBroadPhase(const ColliderPair* pairs, std::size_t pairCount) noexcept
     {
 #ifdef TRACY_ENABLE
         ZoneScoped;
 #endif
-        tree.Clear();
-        for (std::size_t i = 0; i < _colliders.size(); i++)
+        referenceBroadPhase.FindPossiblePairs();
+
+        _checkedPairKeys.clear();
+        for (std::size_t i = 0; i < pairCount; i++)
+        {
+            _checkedPairKeys.push_back(PairKey(pairs[i]));
+        }
+        _referencePairKeys.clear();
+        for (const auto& pair: referenceBroadPhase.ColliderPairs())
+        {
+            _referencePairKeys.push_back(PairKey(pair));
+        }
+        std::sort(_checkedPairKeys.begin(), _checkedPairKeys.end());
+        std::sort(_referencePairKeys.begin(), _referencePairKeys.end());
+
+        // Both key lists are sorted, one merge finds the repeated keys and the reference keys never checked.
+        missedPairs.clear();
+        duplicatePairs.clear();
+        std::size_t checkedIndex = 0;
+        for (const auto referenceKey: _referencePairKeys)
+        {
+            while (checkedIndex < _checkedPairKeys.size() && _checkedPairKeys[checkedIndex] < referenceKey)
+            {
+                checkedIndex++;
+            }
+            if (checkedIndex == _checkedPairKeys.size() || _checkedPairKeys[checkedIndex] != referenceKey)
+            {
+                missedPairs.push_back(PairFromKey(referenceKey, _collidersGenIndices));
+            }
+        }
+        for (std::size_t i = 1; i < _checkedPairKeys.size(); i++)
         {
-            if (_colliders[i].IsValid())
+            if (_checkedPairKeys[i] == _checkedPairKeys[i - 1])
             {
-                if (_colliders[i]._shape == Math::ShapeType::Rectangle)
+                duplicatePairs.push_back(PairFromKey(_checkedPairKeys[i], _collidersGenIndices));
+            }
+        }
+    }
+
+    void World::ResolveNarrowPhase() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        _stepIndex++;
+        _contacts.clear();
+        _contactStates.clear();
+        const auto& pairs = GetBroadPhase().ColliderPairs();
+        resolvePairs(pairs.data(), pairs.size());
+        resolvePairs(_staticPairs.data(), _staticPairs.size());
+        solveContacts();
+        resolveSeparatedPairs();
+    }
+
+    void World::resolveSeparatedPairs() noexcept
+    {
+        // A colliding pair the broad phase stopped reporting has separated since its last step.
+        for (auto pairIterator = _colliderPairs.begin(); pairIterator != _colliderPairs.end();)
+        {
+            if (pairIterator->second.stepIndex != _stepIndex)
+            {
+                onPairSeparated(pairIterator->first);
+                pairIterator = _colliderPairs.erase(pairIterator);
+            }
+            else
+            {
+                ++pairIterator;
+            }
+        }
+    }
+
+    void World::resolvePairs(const ColliderPair* pairs, std::size_t pairCount) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        // The buckets and the manifolds of a chunk stay in cache until its pairs are resolved.
+        for (std::size_t chunkStart = 0; chunkStart < pairCount; chunkStart += PairChunkSize)
+        {
+            resolvePairChunk(pairs + chunkStart, std::min(PairChunkSize, pairCount - chunkStart));
+        }
+    }
+
+    void World::resolvePairChunk(const ColliderPair* pairs, std::size_t pairCount) noexcept
+    {
+        // The shapes do not move while the pairs are resolved, every manifold can be computed up front. The pairs are
+        // bucketed by shape pair with a counting sort, so each bucket is one loop over the same collide function.
+        _pairShapes.resize(pairCount);
+        _bucketStarts.fill(0);
+        for (std::size_t i = 0; i < pairCount; i++)
+        {
+            const auto& colliderA = GetCollider(pairs[i].colliderA);
+            const auto& colliderB = GetCollider(pairs[i].colliderB);
+            _pairShapes[i] = static_cast<std::uint8_t>(ShapePairIndex(colliderA._shape, colliderB._shape));
+            _bucketStarts[_pairShapes[i] + 1]++;
+        }
+        for (std::size_t shapePair = 0; shapePair < ShapePairCount; shapePair++)
+        {
+            _bucketStarts[shapePair + 1] += _bucketStarts[shapePair];
+        }
+        auto bucketEnds = _bucketStarts;
+        _bucketedPairs.resize(pairCount);
+        for (std::size_t i = 0; i < pairCount; i++)
+        {
+            _bucketedPairs[bucketEnds[_pairShapes[i]]++] = static_cast<std::uint32_t>(i);
+        }
+
+        _manifolds.resize(pairCount);
+        for (std::size_t shapePair = 0; shapePair < ShapePairCount; shapePair++)
+        {
+            const auto bucketStart = _bucketStarts[shapePair];
+            const auto bucketSize = _bucketStarts[shapePair + 1] - bucketStart;
+            if (bucketSize == 0)
+            {
+                continue;
+            }
+            if (shapePair == ShapePairIndex(Math::ShapeType::Circle, Math::ShapeType::Circle))
+            {
+                collideCircleBucket(pairs, &_bucketedPairs[bucketStart], bucketSize);
+                continue;
+            }
+            CollideBucketTable[shapePair](_colliders.data(), pairs, &_bucketedPairs[bucketStart], bucketSize,
+                                          _manifolds.data());
+        }
+
+        // The colliders were checked by the first pass, they are read directly.
+        for (std::size_t i = 0; i < pairCount; i++)
+        {
+            resolveManifold(pairs[i], _colliders[pairs[i].colliderA.index], _colliders[pairs[i].colliderB.index],
+                            _manifolds[i]);
+        }
+    }
+
+    void World::collideCircleBucket(const ColliderPair* pairs, const std::uint32_t* pairIndices,
+                                    std::size_t pairCount) noexcept
+    {
+        // CircleContacts8 always reads and writes a full batch.
+        for (auto* packed: {&_circleCenterAX, &_circleCenterAY, &_circleCenterBX, &_circleCenterBY, &_circleRadiusSums,
+                            &_circleNormalX, &_circleNormalY, &_circlePenetrations})
+        {
+            packed->resize(pairCount + ContactBatchSize, 0.0f);
+        }
+        for (std::size_t i = 0; i < pairCount; i++)
+        {
+            const auto& pair = pairs[pairIndices[i]];
+            const auto& circleA = _colliders[pair.colliderA.index].circleShape;
+            const auto& circleB = _colliders[pair.colliderB.index].circleShape;
+            _circleCenterAX[i] = circleA.Center().X;
+            _circleCenterAY[i] = circleA.Center().Y;
+            _circleCenterBX[i] = circleB.Center().X;
+            _circleCenterBY[i] = circleB.Center().Y;
+            _circleRadiusSums[i] = circleA.Radius() + circleB.Radius();
+        }
+
+        for (std::size_t batchStart = 0; batchStart < pairCount; batchStart += ContactBatchSize)
+        {
+            auto mask = CircleContacts8(&_circleCenterAX[batchStart], &_circleCenterAY[batchStart],
+                                        &_circleCenterBX[batchStart], &_circleCenterBY[batchStart],
+                                        &_circleRadiusSums[batchStart], &_circleNormalX[batchStart],
+                                        &_circleNormalY[batchStart], &_circlePenetrations[batchStart]);
+
+            // The same manifolds as CollideCircles, their contact point halfway between the two surfaces.
+            const auto batchEnd = std::min(batchStart + ContactBatchSize, pairCount);
+            for (std::size_t i = batchStart; i < batchEnd; i++, mask >>= 1)
+            {
+                auto& manifold = _manifolds[pairIndices[i]];
+                manifold = ContactManifold{};
+                if ((mask & 1u) == 0)
                 {
-                    tree.InsertInRootNode(
-                            SimplifedCollider{ColliderRef{i, _collidersGenIndices[i]}, _colliders[i].rectangleShape});
+                    continue;
                 }
-                else if (_colliders[i]._shape == Math::ShapeType::Circle)
+
+                const auto& circleB = _colliders[pairs[pairIndices[i]].colliderB.index].circleShape;
+                manifold.normal = Math::Vec2F(_circleNormalX[i], _circleNormalY[i]);
+                manifold.depth = _circlePenetrations[i];
+                manifold.points[0] = circleB.Center() + manifold.normal * (circleB.Radius() - manifold.depth * 0.5f);
+                manifold.pointCount = 1;
+            }
+        }
+    }
+
+    void World::resolveManifold(const ColliderPair& pair, Collider& colliderA, Collider& colliderB,
+                                const ContactManifold& manifold) noexcept
+    {
+        auto* pairState = updatePairState(pair, colliderA, colliderB, manifold.HasContact());
+        if (pairState == nullptr || colliderA.isTrigger || colliderB.isTrigger)
+        {
+            return;
+        }
+
+        Contact contact;
+        contact.collidingBodies[0] = CollidingBody{&GetBody(colliderA.bodyRef), &colliderA};
+        contact.collidingBodies[1] = CollidingBody{&GetBody(colliderB.bodyRef), &colliderB};
+        contact.Prepare(manifold);
+        _contacts.push_back(contact);
+        _contactStates.push_back(pairState);
+    }
+
+    ColliderPairState* World::updatePairState(const ColliderPair& pair, const Collider& colliderA,
+                                              const Collider& colliderB, bool isContact) noexcept
+    {
+        const auto pairIterator = _colliderPairs.find(pair);
+        if (!isContact)
+        {
+            if (pairIterator != _colliderPairs.end())
+            {
+                onPairSeparated(pair);
+                _colliderPairs.erase(pairIterator);
+            }
+            return nullptr;
+        }
+
+        // A collision is reported on every step the colliders touch, a trigger only on the step they start to.
+        if (!colliderA.isTrigger && !colliderB.isTrigger)
+        {
+            contactListener->OnCollisionEnter(colliderA, colliderB);
+        }
+        else if (pairIterator == _colliderPairs.end())
+        {
+            contactListener->OnTriggerEnter(colliderA, colliderB);
+        }
+
+        // A new pair has no impulse to warm start from.
+        if (pairIterator != _colliderPairs.end())
+        {
+            pairIterator->second.stepIndex = _stepIndex;
+            return &pairIterator->second;
+        }
+        return &_colliderPairs.emplace(pair, ColliderPairState{_stepIndex, 0.0f}).first->second;
+    }
+
+    void World::solveContacts() noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        // The states are nodes of _colliderPairs, they stay in place while other pairs are added or erased.
+        if (isWarmStarting)
+        {
+            for (std::size_t i = 0; i < _contacts.size(); i++)
+            {
+                _contacts[i].normalImpulse = _contactStates[i]->normalImpulse;
+                _contacts[i].WarmStart();
+            }
+        }
+
+        if (contactSolverType == ContactSolverType::WIDE)
+        {
+            solveContactsWide();
+        }
+        else
+        {
+            for (std::size_t iteration = 0; iteration < solverIterations; iteration++)
+            {
+                for (auto& contact: _contacts)
                 {
-                    const auto circleBodyPosition = GetBody(_colliders[i].bodyRef).Position();
-                    const auto circleRadius = _colliders[i].circleShape.Radius();
-                    const auto circleToAABB = Math::RectangleF(
-                            circleBodyPosition - Math::Vec2F(circleRadius, circleRadius),
-                            circleBodyPosition + Math::Vec2F(circleRadius, circleRadius));
-                    tree.InsertInRootNode(
-                            SimplifedCollider{ColliderRef{i, _collidersGenIndices[i]}, circleToAABB});
+                    contact.ResolveVelocity();
                 }
             }
         }
-        tree.SubdivideNodeRecursively(tree.nodes[0], 0);
+
+        for (std::size_t i = 0; i < _contacts.size(); i++)
+        {
+            _contactStates[i]->normalImpulse = _contacts[i].normalImpulse;
+            _contacts[i].ResolveInterpenetration();
+        }
     }
 
-    void World::ResolveNarrowPhase() noexcept
+    void World::solveContactsWide() noexcept
     {
 #ifdef TRACY_ENABLE
         ZoneScoped;
 #endif
-        tree.FindPossiblePairs(tree.nodes[0]);
-        for (auto& pair: tree.nodeColliderPairs)
+        const auto contactCount = _contacts.size();
+        const auto bodyIndex = [this](const Body* body)
         {
-            auto& colliderA = GetCollider(pair.colliderA);
-            auto& colliderB = GetCollider(pair.colliderB);
+            return static_cast<std::int32_t>(body - _bodies.data());
+        };
 
-            const auto pairIterator = _colliderPairs.find(pair);
-            if (pairIterator != _colliderPairs.end())
+        // A contact takes the first color none of its dynamic bodies has taken, a body without inverse mass can be
+        // shared by the contacts of a color since the solver never changes its velocity.
+        _bodyColors.assign(_bodies.size(), 0);
+        _contactColors.resize(contactCount);
+        _colorStarts.fill(0);
+        for (std::size_t i = 0; i < contactCount; i++)
+        {
+            const auto& contact = _contacts[i];
+            const auto indexA = bodyIndex(contact.collidingBodies[0].body);
+            const auto indexB = bodyIndex(contact.collidingBodies[1].body);
+            const bool isMovingA = contact.inverseMasses[0] > 0;
+            const bool isMovingB = contact.inverseMasses[1] > 0;
+            const auto takenColors = (isMovingA ? _bodyColors[indexA] : 0) | (isMovingB ? _bodyColors[indexB] : 0);
+
+            std::size_t color = 0;
+            while (color < ContactColorCount && (takenColors >> color & 1u) != 0)
+            {
+                color++;
+            }
+            if (color < ContactColorCount)
             {
-                if (IsContact(colliderA, colliderB))
+                const auto colorBit = std::uint64_t{1} << color;
+                if (isMovingA)
                 {
-                    if (!colliderA.isTrigger && !colliderB.isTrigger)
-                    {
-                        Contact contact;
-                        contact.collidingBodies[0] = CollidingBody{&GetBody(colliderA.bodyRef), &colliderA};
-                        contact.collidingBodies[1] = CollidingBody{&GetBody(colliderB.bodyRef), &colliderB};
-                        contact.Resolve();
-                        contactListener->OnCollisionEnter(colliderA, colliderB);
-                    }
+                    _bodyColors[indexA] |= colorBit;
                 }
-                else
+                if (isMovingB)
                 {
-                    if (colliderA.isTrigger || colliderB.isTrigger)
-                    {
-                        contactListener->OnTriggerExit(colliderA, colliderB);
-                    }
+                    _bodyColors[indexB] |= colorBit;
+                }
+            }
+            _contactColors[i] = static_cast<std::uint8_t>(color);
+            _colorStarts[color + 1]++;
+        }
 
-                    else
-                    {
-                        contactListener->OnCollisionExit(colliderA, colliderB);
-                    }
-                    _colliderPairs.erase(pairIterator);
+        // Each color is padded to whole batches, a contact that fits no color gets a batch of its own.
+        std::size_t rowCount = 0;
+        for (std::size_t color = 0; color <= ContactColorCount; color++)
+        {
+            const auto colorCount = _colorStarts[color + 1];
+            rowCount += color < ContactColorCount ?
+                        (colorCount + ContactBatchSize - 1) / ContactBatchSize * ContactBatchSize :
+                        colorCount * ContactBatchSize;
+            _colorStarts[color + 1] += _colorStarts[color];
+        }
+        _coloredContacts.resize(contactCount);
+        auto colorEnds = _colorStarts;
+        for (std::size_t i = 0; i < contactCount; i++)
+        {
+            _coloredContacts[colorEnds[_contactColors[i]]++] = static_cast<std::uint32_t>(i);
+        }
+
+        const auto paddingBody = static_cast<std::int32_t>(_bodies.size());
+        for (auto* row: {&_rowNormalX, &_rowNormalY, &_rowNormalMass, &_rowVelocityBias, &_rowInverseMassA,
+                         &_rowInverseMassB, &_rowNormalImpulse})
+        {
+            row->assign(rowCount, 0.0f);
+        }
+        _rowBodyA.assign(rowCount, paddingBody);
+        _rowBodyB.assign(rowCount, paddingBody);
+        _rowContacts.assign(rowCount, NoContactRow);
+
+        std::size_t row = 0;
+        for (std::size_t color = 0; color <= ContactColorCount; color++)
+        {
+            for (auto i = _colorStarts[color]; i < _colorStarts[color + 1]; i++)
+            {
+                const auto contactIndex = _coloredContacts[i];
+                const auto& contact = _contacts[contactIndex];
+                _rowNormalX[row] = contact.contactNormal.X;
+                _rowNormalY[row] = contact.contactNormal.Y;
+                _rowNormalMass[row] = contact.normalMass;
+                _rowVelocityBias[row] = contact.velocityBias;
+                _rowInverseMassA[row] = contact.inverseMasses[0];
+                _rowInverseMassB[row] = contact.inverseMasses[1];
+                _rowNormalImpulse[row] = contact.normalImpulse;
+                _rowBodyA[row] = bodyIndex(contact.collidingBodies[0].body);
+                _rowBodyB[row] = bodyIndex(contact.collidingBodies[1].body);
+                _rowContacts[row] = contactIndex;
+                row += color < ContactColorCount ? 1 : ContactBatchSize;
+            }
+            row = (row + ContactBatchSize - 1) / ContactBatchSize * ContactBatchSize;
+        }
+
+        _solverVelocityX.resize(_bodies.size() + 1);
+        _solverVelocityY.resize(_bodies.size() + 1);
+        for (std::size_t i = 0; i < _bodies.size(); i++)
+        {
+            _solverVelocityX[i] = _bodies[i].Velocity().X;
+            _solverVelocityY[i] = _bodies[i].Velocity().Y;
+        }
+        _solverVelocityX[paddingBody] = 0.0f;
+        _solverVelocityY[paddingBody] = 0.0f;
+
+        for (std::size_t iteration = 0; iteration < solverIterations; iteration++)
+        {
+            for (std::size_t batchStart = 0; batchStart < rowCount; batchStart += ContactBatchSize)
+            {
+                SolveContacts8(&_rowNormalX[batchStart], &_rowNormalY[batchStart], &_rowNormalMass[batchStart],
+                               &_rowVelocityBias[batchStart], &_rowInverseMassA[batchStart],
+                               &_rowInverseMassB[batchStart], &_rowBodyA[batchStart], &_rowBodyB[batchStart],
+                               _solverVelocityX.data(), _solverVelocityY.data(), &_rowNormalImpulse[batchStart]);
+            }
+        }
+
+        for (std::size_t i = 0; i < rowCount; i++)
+        {
+            if (_rowContacts[i] == NoContactRow)
+            {
+                continue;
+            }
+            auto& contact = _contacts[_rowContacts[i]];
+            contact.normalImpulse = _rowNormalImpulse[i];
+            for (std::size_t j = 0; j < contact.collidingBodies.size(); j++)
+            {
+                if (contact.inverseMasses[j] > 0)
+                {
+                    const auto index = j == 0 ? _rowBodyA[i] : _rowBodyB[i];
+                    contact.collidingBodies[j].body->SetVelocity(
+                            Math::Vec2F(_solverVelocityX[index], _solverVelocityY[index]));
+                }
+            }
+        }
+    }
+
+    void World::onPairSeparated(const ColliderPair& pair) noexcept
+    {
+        // One of the colliders was destroyed, there is no collider left to report.
+        if (_collidersGenIndices[pair.colliderA.index] != pair.colliderA.genIdx ||
+            _collidersGenIndices[pair.colliderB.index] != pair.colliderB.genIdx)
+        {
+            return;
+        }
+
+        const auto& colliderA = _colliders[pair.colliderA.index];
+        const auto& colliderB = _colliders[pair.colliderB.index];
+        if (colliderA.isTrigger || colliderB.isTrigger)
+        {
+            contactListener->OnTriggerExit(colliderA, colliderB);
+        }
+        else
+        {
+            contactListener->OnCollisionExit(colliderA, colliderB);
+        }
+    }
+
+    std::size_t World::QueryAABB(const Math::RectangleF& aabb, ColliderRef* colliderRefs, std::size_t capacity) noexcept
+    {
+        BufferQueryCallback bufferCallback(colliderRefs, capacity);
+        QueryAABBs(&aabb, 1, bufferCallback);
+        return bufferCallback.count;
+    }
+
+    void World::QueryAABB(const Math::RectangleF& aabb, QueryCallback& callback) noexcept
+    {
+        QueryAABBs(&aabb, 1, callback);
+    }
+
+    void World::QueryAABBs(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        // The structures store fat AABBs, the colliders are checked again with their tight AABB.
+        const auto overlapsQuery = [this, aabbs](std::size_t queryIndex, ColliderRef colliderRef)
+        {
+            return isColliderAlive(colliderRef) &&
+                   Math::Intersect(colliderAabb(_colliders[colliderRef.index]), aabbs[queryIndex]);
+        };
+        FilteredQueryCallback filteredCallback(overlapsQuery, callback);
+        queryBroadPhase(aabbs, queryCount, filteredCallback);
+    }
+
+    std::size_t World::QueryPoint(Math::Vec2F point, ColliderRef* colliderRefs, std::size_t capacity) noexcept
+    {
+        BufferQueryCallback bufferCallback(colliderRefs, capacity);
+        QueryPoints(&point, 1, bufferCallback);
+        return bufferCallback.count;
+    }
+
+    void World::QueryPoint(Math::Vec2F point, QueryCallback& callback) noexcept
+    {
+        QueryPoints(&point, 1, callback);
+    }
+
+    void World::QueryPoints(const Math::Vec2F* points, std::size_t queryCount, QueryCallback& callback) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        _queryAabbs.clear();
+        for (std::size_t i = 0; i < queryCount; i++)
+        {
+            _queryAabbs.emplace_back(points[i], points[i]);
+        }
+
+        const auto containsPoint = [this, points](std::size_t queryIndex, ColliderRef colliderRef)
+        {
+            if (!isColliderAlive(colliderRef))
+            {
+                return false;
+            }
+
+            const auto& collider = _colliders[colliderRef.index];
+            if (collider._shape == Math::ShapeType::Circle)
+            {
+                const Math::CircleF circle(GetBody(collider.bodyRef).Position(), collider.circleShape.Radius());
+                return circle.Contains(points[queryIndex]);
+            }
+            return collider.rectangleShape.Contains(points[queryIndex]);
+        };
+        FilteredQueryCallback filteredCallback(containsPoint, callback);
+        queryBroadPhase(_queryAabbs.data(), queryCount, filteredCallback);
+    }
+
+    RayCastHit World::RayCast(const Ray& ray) noexcept
+    {
+        RayCastHit hit;
+        RayCasts(&ray, 1, &hit);
+        return hit;
+    }
+
+    void World::RayCasts(const Ray* rays, std::size_t rayCount, RayCastHit* hits) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        std::fill(hits, hits + rayCount, RayCastHit{});
+
+        const auto castCollider = [this, rays, hits](RayPacket& packet, std::uint32_t laneMask, ColliderRef colliderRef)
+        {
+            if (!isColliderAlive(colliderRef))
+            {
+                return;
+            }
+
+            const auto& collider = _colliders[colliderRef.index];
+            const bool isCircle = collider._shape == Math::ShapeType::Circle;
+            const auto circleCenter = isCircle ? GetBody(collider.bodyRef).Position() : Math::Vec2F::Zero();
+            std::array<float, RayPacket::Size> fractions{};
+            auto hitMask = laneMask & (isCircle ?
+                                       RayCastCircle8(packet, circleCenter, collider.circleShape.Radius(), fractions.data()) :
+                                       RayCastRectangle8(packet, collider.rectangleShape, fractions.data()));
+
+            for (std::size_t lane = 0; hitMask != 0; lane++, hitMask >>= 1)
+            {
+                const auto rayIndex = packet.firstRayIndex + lane;
+                if (!(hitMask & 1) || (hits[rayIndex].hasHit && fractions[lane] >= hits[rayIndex].fraction))
+                {
+                    continue;
                 }
+
+                hits[rayIndex] = isCircle ?
+                                 CircleHit(rays[rayIndex], circleCenter, collider.circleShape.Radius(), fractions[lane]) :
+                                 RectangleHit(rays[rayIndex], collider.rectangleShape, fractions[lane]);
+                hits[rayIndex].colliderRef = colliderRef;
+                packet.maxFraction[lane] = fractions[lane];
+            }
+        };
+        FunctionRayCastCallback rayCastCallback(castCollider);
+
+        RayPacket packet;
+        for (std::size_t firstRay = 0; firstRay < rayCount; firstRay += RayPacket::Size)
+        {
+            packet.Load(rays, firstRay, rayCount);
+            rayCastBroadPhase(packet, rayCastCallback);
+        }
+    }
+
+    std::size_t World::QueryNearest(Math::Vec2F point, std::size_t k, NearestCollider* nearest) noexcept
+    {
+        std::size_t count = 0;
+        QueryNearests(&point, 1, k, nearest, &count);
+        return count;
+    }
+
+    void World::QueryNearests(const Math::Vec2F* points, std::size_t queryCount, std::size_t k, NearestCollider* nearest,
+                              std::size_t* counts) noexcept
+    {
+#ifdef TRACY_ENABLE
+        ZoneScoped;
+#endif
+        std::fill(counts, counts + queryCount, 0);
+        if (k == 0)
+        {
+            return;
+        }
+
+        const auto squareDistance = [this, points](std::size_t queryIndex, ColliderRef colliderRef, float& squareDistance)
+        {
+            if (!isColliderAlive(colliderRef))
+            {
+                return false;
+            }
+
+            const auto& collider = _colliders[colliderRef.index];
+            if (collider._shape == Math::ShapeType::Circle)
+            {
+                const auto offset = points[queryIndex] - GetBody(collider.bodyRef).Position();
+                const float distance = std::max(offset.Length() - collider.circleShape.Radius(), 0.0f);
+                squareDistance = distance * distance;
             }
             else
             {
-                if (IsContact(colliderA, colliderB))
+                squareDistance = SquareDistanceAABB(collider.rectangleShape, points[queryIndex]);
+            }
+            return true;
+        };
+        NearestHeapCallback nearestCallback(squareDistance);
+        NearestQueryCallback boxCallback(nearestCallback);
+
+        for (std::size_t queryIndex = 0; queryIndex < queryCount; queryIndex++)
+        {
+            const auto point = points[queryIndex];
+            nearestCallback.Reset(nearest + queryIndex * k, k);
+            auto& broadPhase = GetBroadPhase();
+            if (!broadPhase.QueryNearest(point, queryIndex, nearestCallback.MaxSquareDistance(), nearestCallback) &&
+                !_dynamicColliders.empty())
+            {
+                // Without a nearest query, the box around the point grows until it holds k colliders closer than its
+                // half size, a collider outside a box is farther than its half size. The first box is sized to hold
+                // about k colliders if they were spread evenly.
+                const auto boundsSize = _dynamicBounds.Size();
+                float halfSize = std::max(std::max(boundsSize.X, boundsSize.Y) *
+                                          std::sqrt(static_cast<float>(k) / static_cast<float>(_dynamicColliders.size())),
+                                          1.0f);
+                while (true)
                 {
-                    if (!colliderA.isTrigger && !colliderB.isTrigger)
-                    {
-                        Contact contact;
-                        contact.collidingBodies[0] = {&GetBody(colliderA.bodyRef), &colliderA};
-                        contact.collidingBodies[1] = {&GetBody(colliderB.bodyRef), &colliderB};
-                        contact.Resolve();
-                        contactListener->OnCollisionEnter(colliderA, colliderB);
-                    }
-                    else
+                    nearestCallback.Reset(nearest + queryIndex * k, k);
+                    const auto box = Math::RectangleF::FromCenter(point, Math::Vec2F(halfSize, halfSize));
+                    broadPhase.QueryAABB(box, queryIndex, boxCallback);
+                    if (nearestCallback.MaxSquareDistance() <= halfSize * halfSize || ContainsAABB(box, _dynamicBounds))
                     {
-                        contactListener->OnTriggerEnter(colliderA, colliderB);
+                        break;
                     }
-                    _colliderPairs.insert(pair);
+                    halfSize *= 2.0f;
                 }
             }
+            staticTree.QueryNearest(point, queryIndex, nearestCallback.MaxSquareDistance(), nearestCallback);
+            counts[queryIndex] = nearestCallback.Finish();
+        }
+    }
+
+    Math::RectangleF World::colliderAabb(const Collider& collider)
+    {
+        if (collider._shape == Math::ShapeType::Circle)
+        {
+            const auto circleBodyPosition = GetBody(collider.bodyRef).Position();
+            const auto circleRadius = collider.circleShape.Radius();
+            return Math::RectangleF(circleBodyPosition - Math::Vec2F(circleRadius, circleRadius),
+                                    circleBodyPosition + Math::Vec2F(circleRadius, circleRadius));
         }
+        return collider.rectangleShape;
+    }
+
+    bool World::isColliderAlive(ColliderRef colliderRef) const noexcept
+    {
+        return colliderRef.index < _colliders.size() && _collidersGenIndices[colliderRef.index] == colliderRef.genIdx &&
+               _colliders[colliderRef.index].IsValid();
+    }
+
+    void World::queryBroadPhase(const Math::RectangleF* aabbs, std::size_t queryCount, QueryCallback& callback) noexcept
+    {
+        GetBroadPhase().QueryAABBs(aabbs, queryCount, callback);
+        staticTree.QueryAABBs(aabbs, queryCount, callback);
+    }
+
+    void World::rayCastBroadPhase(RayPacket& packet, RayCastCallback& callback) noexcept
+    {
+        GetBroadPhase().RayCastPacket(packet, callback);
+        staticTree.RayCastPacket(packet, callback);
     }
 
     const std::size_t World::GetInitSizeForVector() noexcept
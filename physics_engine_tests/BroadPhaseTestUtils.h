@@ -0,0 +1,46 @@
+#pragma once
+
+#include "BroadPhase.h"
+#include "Collider.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <vector>
+
+/**
+ * @brief Creates the simplified collider of index index, with generation 0, whose AABB is centered on center.
+ */
+inline Engine::SimplifedCollider CreateSimplifiedCollider(std::size_t index, Math::Vec2F center, Math::Vec2F halfSize)
+{
+    return Engine::SimplifedCollider{Engine::ColliderRef{index, 0}, Math::RectangleF::FromCenter(center, halfSize)};
+}
+
+/**
+ * @brief Creates a simplified collider like above, with a square AABB.
+ */
+inline Engine::SimplifedCollider CreateSimplifiedCollider(std::size_t index, Math::Vec2F center, float halfSize)
+{
+    return CreateSimplifiedCollider(index, center, Math::Vec2F(halfSize, halfSize));
+}
+
+/**
+ * @brief Checks the pairs of the last FindPossiblePairs of a broad phase against a brute force test of every pair:
+ * each overlapping pair must be reported exactly once, and no other pair.
+ */
+inline void CheckPairsMatchOverlaps(const Engine::BroadPhase& broadPhase,
+                                    const std::vector<Engine::SimplifedCollider>& colliders)
+{
+    const auto& colliderPairs = broadPhase.ColliderPairs();
+    std::size_t overlapCount = 0;
+    for (std::size_t i = 0; i < colliders.size(); i++)
+    {
+        for (std::size_t j = i + 1; j < colliders.size(); j++)
+        {
+            const Engine::ColliderPair pair{colliders[i].colliderRef, colliders[j].colliderRef};
+            const auto pairCount = std::count(colliderPairs.begin(), colliderPairs.end(), pair);
+            const bool isOverlapping = Math::Intersect(colliders[i].aabb, colliders[j].aabb);
+            EXPECT_EQ(pairCount, isOverlapping ? 1 : 0);
+            overlapCount += isOverlapping;
+        }
+    }
+    EXPECT_EQ(colliderPairs.size(), overlapCount);
+}
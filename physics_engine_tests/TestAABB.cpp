@@ -0,0 +1,100 @@
+#include "AABB.h"
+#include "gtest/gtest.h"
+#include <array>
+
+TEST(AABB, ContainsAABB)
+{
+    const Math::RectangleF outer(Math::Vec2F(0.0f, 0.0f), Math::Vec2F(10.0f, 10.0f));
+    EXPECT_TRUE(Engine::ContainsAABB(outer, Math::RectangleF(Math::Vec2F(1.0f, 1.0f), Math::Vec2F(9.0f, 9.0f))));
+    EXPECT_TRUE(Engine::ContainsAABB(outer, outer));
+    EXPECT_FALSE(Engine::ContainsAABB(outer, Math::RectangleF(Math::Vec2F(5.0f, 5.0f), Math::Vec2F(11.0f, 9.0f))));
+}
+
+TEST(AABB, MergeAndFattenAABB)
+{
+    const Math::RectangleF aabbA(Math::Vec2F(0.0f, 0.0f), Math::Vec2F(2.0f, 2.0f));
+    const Math::RectangleF aabbB(Math::Vec2F(-1.0f, 1.0f), Math::Vec2F(1.0f, 5.0f));
+
+    const auto merged = Engine::MergeAABB(aabbA, aabbB);
+    EXPECT_EQ(merged.MinBound(), Math::Vec2F(-1.0f, 0.0f));
+    EXPECT_EQ(merged.MaxBound(), Math::Vec2F(2.0f, 5.0f));
+
+    const auto fat = Engine::FattenAABB(aabbA, 1.0f);
+    EXPECT_EQ(fat.MinBound(), Math::Vec2F(-1.0f, -1.0f));
+    EXPECT_EQ(fat.MaxBound(), Math::Vec2F(3.0f, 3.0f));
+    EXPECT_FLOAT_EQ(Engine::PerimeterAABB(fat), 16.0f);
+}
+
+TEST(AABB, OverlapMask8MatchesIntersect)
+{
+    const Math::RectangleF aabb(Math::Vec2F(0.0f, 0.0f), Math::Vec2F(10.0f, 10.0f));
+
+    // Overlapping, touching on an edge, touching on a corner, and separated on each axis.
+    const std::array<Math::RectangleF, Engine::OverlapBatchSize> packedAabbs{
+            Math::RectangleF(Math::Vec2F(5.0f, 5.0f), Math::Vec2F(15.0f, 15.0f)),
+            Math::RectangleF(Math::Vec2F(10.0f, 2.0f), Math::Vec2F(12.0f, 4.0f)),
+            Math::RectangleF(Math::Vec2F(-5.0f, -5.0f), Math::Vec2F(0.0f, 0.0f)),
+            Math::RectangleF(Math::Vec2F(11.0f, 0.0f), Math::Vec2F(12.0f, 10.0f)),
+            Math::RectangleF(Math::Vec2F(0.0f, -3.0f), Math::Vec2F(10.0f, -1.0f)),
+            Math::RectangleF(Math::Vec2F(2.0f, 2.0f), Math::Vec2F(3.0f, 3.0f)),
+            Math::RectangleF(Math::Vec2F(-20.0f, -20.0f), Math::Vec2F(20.0f, 20.0f)),
+            Math::RectangleF(Math::Vec2F(-20.0f, 11.0f), Math::Vec2F(20.0f, 20.0f))
+    };
+
+    std::array<float, Engine::OverlapBatchSize> minX{}, minY{}, maxX{}, maxY{};
+    std::uint32_t expectedMask = 0;
+    for (std::size_t i = 0; i < Engine::OverlapBatchSize; i++)
+    {
+        minX[i] = packedAabbs[i].MinBound().X;
+        minY[i] = packedAabbs[i].MinBound().Y;
+        maxX[i] = packedAabbs[i].MaxBound().X;
+        maxY[i] = packedAabbs[i].MaxBound().Y;
+        expectedMask |= static_cast<std::uint32_t>(Math::Intersect(aabb, packedAabbs[i])) << i;
+    }
+
+    EXPECT_EQ(expectedMask, 0b01100111u);
+    EXPECT_EQ(Engine::OverlapMask8(aabb, minX.data(), minY.data(), maxX.data(), maxY.data()), expectedMask);
+}
+
+TEST(AABB, ChildMasksMatchIntersectAndContains)
+{
+    // The four quadrants of [0, 10] x [0, 10], as stored in a QuadNode.
+    const std::array<float, Engine::ChildBatchSize> minX{0.0f, 5.0f, 0.0f, 5.0f};
+    const std::array<float, Engine::ChildBatchSize> minY{5.0f, 5.0f, 0.0f, 0.0f};
+    const std::array<float, Engine::ChildBatchSize> maxX{5.0f, 10.0f, 5.0f, 10.0f};
+    const std::array<float, Engine::ChildBatchSize> maxY{10.0f, 10.0f, 5.0f, 5.0f};
+
+    const std::array<Math::RectangleF, 4> aabbs{
+            Math::RectangleF(Math::Vec2F(6.0f, 6.0f), Math::Vec2F(8.0f, 8.0f)),
+            Math::RectangleF(Math::Vec2F(4.0f, 1.0f), Math::Vec2F(6.0f, 2.0f)),
+            Math::RectangleF(Math::Vec2F(5.0f, 5.0f), Math::Vec2F(5.0f, 5.0f)),
+            Math::RectangleF(Math::Vec2F(11.0f, 1.0f), Math::Vec2F(12.0f, 2.0f))
+    };
+
+    for (const auto& aabb: aabbs)
+    {
+        std::uint32_t expectedOverlapMask = 0;
+        std::uint32_t expectedContainsMask = 0;
+        for (std::size_t i = 0; i < Engine::ChildBatchSize; i++)
+        {
+            const Math::RectangleF childAabb(Math::Vec2F(minX[i], minY[i]), Math::Vec2F(maxX[i], maxY[i]));
+            expectedOverlapMask |= static_cast<std::uint32_t>(Math::Intersect(aabb, childAabb)) << i;
+            expectedContainsMask |= static_cast<std::uint32_t>(Engine::ContainsAABB(childAabb, aabb)) << i;
+        }
+
+        EXPECT_EQ(Engine::OverlapMask4(aabb, minX.data(), minY.data(), maxX.data(), maxY.data()), expectedOverlapMask);
+        EXPECT_EQ(Engine::ContainsMask4(aabb, minX.data(), minY.data(), maxX.data(), maxY.data()), expectedContainsMask);
+    }
+
+    EXPECT_EQ(Engine::OverlapMask4(aabbs[1], minX.data(), minY.data(), maxX.data(), maxY.data()), 0b1100u);
+    EXPECT_EQ(Engine::ContainsMask4(aabbs[0], minX.data(), minY.data(), maxX.data(), maxY.data()), 0b0010u);
+    EXPECT_EQ(Engine::OverlapMask4(aabbs[2], minX.data(), minY.data(), maxX.data(), maxY.data()), 0b1111u);
+}
+
+TEST(AABB, SquareDistanceAABB)
+{
+    const Math::RectangleF aabb(Math::Vec2F(0.0f, 0.0f), Math::Vec2F(10.0f, 10.0f));
+    EXPECT_FLOAT_EQ(Engine::SquareDistanceAABB(aabb, Math::Vec2F(5.0f, 5.0f)), 0.0f);
+    EXPECT_FLOAT_EQ(Engine::SquareDistanceAABB(aabb, Math::Vec2F(-3.0f, 5.0f)), 9.0f);
+    EXPECT_FLOAT_EQ(Engine::SquareDistanceAABB(aabb, Math::Vec2F(13.0f, 14.0f)), 25.0f);
+}
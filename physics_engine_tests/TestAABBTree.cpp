@@ -0,0 +1,115 @@
+#include "AABBTree.h"
+#include "BroadPhaseTestUtils.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+static void CheckNode(const Engine::AABBTree& aabbTree, int nodeIndex)
+{
+    const auto& node = aabbTree.nodes[nodeIndex];
+    if (node.child1 == Engine::AABBTree::NullNode)
+    {
+        EXPECT_EQ(node.height, 0);
+        EXPECT_EQ(aabbTree.proxies[node.colliderRef.index], nodeIndex);
+        return;
+    }
+
+    const auto& child1 = aabbTree.nodes[node.child1];
+    const auto& child2 = aabbTree.nodes[node.child2];
+    EXPECT_EQ(child1.parent, nodeIndex);
+    EXPECT_EQ(child2.parent, nodeIndex);
+    EXPECT_EQ(node.height, 1 + std::max(child1.height, child2.height));
+    EXPECT_LE(std::abs(child1.height - child2.height), 1);
+    EXPECT_TRUE(Engine::ContainsAABB(node.aabb, child1.aabb));
+    EXPECT_TRUE(Engine::ContainsAABB(node.aabb, child2.aabb));
+
+    CheckNode(aabbTree, node.child1);
+    CheckNode(aabbTree, node.child2);
+}
+
+TEST(AABBTree, ConstructorDefault)
+{
+    Engine::AABBTree aabbTree;
+    EXPECT_EQ(aabbTree.root, Engine::AABBTree::NullNode);
+    EXPECT_EQ(aabbTree.Height(), 0);
+    EXPECT_TRUE(aabbTree.nodes.empty());
+}
+
+TEST(AABBTree, UpdateColliderBuildsBalancedTree)
+{
+    Engine::AABBTree aabbTree;
+    aabbTree.Init();
+    for (std::size_t i = 0; i < 256; i++)
+    {
+        aabbTree.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 3.0f, 0.0f), Math::Vec2F(1.0f, 1.0f)));
+    }
+
+    EXPECT_EQ(aabbTree.nodes[aabbTree.root].parent, Engine::AABBTree::NullNode);
+    EXPECT_LE(aabbTree.Height(), 16);
+    CheckNode(aabbTree, aabbTree.root);
+}
+
+TEST(AABBTree, UpdateColliderKeepsLeafInsideFatAABB)
+{
+    Engine::AABBTree aabbTree;
+    aabbTree.Init();
+    aabbTree.UpdateCollider(CreateSimplifiedCollider(0, Math::Vec2F(0.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)));
+    aabbTree.UpdateCollider(CreateSimplifiedCollider(1, Math::Vec2F(100.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)));
+
+    const auto fatAabb = aabbTree.nodes[aabbTree.proxies[0]].aabb;
+    aabbTree.UpdateCollider(CreateSimplifiedCollider(0, Math::Vec2F(1.0f, 1.0f), Math::Vec2F(5.0f, 5.0f)));
+    EXPECT_EQ(aabbTree.nodes[aabbTree.proxies[0]].aabb.MinBound(), fatAabb.MinBound());
+
+    aabbTree.UpdateCollider(CreateSimplifiedCollider(0, Math::Vec2F(50.0f, 1.0f), Math::Vec2F(5.0f, 5.0f)));
+    EXPECT_TRUE(aabbTree.nodes[aabbTree.proxies[0]].aabb.Contains(Math::Vec2F(50.0f, 1.0f)));
+    CheckNode(aabbTree, aabbTree.root);
+}
+
+TEST(AABBTree, RemoveCollider)
+{
+    Engine::AABBTree aabbTree;
+    aabbTree.Init();
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        aabbTree.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 20.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)));
+    }
+    for (std::size_t i = 0; i < 9; i++)
+    {
+        aabbTree.RemoveCollider(i);
+        EXPECT_EQ(aabbTree.proxies[i], Engine::AABBTree::NullNode);
+        CheckNode(aabbTree, aabbTree.root);
+    }
+
+    EXPECT_EQ(aabbTree.root, aabbTree.proxies[9]);
+    aabbTree.RemoveCollider(9);
+    EXPECT_EQ(aabbTree.root, Engine::AABBTree::NullNode);
+}
+
+TEST(AABBTree, FindPossiblePairsMatchesOverlaps)
+{
+    Engine::AABBTree aabbTree;
+    aabbTree.Init();
+
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 100; i++)
+    {
+        // Mix small colliders with a few large ones.
+        const auto halfSize = i % 25 == 0 ? Math::Vec2F(300.0f, 20.0f) : Math::Vec2F(4.0f, 4.0f);
+        colliders.push_back(CreateSimplifiedCollider(i, Math::Vec2F((i * 37) % 800, (i * 53) % 600), halfSize));
+        aabbTree.UpdateCollider(colliders.back());
+    }
+    aabbTree.FindPossiblePairs();
+
+    for (std::size_t i = 0; i < colliders.size(); i++)
+    {
+        for (std::size_t j = i + 1; j < colliders.size(); j++)
+        {
+            const auto fatAabbA = Engine::FattenAABB(colliders[i].aabb, Engine::AABBTree::FatAABBMargin);
+            const auto fatAabbB = Engine::FattenAABB(colliders[j].aabb, Engine::AABBTree::FatAABBMargin);
+            const Engine::ColliderPair pair{colliders[i].colliderRef, colliders[j].colliderRef};
+            const auto pairCount = std::count(aabbTree.colliderPairs.begin(), aabbTree.colliderPairs.end(), pair);
+            EXPECT_EQ(pairCount, Math::Intersect(fatAabbA, fatAabbB) ? 1 : 0);
+        }
+    }
+}
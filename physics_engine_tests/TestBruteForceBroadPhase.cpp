@@ -0,0 +1,58 @@
+#include "BruteForceBroadPhase.h"
+#include "BroadPhaseTestUtils.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <vector>
+
+class CountingQueryCallback : public Engine::QueryCallback
+{
+public:
+    std::size_t count = 0;
+
+    void OnColliderFound(std::size_t, Engine::ColliderRef) noexcept override
+    {
+        count++;
+    }
+};
+
+TEST(BruteForceBroadPhase, FindPossiblePairs)
+{
+    Engine::BruteForceBroadPhase broadPhase;
+    broadPhase.Init();
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        broadPhase.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 8.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)));
+    }
+    broadPhase.FindPossiblePairs();
+    EXPECT_EQ(broadPhase.ColliderPairs().size(), 9);
+    for (std::size_t i = 0; i < 9; i++)
+    {
+        const Engine::ColliderPair pair{Engine::ColliderRef{i, 0}, Engine::ColliderRef{i + 1, 0}};
+        EXPECT_EQ(std::count(broadPhase.colliderPairs.begin(), broadPhase.colliderPairs.end(), pair), 1);
+    }
+
+    broadPhase.RemoveCollider(4);
+    broadPhase.FindPossiblePairs();
+    EXPECT_EQ(broadPhase.ColliderPairs().size(), 7);
+
+    CountingQueryCallback callback;
+    broadPhase.QueryAABB(Math::RectangleF::FromCenter(Math::Vec2F(32.0f, 0.0f), Math::Vec2F(1.0f, 1.0f)), 0, callback);
+    EXPECT_EQ(callback.count, 0);
+    broadPhase.QueryAABB(Math::RectangleF::FromCenter(Math::Vec2F(36.0f, 0.0f), Math::Vec2F(1.0f, 1.0f)), 0, callback);
+    EXPECT_EQ(callback.count, 1);
+}
+
+TEST(BruteForceBroadPhase, FindPossiblePairsSkipsFilteredPairs)
+{
+    Engine::BruteForceBroadPhase broadPhase;
+    broadPhase.Init();
+
+    auto colliderA = CreateSimplifiedCollider(0, Math::Vec2F(0.0f, 0.0f), Math::Vec2F(5.0f, 5.0f));
+    auto colliderB = CreateSimplifiedCollider(1, Math::Vec2F(2.0f, 0.0f), Math::Vec2F(5.0f, 5.0f));
+    colliderA.filter.groupIndex = -1;
+    colliderB.filter.groupIndex = -1;
+    broadPhase.UpdateCollider(colliderA);
+    broadPhase.UpdateCollider(colliderB);
+    broadPhase.FindPossiblePairs();
+    EXPECT_TRUE(broadPhase.ColliderPairs().empty());
+}
@@ -1,5 +1,6 @@
 #include "Collider.h"
 #include "gtest/gtest.h"
+#include <array>
 
 struct ColliderFixture : public ::testing::TestWithParam<std::size_t>
 {
@@ -78,4 +79,56 @@ TEST_P(ColliderFixture, HashFunction)
     std::size_t hash2 = hashFunction(pair2);
 
     EXPECT_EQ(hash1, hash2);
-}
\ No newline at end of file
+}
+
+TEST(Collider, ShouldCollide)
+{
+    const Engine::CollisionFilter defaultFilter{};
+    EXPECT_TRUE(Engine::ShouldCollide(defaultFilter, defaultFilter));
+
+    // A bullet does not collide with the other bullets, both ways.
+    const Engine::CollisionFilter bullet{0b10u, ~0b10u, 0};
+    EXPECT_FALSE(Engine::ShouldCollide(bullet, bullet));
+    EXPECT_TRUE(Engine::ShouldCollide(bullet, defaultFilter));
+
+    // The group wins over the masks.
+    const Engine::CollisionFilter ragdollPart{0b100u, 0u, 3};
+    const Engine::CollisionFilter player{0b1u, ~0u, -3};
+    EXPECT_TRUE(Engine::ShouldCollide(ragdollPart, ragdollPart));
+    EXPECT_FALSE(Engine::ShouldCollide(ragdollPart, defaultFilter));
+    EXPECT_FALSE(Engine::ShouldCollide(player, player));
+    EXPECT_TRUE(Engine::ShouldCollide(player, defaultFilter));
+}
+
+TEST(Collider, FilterMask8MatchesShouldCollide)
+{
+    const std::array<Engine::CollisionFilter, 8> packedFilters{
+            Engine::CollisionFilter{},
+            Engine::CollisionFilter{0b10u, ~0b10u, 0},
+            Engine::CollisionFilter{0b100u, 0u, 3},
+            Engine::CollisionFilter{0b1u, ~0u, -3},
+            Engine::CollisionFilter{0b100u, 0b1u, 0},
+            Engine::CollisionFilter{0b1000u, ~0u, 3},
+            Engine::CollisionFilter{0b10u, 0b10u, -3},
+            Engine::CollisionFilter{0u, ~0u, 0}
+    };
+
+    std::array<std::uint32_t, 8> categoryBits{}, maskBits{};
+    std::array<std::int32_t, 8> groupIndices{};
+    for (std::size_t i = 0; i < packedFilters.size(); i++)
+    {
+        categoryBits[i] = packedFilters[i].categoryBits;
+        maskBits[i] = packedFilters[i].maskBits;
+        groupIndices[i] = packedFilters[i].groupIndex;
+    }
+
+    for (const auto& filter: packedFilters)
+    {
+        std::uint32_t expectedMask = 0;
+        for (std::size_t i = 0; i < packedFilters.size(); i++)
+        {
+            expectedMask |= static_cast<std::uint32_t>(Engine::ShouldCollide(filter, packedFilters[i])) << i;
+        }
+        EXPECT_EQ(Engine::FilterMask8(filter, categoryBits.data(), maskBits.data(), groupIndices.data()), expectedMask);
+    }
+}
@@ -0,0 +1,306 @@
+#include "Contact.h"
+#include "World.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <array>
+#include <vector>
+
+TEST(Contact, CircleContacts8MatchesIntersect)
+{
+    // Overlapping, touching, separated and concentric circles, padded after the last pair.
+    constexpr std::size_t pairCount = 11;
+    std::vector<Math::CircleF> circlesA;
+    std::vector<Math::CircleF> circlesB;
+    for (std::size_t i = 0; i < pairCount; i++)
+    {
+        circlesA.emplace_back(Math::Vec2F(static_cast<float>(i) * 10.0f, 5.0f), 2.0f + static_cast<float>(i % 3));
+        circlesB.emplace_back(circlesA[i].Center() + Math::Vec2F(static_cast<float>(i) - 4.0f, 3.0f), 2.0f);
+    }
+    circlesB[4] = Math::CircleF(circlesA[4].Center() + Math::Vec2F(circlesA[4].Radius() + 2.0f, 0.0f), 2.0f);
+    circlesB[7] = Math::CircleF(circlesA[7].Center(), 1.0f);
+
+    std::array<float, pairCount + Engine::ContactBatchSize> centerAX{}, centerAY{}, centerBX{}, centerBY{}, radiusSum{};
+    std::array<float, pairCount + Engine::ContactBatchSize> normalX{}, normalY{}, penetration{};
+    for (std::size_t i = 0; i < pairCount; i++)
+    {
+        centerAX[i] = circlesA[i].Center().X;
+        centerAY[i] = circlesA[i].Center().Y;
+        centerBX[i] = circlesB[i].Center().X;
+        centerBY[i] = circlesB[i].Center().Y;
+        radiusSum[i] = circlesA[i].Radius() + circlesB[i].Radius();
+    }
+
+    for (std::size_t batchStart = 0; batchStart < pairCount; batchStart += Engine::ContactBatchSize)
+    {
+        const auto mask = Engine::CircleContacts8(&centerAX[batchStart], &centerAY[batchStart], &centerBX[batchStart],
+                                                  &centerBY[batchStart], &radiusSum[batchStart], &normalX[batchStart],
+                                                  &normalY[batchStart], &penetration[batchStart]);
+        for (std::size_t i = batchStart; i < std::min(batchStart + Engine::ContactBatchSize, pairCount); i++)
+        {
+            const bool isContact = (mask >> (i - batchStart) & 1u) != 0;
+            EXPECT_EQ(isContact, Math::Intersect(circlesA[i], circlesB[i]));
+
+            const auto delta = circlesA[i].Center() - circlesB[i].Center();
+            EXPECT_NEAR(penetration[i], radiusSum[i] - delta.Length(), 1e-4f);
+            if (i == 7)
+            {
+                EXPECT_EQ(Math::Vec2F(normalX[i], normalY[i]), Math::Vec2F(0.0f, 1.0f));
+                continue;
+            }
+            EXPECT_NEAR(normalX[i], delta.Normalized().X, 1e-4f);
+            EXPECT_NEAR(normalY[i], delta.Normalized().Y, 1e-4f);
+        }
+    }
+}
+
+TEST(Contact, CollideCircles)
+{
+    const Math::CircleF circleA(Math::Vec2F(3.0f, 0.0f), 2.0f);
+    const auto manifold = Engine::CollideCircles(circleA, Math::CircleF(Math::Vec2F::Zero(), 2.0f));
+    ASSERT_EQ(manifold.pointCount, 1);
+    EXPECT_NEAR(manifold.normal.X, 1.0f, 1e-5f);
+    EXPECT_NEAR(manifold.normal.Y, 0.0f, 1e-5f);
+    EXPECT_FLOAT_EQ(manifold.depth, 1.0f);
+    EXPECT_NEAR(manifold.points[0].X, 1.5f, 1e-5f);
+    EXPECT_NEAR(manifold.points[0].Y, 0.0f, 1e-5f);
+
+    // Touching circles collide like Math::Intersect, with no depth.
+    const auto touching = Engine::CollideCircles(circleA, Math::CircleF(Math::Vec2F(-1.0f, 0.0f), 2.0f));
+    EXPECT_TRUE(touching.HasContact());
+    EXPECT_FLOAT_EQ(touching.depth, 0.0f);
+    EXPECT_FALSE(Engine::CollideCircles(circleA, Math::CircleF(Math::Vec2F(-2.0f, 0.0f), 2.0f)).HasContact());
+}
+
+TEST(Contact, CollideCircleRectangle)
+{
+    const auto rectangle = Math::RectangleF(Math::Vec2F(-2.0f, -1.0f), Math::Vec2F(2.0f, 1.0f));
+
+    const auto above = Engine::CollideCircleRectangle(Math::CircleF(Math::Vec2F(1.0f, 1.5f), 1.0f), rectangle);
+    ASSERT_EQ(above.pointCount, 1);
+    EXPECT_NEAR(above.normal.X, 0.0f, 1e-5f);
+    EXPECT_NEAR(above.normal.Y, 1.0f, 1e-5f);
+    EXPECT_FLOAT_EQ(above.depth, 0.5f);
+    EXPECT_NEAR(above.points[0].X, 1.0f, 1e-5f);
+    EXPECT_NEAR(above.points[0].Y, 1.0f, 1e-5f);
+
+    // A center inside the rectangle leaves through the closest side.
+    const auto inside = Engine::CollideCircleRectangle(Math::CircleF(Math::Vec2F(1.5f, 0.0f), 1.0f), rectangle);
+    ASSERT_EQ(inside.pointCount, 1);
+    EXPECT_NEAR(inside.normal.X, 1.0f, 1e-5f);
+    EXPECT_NEAR(inside.normal.Y, 0.0f, 1e-5f);
+    EXPECT_FLOAT_EQ(inside.depth, 1.5f);
+
+    const auto corner = Math::CircleF(Math::Vec2F(3.0f, 2.0f), 1.0f);
+    EXPECT_EQ(Engine::CollideCircleRectangle(corner, rectangle).HasContact(), Math::Intersect(corner, rectangle));
+
+    const auto flipped = Engine::CollideRectangleCircle(rectangle, Math::CircleF(Math::Vec2F(1.0f, 1.5f), 1.0f));
+    EXPECT_NEAR(flipped.normal.X, 0.0f, 1e-5f);
+    EXPECT_NEAR(flipped.normal.Y, -1.0f, 1e-5f);
+}
+
+TEST(Contact, CollideRectangles)
+{
+    const auto rectangleA = Math::RectangleF(Math::Vec2F(0.0f, 1.5f), Math::Vec2F(4.0f, 3.5f));
+    const auto rectangleB = Math::RectangleF(Math::Vec2F(1.0f, 0.0f), Math::Vec2F(6.0f, 2.0f));
+    const auto manifold = Engine::CollideRectangles(rectangleA, rectangleB);
+    ASSERT_EQ(manifold.pointCount, 2);
+    EXPECT_NEAR(manifold.normal.X, 0.0f, 1e-5f);
+    EXPECT_NEAR(manifold.normal.Y, 1.0f, 1e-5f);
+    EXPECT_FLOAT_EQ(manifold.depth, 0.5f);
+    EXPECT_NEAR(manifold.points[0].X, 1.0f, 1e-5f);
+    EXPECT_NEAR(manifold.points[0].Y, 1.75f, 1e-5f);
+    EXPECT_NEAR(manifold.points[1].X, 4.0f, 1e-5f);
+    EXPECT_NEAR(manifold.points[1].Y, 1.75f, 1e-5f);
+
+    const auto apart = Math::RectangleF(Math::Vec2F(5.0f, 2.5f), Math::Vec2F(6.0f, 3.0f));
+    EXPECT_FALSE(Engine::CollideRectangles(rectangleA, apart).HasContact());
+}
+
+TEST(Contact, CollideMatchesIsContact)
+{
+    std::vector<Engine::Collider> colliders;
+    for (std::size_t i = 0; i < 40; i++)
+    {
+        Engine::Collider collider;
+        const auto center = Math::Vec2F(static_cast<float>((i * 7) % 20), static_cast<float>((i * 11) % 20));
+        collider._shape = i % 2 == 0 ? Math::ShapeType::Circle : Math::ShapeType::Rectangle;
+        collider.circleShape = Math::CircleF(center, 2.0f + static_cast<float>(i % 3));
+        collider.rectangleShape = Math::RectangleF::FromCenter(center, Math::Vec2F(3.0f, 1.0f + static_cast<float>(i % 4)));
+        colliders.push_back(collider);
+    }
+
+    for (const auto& colliderA: colliders)
+    {
+        for (const auto& colliderB: colliders)
+        {
+            const auto manifold = Engine::Collide(colliderA, colliderB);
+            EXPECT_EQ(manifold.HasContact(), Engine::World::IsContact(colliderA, colliderB));
+            if (manifold.HasContact())
+            {
+                EXPECT_GE(manifold.depth, 0.0f);
+                EXPECT_NEAR(manifold.normal.Length(), 1.0f, 1e-4f);
+            }
+        }
+    }
+}
+
+TEST(Contact, CollideBucketWritesTheManifoldOfEachPair)
+{
+    std::vector<Engine::Collider> colliders(6);
+    for (std::size_t i = 0; i < colliders.size(); i++)
+    {
+        const auto center = Math::Vec2F(static_cast<float>(i) * 3.0f, 0.0f);
+        colliders[i]._shape = i < 3 ? Math::ShapeType::Rectangle : Math::ShapeType::Polygon;
+        colliders[i].circleShape = Math::CircleF(center, 2.0f);
+        colliders[i].rectangleShape = Math::RectangleF::FromCenter(center, Math::Vec2F(2.0f, 2.0f));
+    }
+
+    const std::vector<Engine::ColliderPair> pairs{
+            {Engine::ColliderRef{0, 0}, Engine::ColliderRef{1, 0}},
+            {Engine::ColliderRef{3, 0}, Engine::ColliderRef{4, 0}},
+            {Engine::ColliderRef{1, 0}, Engine::ColliderRef{2, 0}},
+            {Engine::ColliderRef{0, 0}, Engine::ColliderRef{2, 0}}};
+    const std::vector<std::uint32_t> rectanglePairIndices{0, 2, 3};
+    std::vector<Engine::ContactManifold> manifolds(pairs.size());
+
+    constexpr auto rectanglePair = Engine::ShapePairIndex(Math::ShapeType::Rectangle, Math::ShapeType::Rectangle);
+    Engine::CollideBucketTable[rectanglePair](colliders.data(), pairs.data(), rectanglePairIndices.data(),
+                                              rectanglePairIndices.size(), manifolds.data());
+    EXPECT_TRUE(manifolds[0].HasContact());
+    EXPECT_FALSE(manifolds[1].HasContact());
+    EXPECT_TRUE(manifolds[2].HasContact());
+    EXPECT_FALSE(manifolds[3].HasContact());
+    EXPECT_NEAR(manifolds[0].normal.X, -1.0f, 1e-5f);
+    EXPECT_NEAR(manifolds[0].depth, 1.0f, 1e-5f);
+
+    // The polygons have no collide function yet, the dispatch gives no contact.
+    EXPECT_FALSE(Engine::Collide(colliders[3], colliders[4]).HasContact());
+    EXPECT_FALSE(Engine::IntersectTable[Engine::ShapePairIndex(Math::ShapeType::Polygon, Math::ShapeType::Polygon)](
+            colliders[3], colliders[4]));
+}
+
+TEST(Contact, ResolveVelocityKeepsTheAccumulatedImpulsePositive)
+{
+    Engine::Body bodyA(1.0f, Math::Vec2F(0.0f, -4.0f), Math::Vec2F(0.0f, 3.0f));
+    Engine::Body bodyB(3.0f, Math::Vec2F::Zero(), Math::Vec2F::Zero());
+    Engine::Collider colliderA, colliderB;
+    colliderA.restitution = 0.5f;
+    colliderB.restitution = 0.5f;
+
+    Engine::ContactManifold manifold;
+    manifold.normal = Math::Vec2F(0.0f, 1.0f);
+    manifold.depth = 0.5f;
+    manifold.points[0] = Math::Vec2F(0.0f, 1.25f);
+    manifold.pointCount = 1;
+
+    Engine::Contact contact;
+    contact.collidingBodies[0] = Engine::CollidingBody{&bodyA, &colliderA};
+    contact.collidingBodies[1] = Engine::CollidingBody{&bodyB, &colliderB};
+    contact.Prepare(manifold);
+    EXPECT_FLOAT_EQ(contact.normalMass, 0.75f);
+    EXPECT_FLOAT_EQ(contact.velocityBias, 2.0f);
+
+    // A single iteration solves a lone contact, the next ones change nothing.
+    for (int iteration = 0; iteration < 3; iteration++)
+    {
+        contact.ResolveVelocity();
+        EXPECT_NEAR(contact.CalculateSeparateVelocity(), 2.0f, 1e-5f);
+        EXPECT_NEAR(contact.normalImpulse, 4.5f, 1e-5f);
+    }
+
+    // A warm start impulse pushing too hard is taken back, but never pulls the bodies together.
+    bodyA.SetVelocity(Math::Vec2F(0.0f, 1.0f));
+    bodyB.SetVelocity(Math::Vec2F::Zero());
+    contact.Prepare(manifold);
+    contact.normalImpulse = 6.0f;
+    contact.WarmStart();
+    contact.ResolveVelocity();
+    EXPECT_FLOAT_EQ(contact.normalImpulse, 0.0f);
+    EXPECT_NEAR(contact.CalculateSeparateVelocity(), 1.0f, 1e-5f);
+
+    // A static body is never moved, the dynamic body takes the whole impulse.
+    bodyB.type = Engine::BodyType::STATIC;
+    bodyA.SetVelocity(Math::Vec2F(0.0f, -4.0f));
+    bodyB.SetVelocity(Math::Vec2F::Zero());
+    contact.normalImpulse = 0.0f;
+    contact.Prepare(manifold);
+    contact.ResolveVelocity();
+    contact.ResolveInterpenetration();
+    EXPECT_EQ(bodyB.Velocity(), Math::Vec2F::Zero());
+    EXPECT_EQ(bodyB.Position(), Math::Vec2F::Zero());
+    EXPECT_NEAR(bodyA.Velocity().Y, 2.0f, 1e-5f);
+    EXPECT_NEAR(bodyA.Position().Y, 3.5f, 1e-5f);
+}
+
+TEST(Contact, SolveContacts8MatchesResolveVelocity)
+{
+    // Ten bodies, contacts 0 to 4 pair them two by two, the padding lanes point at the still body 10.
+    std::vector<Engine::Body> bodies;
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        bodies.emplace_back(1.0f + static_cast<float>(i % 3),
+                            Math::Vec2F(static_cast<float>(i % 4) - 1.5f, static_cast<float>(i % 5) - 2.0f),
+                            Math::Vec2F::Zero());
+    }
+    bodies[9].type = Engine::BodyType::STATIC;
+    std::vector<Engine::Collider> colliders(bodies.size());
+
+    std::array<float, Engine::ContactBatchSize> normalX{}, normalY{}, normalMass{}, velocityBias{};
+    std::array<float, Engine::ContactBatchSize> inverseMassA{}, inverseMassB{}, normalImpulse{};
+    std::array<std::int32_t, Engine::ContactBatchSize> bodyA{}, bodyB{};
+    bodyA.fill(10);
+    bodyB.fill(10);
+    std::array<float, 11> velocityX{}, velocityY{};
+    for (std::size_t i = 0; i < bodies.size(); i++)
+    {
+        velocityX[i] = bodies[i].Velocity().X;
+        velocityY[i] = bodies[i].Velocity().Y;
+    }
+
+    std::vector<Engine::Contact> contacts(5);
+    for (std::size_t i = 0; i < contacts.size(); i++)
+    {
+        Engine::ContactManifold manifold;
+        manifold.normal = Math::Vec2F(static_cast<float>(i) - 2.0f, 1.0f).Normalized();
+        manifold.depth = 0.1f;
+        manifold.pointCount = 1;
+        auto& contact = contacts[i];
+        contact.collidingBodies[0] = Engine::CollidingBody{&bodies[2 * i], &colliders[2 * i]};
+        contact.collidingBodies[1] = Engine::CollidingBody{&bodies[2 * i + 1], &colliders[2 * i + 1]};
+        contact.normalImpulse = static_cast<float>(i % 2);
+        contact.Prepare(manifold);
+
+        normalX[i] = contact.contactNormal.X;
+        normalY[i] = contact.contactNormal.Y;
+        normalMass[i] = contact.normalMass;
+        velocityBias[i] = contact.velocityBias;
+        inverseMassA[i] = contact.inverseMasses[0];
+        inverseMassB[i] = contact.inverseMasses[1];
+        normalImpulse[i] = contact.normalImpulse;
+        bodyA[i] = static_cast<std::int32_t>(2 * i);
+        bodyB[i] = static_cast<std::int32_t>(2 * i + 1);
+    }
+
+    for (int iteration = 0; iteration < 2; iteration++)
+    {
+        for (auto& contact: contacts)
+        {
+            contact.ResolveVelocity();
+        }
+        Engine::SolveContacts8(normalX.data(), normalY.data(), normalMass.data(), velocityBias.data(),
+                               inverseMassA.data(), inverseMassB.data(), bodyA.data(), bodyB.data(),
+                               velocityX.data(), velocityY.data(), normalImpulse.data());
+    }
+
+    for (std::size_t i = 0; i < contacts.size(); i++)
+    {
+        EXPECT_NEAR(normalImpulse[i], contacts[i].normalImpulse, 1e-5f);
+    }
+    for (std::size_t i = 0; i < bodies.size(); i++)
+    {
+        EXPECT_NEAR(velocityX[i], bodies[i].Velocity().X, 1e-5f);
+        EXPECT_NEAR(velocityY[i], bodies[i].Velocity().Y, 1e-5f);
+    }
+    EXPECT_EQ(velocityX[10], 0.0f);
+    EXPECT_EQ(velocityY[10], 0.0f);
+}
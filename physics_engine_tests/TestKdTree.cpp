@@ -0,0 +1,131 @@
+#include "KdTree.h"
+#include "BroadPhaseTestUtils.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <vector>
+
+TEST(KdTree, ConstructorDefault)
+{
+    Engine::KdTree kdTree;
+    EXPECT_TRUE(kdTree.proxies.empty());
+    EXPECT_TRUE(kdTree.nodes.empty());
+    EXPECT_TRUE(kdTree.colliderPairs.empty());
+    EXPECT_EQ(kdTree.leafSize, Engine::KdTree::DefaultLeafSize);
+}
+
+TEST(KdTree, LeavesAreBalancedAndSplitAtTheMedian)
+{
+    Engine::KdTree kdTree;
+    kdTree.leafSize = 5;
+    kdTree.Init();
+
+    // Most colliders are packed in a corner, the leaves must stay balanced anyway.
+    for (std::size_t i = 0; i < 300; i++)
+    {
+        const auto center = i % 10 == 0 ? Math::Vec2F((i * 37) % 800, (i * 53) % 600) :
+                            Math::Vec2F((i * 7) % 20, (i * 11) % 20);
+        kdTree.UpdateCollider(CreateSimplifiedCollider(i, center, Math::Vec2F(2.0f, 2.0f)));
+    }
+    kdTree.FindPossiblePairs();
+
+    ASSERT_EQ(kdTree.entries.size(), 300);
+    ASSERT_FALSE(kdTree.nodes.empty());
+    EXPECT_EQ(kdTree.nodes.front().begin, 0);
+    EXPECT_EQ(kdTree.nodes.front().end, 300);
+
+    std::size_t leafColliderCount = 0;
+    for (std::size_t nodeIndex = 0; nodeIndex < kdTree.nodes.size(); nodeIndex++)
+    {
+        const auto& node = kdTree.nodes[nodeIndex];
+        if (node.IsLeaf())
+        {
+            // 300 colliders halved six times give leaves of 4 or 5 colliders.
+            EXPECT_GE(node.end - node.begin, 4);
+            EXPECT_LE(node.end - node.begin, 5);
+            leafColliderCount += node.end - node.begin;
+            continue;
+        }
+
+        const auto& left = kdTree.nodes[nodeIndex + 1];
+        const auto& right = kdTree.nodes[node.rightChild];
+        EXPECT_EQ(left.begin, node.begin);
+        EXPECT_EQ(left.end, right.begin);
+        EXPECT_EQ(right.end, node.end);
+        EXPECT_LE(right.end - right.begin - (left.end - left.begin), 1);
+    }
+    EXPECT_EQ(leafColliderCount, 300);
+
+    // The root splits on x, every center on its left is at most the smallest center on its right.
+    const auto& root = kdTree.nodes.front();
+    const auto middle = kdTree.nodes[root.rightChild].begin;
+    const auto leftMax = std::max_element(kdTree.entries.begin(), kdTree.entries.begin() + middle,
+                                          [](const Engine::KdTreeEntry& a, const Engine::KdTreeEntry& b)
+                                          {
+                                              return a.centerX < b.centerX;
+                                          });
+    const auto rightMin = std::min_element(kdTree.entries.begin() + middle, kdTree.entries.end(),
+                                           [](const Engine::KdTreeEntry& a, const Engine::KdTreeEntry& b)
+                                           {
+                                               return a.centerX < b.centerX;
+                                           });
+    EXPECT_LE(leftMax->centerX, rightMin->centerX);
+}
+
+TEST(KdTree, FindPossiblePairsReportsEachOverlapOnce)
+{
+    for (const std::uint32_t leafSize: {1u, 3u, 8u, 32u})
+    {
+        Engine::KdTree kdTree;
+        kdTree.leafSize = leafSize;
+        kdTree.Init();
+
+        std::vector<Engine::SimplifedCollider> colliders;
+        for (std::size_t i = 0; i < 300; i++)
+        {
+            const auto halfSize = i % 50 == 0 ? Math::Vec2F(200.0f, 15.0f) : Math::Vec2F(12.0f, 12.0f);
+            colliders.push_back(CreateSimplifiedCollider(i, Math::Vec2F((i * 37) % 800, (i * 53) % 600), halfSize));
+            kdTree.UpdateCollider(colliders.back());
+        }
+        kdTree.FindPossiblePairs();
+
+        CheckPairsMatchOverlaps(kdTree, colliders);
+    }
+}
+
+TEST(KdTree, FindPossiblePairsWithTouchingColliders)
+{
+    Engine::KdTree kdTree;
+    kdTree.leafSize = 4;
+    kdTree.Init();
+
+    // A grid of colliders touching their neighbours exactly on the median splits.
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 64; i++)
+    {
+        const auto center = Math::Vec2F(static_cast<float>(i % 8) * 10.0f + 5.0f, static_cast<float>(i / 8) * 10.0f + 5.0f);
+        colliders.push_back(CreateSimplifiedCollider(i, center, Math::Vec2F(5.0f, 5.0f)));
+        kdTree.UpdateCollider(colliders.back());
+    }
+    kdTree.FindPossiblePairs();
+
+    CheckPairsMatchOverlaps(kdTree, colliders);
+}
+
+TEST(KdTree, RemoveCollider)
+{
+    Engine::KdTree kdTree;
+    kdTree.leafSize = 2;
+    kdTree.Init();
+
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        kdTree.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 8.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)));
+    }
+    kdTree.FindPossiblePairs();
+    EXPECT_EQ(kdTree.colliderPairs.size(), 9);
+
+    kdTree.RemoveCollider(4);
+    kdTree.FindPossiblePairs();
+    EXPECT_EQ(kdTree.entries.size(), 9);
+    EXPECT_EQ(kdTree.colliderPairs.size(), 7);
+}
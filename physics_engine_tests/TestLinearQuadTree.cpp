@@ -0,0 +1,110 @@
+#include "LinearQuadTree.h"
+#include "BroadPhaseTestUtils.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <vector>
+
+TEST(LinearQuadTree, ConstructorDefault)
+{
+    Engine::LinearQuadTree linearQuadTree;
+    EXPECT_TRUE(linearQuadTree.proxies.empty());
+    EXPECT_TRUE(linearQuadTree.entries.empty());
+    EXPECT_TRUE(linearQuadTree.colliderPairs.empty());
+}
+
+TEST(LinearQuadTree, KeysAreSortedInDepthFirstOrder)
+{
+    Engine::LinearQuadTree linearQuadTree;
+    linearQuadTree.Init();
+
+    // The first collider spans the whole world and can only be stored in the root node.
+    linearQuadTree.UpdateCollider(CreateSimplifiedCollider(0, Math::Vec2F(400.0f, 300.0f), Math::Vec2F(400.0f, 300.0f)));
+    for (std::size_t i = 1; i < 200; i++)
+    {
+        const auto halfSize = i % 10 == 0 ? Math::Vec2F(60.0f, 60.0f) : Math::Vec2F(3.0f, 3.0f);
+        linearQuadTree.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F((i * 37) % 800, (i * 53) % 600), halfSize));
+    }
+    linearQuadTree.FindPossiblePairs();
+
+    ASSERT_EQ(linearQuadTree.entries.size(), 200);
+    EXPECT_EQ(linearQuadTree.entries.front().colliderIndex, 0);
+    EXPECT_EQ(Engine::LinearQuadTree::Level(linearQuadTree.entries.front().key), 0);
+    for (std::size_t i = 1; i < linearQuadTree.entries.size(); i++)
+    {
+        const auto& previous = linearQuadTree.entries[i - 1];
+        const auto& entry = linearQuadTree.entries[i];
+        EXPECT_LE(previous.key, entry.key);
+        // A following node inside the subtree of the previous one is one of its descendants, or the same node.
+        if (entry.key < Engine::LinearQuadTree::SubtreeEndKey(previous.key))
+        {
+            EXPECT_GE(Engine::LinearQuadTree::Level(entry.key), Engine::LinearQuadTree::Level(previous.key));
+        }
+        EXPECT_LE(Engine::LinearQuadTree::SubtreeEndKey(entry.key),
+                  Engine::LinearQuadTree::SubtreeEndKey(linearQuadTree.entries.front().key));
+    }
+}
+
+TEST(LinearQuadTree, SubtreeEndKey)
+{
+    using Engine::LinearQuadTree;
+    // The root subtree covers every cell of the deepest level.
+    EXPECT_EQ(LinearQuadTree::SubtreeEndKey(0), std::uint64_t{1} << (2 * LinearQuadTree::MaxLevel + LinearQuadTree::LevelBitCount));
+
+    // A deepest level node only covers its own cell.
+    const std::uint64_t leafKey = (std::uint64_t{42} << LinearQuadTree::LevelBitCount) | LinearQuadTree::MaxLevel;
+    EXPECT_EQ(LinearQuadTree::Level(leafKey), LinearQuadTree::MaxLevel);
+    EXPECT_EQ(LinearQuadTree::SubtreeEndKey(leafKey), std::uint64_t{43} << LinearQuadTree::LevelBitCount);
+}
+
+TEST(LinearQuadTree, FindPossiblePairsReportsEachOverlapOnce)
+{
+    Engine::LinearQuadTree linearQuadTree;
+    linearQuadTree.Init();
+
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 300; i++)
+    {
+        const auto halfSize = i % 50 == 0 ? Math::Vec2F(200.0f, 15.0f) : Math::Vec2F(12.0f, 12.0f);
+        colliders.push_back(CreateSimplifiedCollider(i, Math::Vec2F((i * 37) % 800, (i * 53) % 600), halfSize));
+        linearQuadTree.UpdateCollider(colliders.back());
+    }
+    linearQuadTree.FindPossiblePairs();
+
+    CheckPairsMatchOverlaps(linearQuadTree, colliders);
+}
+
+TEST(LinearQuadTree, FindPossiblePairsWithTouchingColliders)
+{
+    Engine::LinearQuadTree linearQuadTree;
+    linearQuadTree.Init();
+
+    // A grid of colliders touching their neighbours exactly on the node boundaries.
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 64; i++)
+    {
+        const auto center = Math::Vec2F(static_cast<float>(i % 8) * 10.0f + 5.0f, static_cast<float>(i / 8) * 10.0f + 5.0f);
+        colliders.push_back(CreateSimplifiedCollider(i, center, Math::Vec2F(5.0f, 5.0f)));
+        linearQuadTree.UpdateCollider(colliders.back());
+    }
+    linearQuadTree.FindPossiblePairs();
+
+    CheckPairsMatchOverlaps(linearQuadTree, colliders);
+}
+
+TEST(LinearQuadTree, RemoveCollider)
+{
+    Engine::LinearQuadTree linearQuadTree;
+    linearQuadTree.Init();
+
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        linearQuadTree.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 8.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)));
+    }
+    linearQuadTree.FindPossiblePairs();
+    EXPECT_EQ(linearQuadTree.colliderPairs.size(), 9);
+
+    linearQuadTree.RemoveCollider(4);
+    linearQuadTree.FindPossiblePairs();
+    EXPECT_EQ(linearQuadTree.entries.size(), 9);
+    EXPECT_EQ(linearQuadTree.colliderPairs.size(), 7);
+}
@@ -1,12 +1,13 @@
 #include "QuadTree.h"
+#include "BroadPhaseTestUtils.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <array>
-
-static HeapAllocator TestHeapAllocator;
+#include <vector>
 
 TEST(QuadNode, ConstructorDefault)
 {
-    Engine::QuadNode node{TestHeapAllocator};
+    Engine::QuadNode node;
     EXPECT_EQ(node.bounds.MaxBound().X, Math::Vec2F::Zero().X);
     EXPECT_EQ(node.bounds.MaxBound().Y, Math::Vec2F::Zero().Y);
 
@@ -21,25 +22,492 @@ TEST(QuadNode, ConstructorDefault)
 
 TEST(QuadTree, ConstructorDefault)
 {
-    Engine::QuadTree quadTree{TestHeapAllocator};
-    EXPECT_EQ(quadTree.nodeIndex, 1);
-    EXPECT_EQ(quadTree.MaxColliderInNode, Engine::QuadTree::MaxColliderInNode);
-    EXPECT_EQ(quadTree.MaxDepth, Engine::QuadTree::MaxDepth);
+    Engine::QuadTree quadTree;
+    EXPECT_EQ(quadTree.NodeCount(), 1);
+    EXPECT_EQ(quadTree.maxColliderInNode, Engine::QuadTree::DefaultMaxColliderInNode);
+    EXPECT_EQ(quadTree.maxDepth, Engine::QuadTree::DefaultMaxDepth);
 }
 
 TEST(QuadTree, Init)
 {
-    Engine::QuadTree quadTree{TestHeapAllocator};
+    Engine::QuadTree quadTree;
+    quadTree.Init();
+
+    EXPECT_EQ(quadTree.root.children[0], nullptr);
+    EXPECT_EQ(quadTree.NodeCount(), 1);
+    EXPECT_EQ(quadTree.AllocatedNodeCount(), 1);
+    EXPECT_EQ(quadTree.root.bounds.MaxBound(), Math::Vec2F(0.0f, 0.0f));
+}
+
+TEST(QuadTree, UpdateColliderKeepsColliderInsideFatAABB)
+{
+    Engine::QuadTree quadTree;
+    quadTree.Init();
+    for (std::size_t i = 0; i < 20; i++)
+    {
+        quadTree.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 40.0f, i * 25.0f), 5.0f));
+    }
+    quadTree.Rebalance();
+
+    const auto* nodeBefore = quadTree.proxies[7].node;
+    const auto aabbBefore = quadTree.proxies[7].collider.aabb;
+    quadTree.UpdateCollider(CreateSimplifiedCollider(7, Math::Vec2F(7 * 40.0f + 1.0f, 7 * 25.0f), 5.0f));
+
+    EXPECT_EQ(quadTree.proxies[7].node, nodeBefore);
+    EXPECT_EQ(quadTree.proxies[7].collider.aabb.MinBound(), aabbBefore.MinBound());
+    EXPECT_EQ(quadTree.proxies[7].collider.aabb.MaxBound(), aabbBefore.MaxBound());
+    EXPECT_EQ(quadTree.root.subtreeColliderCount, 20);
+}
+
+TEST(QuadTree, UpdateColliderMovesColliderOutOfItsNode)
+{
+    Engine::QuadTree quadTree;
+    quadTree.Init();
+    for (std::size_t i = 0; i < 20; i++)
+    {
+        quadTree.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 40.0f, i * 25.0f), 5.0f));
+    }
+    quadTree.Rebalance();
+
+    quadTree.UpdateCollider(CreateSimplifiedCollider(0, Math::Vec2F(19 * 40.0f, 19 * 25.0f), 5.0f));
+    quadTree.Rebalance();
+
+    const auto& proxy = quadTree.proxies[0];
+    ASSERT_NE(proxy.node, nullptr);
+    EXPECT_TRUE(proxy.node->bounds.Contains(Math::Vec2F(19 * 40.0f, 19 * 25.0f)));
+    const auto nodeBegin = quadTree.colliders.begin() + proxy.node->colliderBegin;
+    const auto nodeEnd = nodeBegin + proxy.node->colliderCount;
+    EXPECT_NE(std::find_if(nodeBegin, nodeEnd, [](const Engine::SimplifedCollider& col)
+    {
+        return col.colliderRef.index == 0;
+    }), nodeEnd);
+    EXPECT_EQ(quadTree.root.subtreeColliderCount, 20);
+}
+
+TEST(QuadTree, RemoveColliderMergesEmptyNodes)
+{
+    Engine::QuadTree quadTree;
+    quadTree.Init();
+    for (std::size_t i = 0; i < 20; i++)
+    {
+        quadTree.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 40.0f, i * 25.0f), 5.0f));
+    }
+    quadTree.Rebalance();
+    EXPECT_NE(quadTree.root.children[0], nullptr);
+
+    for (std::size_t i = 0; i < 19; i++)
+    {
+        quadTree.RemoveCollider(i);
+    }
+    quadTree.Rebalance();
+
+    EXPECT_EQ(quadTree.root.children[0], nullptr);
+    EXPECT_EQ(quadTree.root.subtreeColliderCount, 1);
+    EXPECT_EQ(quadTree.proxies[19].node, &quadTree.root);
+}
+
+TEST(QuadTree, FindPossiblePairsContainsEveryOverlap)
+{
+    Engine::QuadTree quadTree;
+    quadTree.Init();
+
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t step = 0; step < 3; step++)
+    {
+        colliders.clear();
+        for (std::size_t i = 0; i < 100; i++)
+        {
+            const auto position = Math::Vec2F((i * 37 + step * 13) % 800, (i * 53 + step * 7) % 600);
+            colliders.push_back(CreateSimplifiedCollider(i, position, 12.0f));
+            quadTree.UpdateCollider(colliders[i]);
+        }
+        quadTree.Rebalance();
+        quadTree.nodeColliderPairs.clear();
+        quadTree.FindPossiblePairs(quadTree.root);
+
+        for (std::size_t i = 0; i < colliders.size(); i++)
+        {
+            for (std::size_t j = i + 1; j < colliders.size(); j++)
+            {
+                if (!Math::Intersect(colliders[i].aabb, colliders[j].aabb))
+                {
+                    continue;
+                }
+                const Engine::ColliderPair pair{colliders[i].colliderRef, colliders[j].colliderRef};
+                EXPECT_NE(std::find(quadTree.nodeColliderPairs.begin(), quadTree.nodeColliderPairs.end(), pair),
+                          quadTree.nodeColliderPairs.end());
+            }
+        }
+    }
+}
+
+TEST(QuadTree, FindPossiblePairsOnlyReportsOverlaps)
+{
+    Engine::QuadTree quadTree;
+    quadTree.Init();
+
+    for (std::size_t i = 0; i < 200; i++)
+    {
+        const auto position = Math::Vec2F((i * 37) % 800, (i * 53) % 600);
+        quadTree.UpdateCollider(CreateSimplifiedCollider(i, position, i % 40 == 0 ? 150.0f : 12.0f));
+    }
+    quadTree.Rebalance();
+    quadTree.nodeColliderPairs.clear();
+    quadTree.FindPossiblePairs(quadTree.root);
+
+    const auto storedAabb = [&quadTree](std::size_t colliderIndex)
+    {
+        const auto& proxy = quadTree.proxies[colliderIndex];
+        return proxy.collider.aabb;
+    };
+
+    std::size_t overlapCount = 0;
+    for (std::size_t i = 0; i < 200; i++)
+    {
+        for (std::size_t j = i + 1; j < 200; j++)
+        {
+            overlapCount += Math::Intersect(storedAabb(i), storedAabb(j));
+        }
+    }
+    EXPECT_EQ(quadTree.nodeColliderPairs.size(), overlapCount);
+
+    for (const auto& pair: quadTree.nodeColliderPairs)
+    {
+        EXPECT_TRUE(Math::Intersect(storedAabb(pair.colliderA.index), storedAabb(pair.colliderB.index)));
+        EXPECT_EQ(std::count(quadTree.nodeColliderPairs.begin(), quadTree.nodeColliderPairs.end(), pair), 1);
+    }
+}
+
+TEST(QuadTree, NodePoolGrowsWithTheColliders)
+{
+    Engine::QuadTree quadTree;
+    quadTree.maxColliderInNode = 2;
+    quadTree.maxDepth = 16;
+    quadTree.Init();
+
+    // Spread over a world much larger than the window, deep enough to need several node chunks.
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 500; i++)
+    {
+        const auto position = Math::Vec2F(static_cast<float>((i * 7919) % 100000), static_cast<float>((i * 104729) % 50000));
+        colliders.push_back(CreateSimplifiedCollider(i, position, 10.0f));
+        quadTree.UpdateCollider(colliders.back());
+    }
+    quadTree.Rebalance();
+
+    EXPECT_GT(quadTree.AllocatedNodeCount(), Engine::QuadTree::NodeChunkSize);
+    EXPECT_LE(quadTree.NodeCount(), quadTree.AllocatedNodeCount());
+    EXPECT_EQ(quadTree.root.subtreeColliderCount, colliders.size());
+    for (const auto& collider: colliders)
+    {
+        const auto& proxy = quadTree.proxies[collider.colliderRef.index];
+        ASSERT_NE(proxy.node, nullptr);
+        EXPECT_TRUE(Engine::ContainsAABB(quadTree.root.bounds, collider.aabb));
+        EXPECT_TRUE(proxy.node->depth <= quadTree.maxDepth);
+        EXPECT_TRUE(proxy.node->colliderCount <= quadTree.maxColliderInNode || proxy.node->children[0] != nullptr ||
+                    proxy.node->depth == quadTree.maxDepth);
+    }
+
+    // Clearing keeps the chunks for the next steps but empties the tree.
+    const auto allocatedNodeCount = quadTree.AllocatedNodeCount();
+    quadTree.Clear();
+    EXPECT_EQ(quadTree.NodeCount(), 1);
+    EXPECT_EQ(quadTree.AllocatedNodeCount(), allocatedNodeCount);
+}
+
+TEST(QuadTree, FindPossiblePairsDoesNotDependOnWorkerCount)
+{
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 3 * Engine::QuadTree::ParallelColliderThreshold; i++)
+    {
+        const auto position = Math::Vec2F(static_cast<float>((i * 37) % 1600), static_cast<float>((i * 53) % 1200));
+        colliders.push_back(CreateSimplifiedCollider(i, position, 12.0f));
+    }
+
+    std::vector<Engine::ColliderPair> serialPairs;
+    for (const std::size_t workerCount: {1, 3, 8})
+    {
+        Engine::QuadTree quadTree;
+        quadTree.workerCount = workerCount;
+        quadTree.Init();
+        for (const auto& collider: colliders)
+        {
+            quadTree.UpdateCollider(collider);
+        }
+        quadTree.Rebalance();
+        quadTree.FindPossiblePairs(quadTree.root);
+
+        const std::vector<Engine::ColliderPair> pairs(quadTree.nodeColliderPairs.begin(), quadTree.nodeColliderPairs.end());
+        if (workerCount == 1)
+        {
+            serialPairs = pairs;
+            EXPECT_FALSE(serialPairs.empty());
+        }
+        EXPECT_EQ(pairs, serialPairs);
+    }
+}
+
+class RecordingPairCallback final : public Engine::PairCallback
+{
+public:
+    std::vector<Engine::ColliderPair> pairs;
+    std::size_t largestChunk = 0;
+
+    void OnPairs(const Engine::ColliderPair* chunk, std::size_t pairCount) noexcept override
+    {
+        pairs.insert(pairs.end(), chunk, chunk + pairCount);
+        largestChunk = std::max(largestChunk, pairCount);
+    }
+};
+
+TEST(QuadTree, FindPossiblePairsStreamsTheTasksInOrder)
+{
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 3 * Engine::QuadTree::ParallelColliderThreshold; i++)
+    {
+        const auto position = Math::Vec2F(static_cast<float>((i * 37) % 1600), static_cast<float>((i * 53) % 1200));
+        colliders.push_back(CreateSimplifiedCollider(i, position, 12.0f));
+    }
+
+    std::vector<Engine::ColliderPair> serialPairs;
+    for (const std::size_t workerCount: {1, 4})
+    {
+        Engine::QuadTree quadTree;
+        quadTree.workerCount = workerCount;
+        quadTree.Init();
+        for (const auto& collider: colliders)
+        {
+            quadTree.UpdateCollider(collider);
+        }
+        quadTree.Rebalance();
+
+        // More tasks than task buffers, so the buffers are reused within the step.
+        RecordingPairCallback callback;
+        quadTree.FindPossiblePairs(quadTree.root, callback);
+        EXPECT_TRUE(quadTree.nodeColliderPairs.empty());
+        EXPECT_LE(callback.largestChunk, Engine::PairChunkSize);
+        if (workerCount == 1)
+        {
+            serialPairs = callback.pairs;
+            EXPECT_FALSE(serialPairs.empty());
+        }
+        EXPECT_EQ(callback.pairs, serialPairs);
+    }
+}
+
+TEST(QuadTree, WorkersAreStartedOnceAndReusedEveryStep)
+{
+    Engine::QuadTree quadTree;
+    quadTree.workerCount = 4;
     quadTree.Init();
+    EXPECT_EQ(quadTree.StartedWorkerCount(), 3);
 
-    std::size_t maxChildrenPossible = 0;
-    for (int i = 0; i <= quadTree.MaxDepth; i++)
+    std::vector<Engine::ColliderPair> firstPairs;
+    for (std::size_t step = 0; step < 20; step++)
     {
-        maxChildrenPossible += Math::Pow(4, i);
+        // Changing workerCount restarts the workers on the next step only.
+        if (step == 10)
+        {
+            quadTree.workerCount = 2;
+            EXPECT_EQ(quadTree.StartedWorkerCount(), 3);
+        }
+        for (std::size_t i = 0; i < 2 * Engine::QuadTree::ParallelColliderThreshold; i++)
+        {
+            const auto position = Math::Vec2F(static_cast<float>((i * 37) % 1600), static_cast<float>((i * 53) % 1200));
+            quadTree.UpdateCollider(CreateSimplifiedCollider(i, position, 12.0f));
+        }
+        quadTree.Rebalance();
+        quadTree.FindPossiblePairs();
+        EXPECT_EQ(quadTree.StartedWorkerCount(), step < 10 ? 3 : 1);
+
+        const std::vector<Engine::ColliderPair> pairs(quadTree.nodeColliderPairs.begin(), quadTree.nodeColliderPairs.end());
+        if (step == 0)
+        {
+            firstPairs = pairs;
+            EXPECT_FALSE(firstPairs.empty());
+        }
+        EXPECT_EQ(pairs, firstPairs);
     }
+}
+
+TEST(QuadTree, LooseTreeSinksCollidersCrossingNodeCenters)
+{
+    for (const bool isLoose: {false, true})
+    {
+        Engine::QuadTree quadTree;
+        quadTree.isLoose = isLoose;
+        quadTree.Init();
+
+        // Small colliders spread over the world, and one straddling the center of the root.
+        for (std::size_t i = 0; i < 100; i++)
+        {
+            const auto position = Math::Vec2F((i * 37) % 800, (i * 53) % 600);
+            quadTree.UpdateCollider(CreateSimplifiedCollider(i, position, 5.0f));
+        }
+        quadTree.Rebalance();
+        quadTree.UpdateCollider(CreateSimplifiedCollider(100, quadTree.root.bounds.Center(), 20.0f));
 
-    EXPECT_EQ(quadTree.nodes[0].children[0], nullptr);
-    EXPECT_EQ(quadTree.nodeIndex, 1);
-    EXPECT_EQ(quadTree.nodes[0].bounds.MaxBound(), Math::Vec2F(0.0f, 0.0f));
-    EXPECT_EQ(quadTree.nodes[maxChildrenPossible].children[0], nullptr);
-}
\ No newline at end of file
+        const auto* node = quadTree.proxies[100].node;
+        ASSERT_NE(node, nullptr);
+        EXPECT_EQ(node->depth > 0, isLoose);
+        EXPECT_TRUE(Engine::ContainsAABB(quadTree.LooseBounds(*node), quadTree.proxies[100].collider.aabb));
+    }
+}
+
+TEST(QuadTree, LooseTreeFindsEveryOverlapOnce)
+{
+    Engine::QuadTree quadTree;
+    quadTree.Init();
+
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 1500; i++)
+    {
+        const auto position = Math::Vec2F((i * 37) % 800, (i * 53) % 600);
+        colliders.push_back(CreateSimplifiedCollider(i, position, i % 40 == 0 ? 150.0f : 12.0f));
+        quadTree.UpdateCollider(colliders.back());
+    }
+    quadTree.Rebalance();
+
+    // Switching the mode rebuilds the tree with the same colliders.
+    quadTree.isLoose = true;
+    quadTree.Rebalance();
+    EXPECT_EQ(quadTree.root.subtreeColliderCount, colliders.size());
+
+    for (const std::size_t workerCount: {1, 4})
+    {
+        quadTree.workerCount = workerCount;
+        quadTree.nodeColliderPairs.clear();
+        quadTree.FindPossiblePairs(quadTree.root);
+
+        const auto storedAabb = [&quadTree](std::size_t colliderIndex)
+        {
+            const auto& proxy = quadTree.proxies[colliderIndex];
+            return proxy.collider.aabb;
+        };
+
+        std::vector<std::pair<std::size_t, std::size_t>> expectedPairs;
+        for (std::size_t i = 0; i < colliders.size(); i++)
+        {
+            for (std::size_t j = i + 1; j < colliders.size(); j++)
+            {
+                if (Math::Intersect(storedAabb(i), storedAabb(j)))
+                {
+                    expectedPairs.emplace_back(i, j);
+                }
+            }
+        }
+
+        std::vector<std::pair<std::size_t, std::size_t>> pairs;
+        for (const auto& pair: quadTree.nodeColliderPairs)
+        {
+            pairs.emplace_back(std::min(pair.colliderA.index, pair.colliderB.index),
+                               std::max(pair.colliderA.index, pair.colliderB.index));
+        }
+        std::sort(pairs.begin(), pairs.end());
+        EXPECT_EQ(pairs, expectedPairs);
+    }
+}
+
+TEST(QuadTree, SubdivideStoresTheChildBoundsOfTheParent)
+{
+    for (const bool isLoose: {false, true})
+    {
+        Engine::QuadTree quadTree;
+        quadTree.isLoose = isLoose;
+        quadTree.Init();
+
+        for (std::size_t i = 0; i < 200; i++)
+        {
+            const auto position = Math::Vec2F((i * 37) % 800, (i * 53) % 600);
+            quadTree.UpdateCollider(CreateSimplifiedCollider(i, position, 5.0f));
+        }
+        quadTree.Rebalance();
+
+        const auto& root = quadTree.root;
+        ASSERT_NE(root.children[0], nullptr);
+        const auto& child = *root.children[0];
+        ASSERT_NE(child.children[0], nullptr);
+        for (const auto* node: {&root, &child})
+        {
+            for (std::size_t i = 0; i < node->children.size(); i++)
+            {
+                const auto childBounds = quadTree.LooseBounds(*node->children[i]);
+                EXPECT_EQ(node->childMinX[i], childBounds.MinBound().X);
+                EXPECT_EQ(node->childMinY[i], childBounds.MinBound().Y);
+                EXPECT_EQ(node->childMaxX[i], childBounds.MaxBound().X);
+                EXPECT_EQ(node->childMaxY[i], childBounds.MaxBound().Y);
+            }
+        }
+
+        // The queries classify the children with the stored bounds, they must find what a brute force finds.
+        const Math::RectangleF queryAabb(Math::Vec2F(150.0f, 120.0f), Math::Vec2F(420.0f, 330.0f));
+        struct : Engine::QueryCallback
+        {
+            std::vector<std::size_t> found;
+
+            void OnColliderFound(std::size_t, Engine::ColliderRef colliderRef) noexcept override
+            {
+                found.push_back(colliderRef.index);
+            }
+        } callback;
+        quadTree.QueryAABB(queryAabb, 0, callback);
+
+        std::vector<std::size_t> expected;
+        for (std::size_t i = 0; i < 200; i++)
+        {
+            const auto& proxy = quadTree.proxies[i];
+            if (Math::Intersect(proxy.collider.aabb, queryAabb))
+            {
+                expected.push_back(i);
+            }
+        }
+        std::sort(callback.found.begin(), callback.found.end());
+        EXPECT_EQ(callback.found, expected);
+    }
+}
+
+static void ExpectNodeRanges(const Engine::QuadTree& quadTree, const Engine::QuadNode& node, std::uint32_t& offset)
+{
+    EXPECT_EQ(node.colliderBegin, offset);
+    for (auto i = node.colliderBegin; i < node.colliderBegin + node.colliderCount; i++)
+    {
+        EXPECT_EQ(quadTree.proxies[quadTree.colliders[i].colliderRef.index].node, &node);
+    }
+    offset += node.colliderCount;
+
+    if (node.children[0] != nullptr)
+    {
+        for (const auto* child: node.children)
+        {
+            ExpectNodeRanges(quadTree, *child, offset);
+        }
+    }
+    EXPECT_EQ(offset - node.colliderBegin, node.subtreeColliderCount);
+}
+
+TEST(QuadTree, CollidersAreLaidOutByNodeInDepthFirstOrder)
+{
+    Engine::QuadTree quadTree;
+    quadTree.Init();
+
+    for (std::size_t step = 0; step < 3; step++)
+    {
+        for (std::size_t i = 0; i < 300; i++)
+        {
+            // Some colliders leave their node on each step and a few are removed.
+            const auto position = Math::Vec2F((i * 37 + step * i) % 800, (i * 53 + step * 11) % 600);
+            if (step == 2 && i % 5 == 0)
+            {
+                quadTree.RemoveCollider(i);
+                continue;
+            }
+            quadTree.UpdateCollider(CreateSimplifiedCollider(i, position, i % 50 == 0 ? 100.0f : 8.0f));
+        }
+        quadTree.Rebalance();
+
+        std::uint32_t offset = 0;
+        ExpectNodeRanges(quadTree, quadTree.root, offset);
+        EXPECT_EQ(offset, quadTree.colliders.size());
+        EXPECT_EQ(quadTree.colliders.size(), step == 2 ? 240 : 300);
+    }
+}
@@ -0,0 +1,111 @@
+#include "RayCast.h"
+#include "gtest/gtest.h"
+#include <array>
+#include <vector>
+
+static Engine::RayPacket CreatePacket(const std::vector<Engine::Ray>& rays)
+{
+    Engine::RayPacket packet;
+    packet.Load(rays.data(), 0, rays.size());
+    return packet;
+}
+
+TEST(RayCast, LoadMasksTheEmptyLanes)
+{
+    const std::vector<Engine::Ray> rays{
+            Engine::Ray{Math::Vec2F(1.0f, 2.0f), Math::Vec2F(4.0f, 0.0f), 0.5f},
+            Engine::Ray{Math::Vec2F(0.0f, 0.0f), Math::Vec2F(0.0f, -2.0f), 0.0f},
+            Engine::Ray{Math::Vec2F(3.0f, 3.0f), Math::Vec2F(1.0f, 1.0f), 0.0f}
+    };
+
+    Engine::RayPacket packet;
+    packet.Load(rays.data(), 1, rays.size());
+    EXPECT_EQ(packet.firstRayIndex, 1);
+    EXPECT_EQ(packet.laneMask, 0b11u);
+    EXPECT_FLOAT_EQ(packet.inverseY[0], -0.5f);
+    EXPECT_FLOAT_EQ(packet.maxFraction[1], 1.0f);
+}
+
+TEST(RayCast, RaySlabMask8)
+{
+    const Math::RectangleF aabb(Math::Vec2F(0.0f, 0.0f), Math::Vec2F(10.0f, 10.0f));
+    auto packet = CreatePacket({
+            // Crossing, stopping short, starting inside, parallel outside, parallel inside.
+            Engine::Ray{Math::Vec2F(-5.0f, 5.0f), Math::Vec2F(10.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(-5.0f, 5.0f), Math::Vec2F(4.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(5.0f, 5.0f), Math::Vec2F(1.0f, 1.0f)},
+            Engine::Ray{Math::Vec2F(-5.0f, 12.0f), Math::Vec2F(30.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(5.0f, -5.0f), Math::Vec2F(0.0f, 30.0f)},
+            // Passing beside the AABB, reaching it only with a radius, and pointing away.
+            Engine::Ray{Math::Vec2F(-5.0f, 15.0f), Math::Vec2F(10.0f, -2.0f)},
+            Engine::Ray{Math::Vec2F(-5.0f, 15.0f), Math::Vec2F(10.0f, -2.0f), 4.0f},
+            Engine::Ray{Math::Vec2F(-5.0f, 5.0f), Math::Vec2F(-10.0f, 0.0f)}
+    });
+    EXPECT_EQ(Engine::RaySlabMask8(aabb, packet), 0b01010101u);
+
+    // The first lane already hit something before the AABB.
+    packet.maxFraction[0] = 0.4f;
+    EXPECT_EQ(Engine::RaySlabMask8(aabb, packet), 0b01010100u);
+}
+
+TEST(RayCast, RayCastCircle8)
+{
+    const auto packet = CreatePacket({
+            Engine::Ray{Math::Vec2F(-10.0f, 0.0f), Math::Vec2F(20.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(-10.0f, 0.0f), Math::Vec2F(20.0f, 0.0f), 1.0f},
+            Engine::Ray{Math::Vec2F(-10.0f, 0.0f), Math::Vec2F(5.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(0.5f, 0.0f), Math::Vec2F(20.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(-10.0f, 3.0f), Math::Vec2F(20.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(-10.0f, 0.0f), Math::Vec2F(0.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(0.0f, 10.0f), Math::Vec2F(0.0f, -20.0f)},
+            Engine::Ray{Math::Vec2F(10.0f, 0.0f), Math::Vec2F(20.0f, 0.0f)}
+    });
+
+    std::array<float, Engine::RayPacket::Size> fractions{};
+    EXPECT_EQ(Engine::RayCastCircle8(packet, Math::Vec2F(0.0f, 0.0f), 2.0f, fractions.data()), 0b01000011u);
+    EXPECT_FLOAT_EQ(fractions[0], 0.4f);
+    EXPECT_FLOAT_EQ(fractions[1], 0.35f);
+    EXPECT_FLOAT_EQ(fractions[6], 0.4f);
+
+    const auto hit = Engine::CircleHit(Engine::Ray{Math::Vec2F(-10.0f, 0.0f), Math::Vec2F(20.0f, 0.0f), 1.0f},
+                                       Math::Vec2F(0.0f, 0.0f), 2.0f, fractions[1]);
+    EXPECT_TRUE(hit.hasHit);
+    EXPECT_NEAR(hit.point.X, -2.0f, 1e-5f);
+    EXPECT_NEAR(hit.normal.X, -1.0f, 1e-5f);
+    EXPECT_NEAR(hit.normal.Y, 0.0f, 1e-5f);
+}
+
+TEST(RayCast, RayCastRectangle8)
+{
+    const Math::RectangleF rectangle(Math::Vec2F(0.0f, 0.0f), Math::Vec2F(10.0f, 10.0f));
+    const auto packet = CreatePacket({
+            Engine::Ray{Math::Vec2F(-5.0f, 5.0f), Math::Vec2F(20.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(-5.0f, 5.0f), Math::Vec2F(20.0f, 0.0f), 1.0f},
+            // A cast circle entering the enlarged rectangle in a corner, hitting then missing the rounded corner.
+            Engine::Ray{Math::Vec2F(-5.0f, -5.0f), Math::Vec2F(10.0f, 10.0f), 1.0f},
+            Engine::Ray{Math::Vec2F(-3.0f, 1.5f), Math::Vec2F(4.0f, -4.0f), 1.0f},
+            Engine::Ray{Math::Vec2F(5.0f, 5.0f), Math::Vec2F(20.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(5.0f, 20.0f), Math::Vec2F(0.0f, -40.0f)},
+            Engine::Ray{Math::Vec2F(-5.0f, 11.0f), Math::Vec2F(20.0f, 0.0f)},
+            Engine::Ray{Math::Vec2F(-5.0f, 5.0f), Math::Vec2F(4.0f, 0.0f)}
+    });
+
+    std::array<float, Engine::RayPacket::Size> fractions{};
+    EXPECT_EQ(Engine::RayCastRectangle8(packet, rectangle, fractions.data()), 0b00100111u);
+    EXPECT_FLOAT_EQ(fractions[0], 0.25f);
+    EXPECT_FLOAT_EQ(fractions[1], 0.2f);
+    EXPECT_NEAR(fractions[2], (std::sqrt(50.0f) - 1.0f) / std::sqrt(200.0f), 1e-5f);
+    EXPECT_FLOAT_EQ(fractions[5], 0.25f);
+
+    const auto faceHit = Engine::RectangleHit(Engine::Ray{Math::Vec2F(-5.0f, 5.0f), Math::Vec2F(20.0f, 0.0f)},
+                                              rectangle, fractions[0]);
+    EXPECT_EQ(faceHit.normal, Math::Vec2F(-1.0f, 0.0f));
+    EXPECT_NEAR(faceHit.point.X, 0.0f, 1e-5f);
+    EXPECT_NEAR(faceHit.point.Y, 5.0f, 1e-5f);
+
+    const auto cornerHit = Engine::RectangleHit(Engine::Ray{Math::Vec2F(-5.0f, -5.0f), Math::Vec2F(10.0f, 10.0f), 1.0f},
+                                                rectangle, fractions[2]);
+    EXPECT_EQ(cornerHit.point, Math::Vec2F(0.0f, 0.0f));
+    EXPECT_NEAR(cornerHit.normal.X, -std::sqrt(0.5f), 1e-4f);
+    EXPECT_NEAR(cornerHit.normal.Y, -std::sqrt(0.5f), 1e-4f);
+}
@@ -0,0 +1,91 @@
+#include "SpatialHashGrid.h"
+#include "BroadPhaseTestUtils.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <vector>
+
+TEST(SpatialHashGrid, ConstructorDefault)
+{
+    Engine::SpatialHashGrid spatialHashGrid;
+    EXPECT_TRUE(spatialHashGrid.proxies.empty());
+    EXPECT_TRUE(spatialHashGrid.entries.empty());
+    EXPECT_TRUE(spatialHashGrid.colliderPairs.empty());
+}
+
+TEST(SpatialHashGrid, CellSizeFollowsColliderSizes)
+{
+    Engine::SpatialHashGrid spatialHashGrid;
+    spatialHashGrid.Init();
+    for (std::size_t i = 0; i < 100; i++)
+    {
+        // A single large collider must not make the cells large.
+        const auto halfSize = i == 0 ? Math::Vec2F(400.0f, 400.0f) : Math::Vec2F(12.0f, 12.0f);
+        spatialHashGrid.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 30.0f, 0.0f), halfSize));
+    }
+    spatialHashGrid.FindPossiblePairs();
+
+    EXPECT_FLOAT_EQ(spatialHashGrid.cellSize, 24.0f);
+    EXPECT_EQ(spatialHashGrid.bucketStarts.back(), spatialHashGrid.entries.size());
+}
+
+TEST(SpatialHashGrid, FindPossiblePairsReportsEachOverlapOnce)
+{
+    Engine::SpatialHashGrid spatialHashGrid;
+    spatialHashGrid.Init();
+
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 300; i++)
+    {
+        // Mix same size colliders with a few long ones spanning many cells.
+        const auto halfSize = i % 50 == 0 ? Math::Vec2F(200.0f, 15.0f) : Math::Vec2F(12.0f, 12.0f);
+        colliders.push_back(CreateSimplifiedCollider(i, Math::Vec2F((i * 37) % 800, (i * 53) % 600), halfSize));
+        spatialHashGrid.UpdateCollider(colliders.back());
+    }
+    spatialHashGrid.FindPossiblePairs();
+
+    CheckPairsMatchOverlaps(spatialHashGrid, colliders);
+}
+
+TEST(SpatialHashGrid, FindPossiblePairsWithNegativeCoordinates)
+{
+    Engine::SpatialHashGrid spatialHashGrid;
+    spatialHashGrid.Init();
+
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 100; i++)
+    {
+        const auto center = Math::Vec2F(static_cast<float>(i % 10) * 15.0f - 75.0f,
+                                        static_cast<float>(i / 10) * 15.0f - 75.0f);
+        colliders.push_back(CreateSimplifiedCollider(i, center, Math::Vec2F(8.0f, 8.0f)));
+        spatialHashGrid.UpdateCollider(colliders.back());
+    }
+    spatialHashGrid.FindPossiblePairs();
+
+    CheckPairsMatchOverlaps(spatialHashGrid, colliders);
+}
+
+TEST(SpatialHashGrid, RemoveCollider)
+{
+    Engine::SpatialHashGrid spatialHashGrid;
+    spatialHashGrid.Init();
+
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        spatialHashGrid.UpdateCollider(CreateSimplifiedCollider(i, Math::Vec2F(i * 8.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)));
+    }
+    spatialHashGrid.FindPossiblePairs();
+    EXPECT_EQ(spatialHashGrid.colliderPairs.size(), 9);
+
+    spatialHashGrid.RemoveCollider(4);
+    spatialHashGrid.FindPossiblePairs();
+    EXPECT_FALSE(spatialHashGrid.proxies[4].isActive);
+    EXPECT_EQ(spatialHashGrid.colliderPairs.size(), 7);
+
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        spatialHashGrid.RemoveCollider(i);
+    }
+    spatialHashGrid.FindPossiblePairs();
+    EXPECT_TRUE(spatialHashGrid.colliderPairs.empty());
+    EXPECT_TRUE(spatialHashGrid.entries.empty());
+}
@@ -0,0 +1,117 @@
+#include "SweepAndPrune.h"
+#include "BroadPhaseTestUtils.h"
+#include "gtest/gtest.h"
+#include <algorithm>
+#include <vector>
+
+static void CheckEndpointsSorted(const AllocatedVector<Engine::SweepEndpoint>& endpoints)
+{
+    for (std::size_t i = 1; i < endpoints.size(); i++)
+    {
+        EXPECT_LE(endpoints[i - 1].value, endpoints[i].value);
+    }
+}
+
+TEST(SweepAndPrune, ConstructorDefault)
+{
+    Engine::SweepAndPrune sweepAndPrune;
+    EXPECT_TRUE(sweepAndPrune.proxies.empty());
+    EXPECT_TRUE(sweepAndPrune.endpointsX.empty());
+    EXPECT_TRUE(sweepAndPrune.endpointsY.empty());
+    EXPECT_TRUE(sweepAndPrune.colliderPairs.empty());
+}
+
+TEST(SweepAndPrune, UpdateColliderAddsEndpoints)
+{
+    Engine::SweepAndPrune sweepAndPrune;
+    sweepAndPrune.Init();
+    sweepAndPrune.UpdateCollider(CreateSimplifiedCollider(3, Math::Vec2F(10.0f, 10.0f), Math::Vec2F(5.0f, 5.0f)));
+    EXPECT_EQ(sweepAndPrune.proxies.size(), 4);
+    EXPECT_TRUE(sweepAndPrune.proxies[3].isActive);
+    EXPECT_EQ(sweepAndPrune.endpointsX.size(), 2);
+    EXPECT_EQ(sweepAndPrune.endpointsY.size(), 2);
+
+    // Updating a collider already registered only moves its endpoints.
+    sweepAndPrune.UpdateCollider(CreateSimplifiedCollider(3, Math::Vec2F(20.0f, 10.0f), Math::Vec2F(5.0f, 5.0f)));
+    EXPECT_EQ(sweepAndPrune.endpointsX.size(), 2);
+}
+
+TEST(SweepAndPrune, FindPossiblePairsReportsOnlyOverlaps)
+{
+    Engine::SweepAndPrune sweepAndPrune;
+    sweepAndPrune.Init();
+
+    // Colliders 0 and 1 overlap on X only, 0 and 2 on both axes, 3 touches 2.
+    std::vector<Engine::SimplifedCollider> colliders{
+            CreateSimplifiedCollider(0, Math::Vec2F(0.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)),
+            CreateSimplifiedCollider(1, Math::Vec2F(2.0f, 50.0f), Math::Vec2F(5.0f, 5.0f)),
+            CreateSimplifiedCollider(2, Math::Vec2F(6.0f, 6.0f), Math::Vec2F(5.0f, 5.0f)),
+            CreateSimplifiedCollider(3, Math::Vec2F(16.0f, 6.0f), Math::Vec2F(5.0f, 5.0f))
+    };
+    for (const auto& collider: colliders)
+    {
+        sweepAndPrune.UpdateCollider(collider);
+    }
+    sweepAndPrune.FindPossiblePairs();
+
+    CheckPairsMatchOverlaps(sweepAndPrune, colliders);
+    EXPECT_EQ(sweepAndPrune.colliderPairs.size(), 2);
+}
+
+TEST(SweepAndPrune, FindPossiblePairsFollowsMovingColliders)
+{
+    Engine::SweepAndPrune sweepAndPrune;
+    sweepAndPrune.Init();
+
+    std::vector<Engine::SimplifedCollider> colliders;
+    std::vector<Math::Vec2F> velocities;
+    for (std::size_t i = 0; i < 200; i++)
+    {
+        const auto halfSize = i % 25 == 0 ? Math::Vec2F(150.0f, 10.0f) : Math::Vec2F(12.0f, 12.0f);
+        colliders.push_back(CreateSimplifiedCollider(i, Math::Vec2F((i * 37) % 800, (i * 53) % 600), halfSize));
+        velocities.emplace_back(static_cast<float>(i % 7) - 3.0f, static_cast<float>(i % 5) - 2.0f);
+    }
+
+    for (int step = 0; step < 20; step++)
+    {
+        for (std::size_t i = 0; i < colliders.size(); i++)
+        {
+            const auto& aabb = colliders[i].aabb;
+            colliders[i].aabb = Math::RectangleF(aabb.MinBound() + velocities[i], aabb.MaxBound() + velocities[i]);
+            sweepAndPrune.UpdateCollider(colliders[i]);
+        }
+        sweepAndPrune.FindPossiblePairs();
+
+        CheckEndpointsSorted(sweepAndPrune.endpointsX);
+        CheckEndpointsSorted(sweepAndPrune.endpointsY);
+        CheckPairsMatchOverlaps(sweepAndPrune, colliders);
+    }
+}
+
+TEST(SweepAndPrune, RemoveCollider)
+{
+    Engine::SweepAndPrune sweepAndPrune;
+    sweepAndPrune.Init();
+
+    std::vector<Engine::SimplifedCollider> colliders;
+    for (std::size_t i = 0; i < 10; i++)
+    {
+        colliders.push_back(CreateSimplifiedCollider(i, Math::Vec2F(i * 8.0f, 0.0f), Math::Vec2F(5.0f, 5.0f)));
+        sweepAndPrune.UpdateCollider(colliders.back());
+    }
+    sweepAndPrune.FindPossiblePairs();
+    EXPECT_EQ(sweepAndPrune.colliderPairs.size(), 9);
+
+    sweepAndPrune.RemoveCollider(4);
+    sweepAndPrune.RemoveCollider(5);
+    sweepAndPrune.FindPossiblePairs();
+    EXPECT_FALSE(sweepAndPrune.proxies[4].isActive);
+    EXPECT_EQ(sweepAndPrune.endpointsX.size(), 16);
+    EXPECT_EQ(sweepAndPrune.colliderPairs.size(), 6);
+
+    // A removed collider can be registered again.
+    sweepAndPrune.UpdateCollider(colliders[4]);
+    sweepAndPrune.FindPossiblePairs();
+    EXPECT_EQ(sweepAndPrune.endpointsX.size(), 18);
+    EXPECT_EQ(sweepAndPrune.colliderPairs.size(), 7);
+}
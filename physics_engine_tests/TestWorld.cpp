@@ -1,6 +1,8 @@
 #include "World.h"
 #include "gtest/gtest.h"
+#include <algorithm>
 #include <array>
+#include <vector>
 
 struct WorldFixture : public ::testing::TestWithParam<float>
 {
@@ -108,3 +110,731 @@ TEST(World, IsContact)
     EXPECT_TRUE(world.IsContact(colliderA, colliderD));
 }
 
+
+class CountingContactListener : public Engine::ContactListener
+{
+public:
+    std::size_t collisionEnterCount = 0;
+
+    void OnTriggerEnter(Engine::Collider, Engine::Collider) noexcept override
+    {}
+
+    void OnTriggerExit(Engine::Collider, Engine::Collider) noexcept override
+    {}
+
+    void OnCollisionEnter(Engine::Collider, Engine::Collider) noexcept override
+    {
+        collisionEnterCount++;
+    }
+
+    void OnCollisionExit(Engine::Collider, Engine::Collider) noexcept override
+    {}
+};
+
+TEST(World, StaticCollidersAreOnlyPairedWithDynamicColliders)
+{
+    for (const auto broadPhaseType: {Engine::BroadPhaseType::QUAD_TREE, Engine::BroadPhaseType::AABB_TREE,
+                                     Engine::BroadPhaseType::SWEEP_AND_PRUNE, Engine::BroadPhaseType::SPATIAL_HASH_GRID,
+                                     Engine::BroadPhaseType::LINEAR_QUAD_TREE, Engine::BroadPhaseType::KD_TREE})
+    {
+        Engine::World world;
+        CountingContactListener contactListener;
+        world.contactListener = &contactListener;
+        world.broadPhaseType = broadPhaseType;
+        world.Init();
+
+        // Rows of touching static tiles, none of them must be paired with another tile.
+        for (int i = 0; i < 100; i++)
+        {
+            const auto bodyRef = world.CreateBody();
+            auto& body = world.GetBody(bodyRef);
+            body.SetMass(1);
+            body.type = Engine::BodyType::STATIC;
+            body.SetPosition(Math::Vec2F(static_cast<float>(i % 20) * 10.0f, static_cast<float>(i / 20) * 10.0f));
+
+            auto& collider = world.GetCollider(world.CreateCollider(bodyRef));
+            collider._shape = Math::ShapeType::Rectangle;
+            collider.rectangleShape = Math::RectangleF(body.Position(), body.Position() + Math::Vec2F(10.0f, 10.0f));
+        }
+
+        // Three circles each resting on a single tile of the top row, and one far away.
+        for (const auto position: {Math::Vec2F(15.0f, 52.0f), Math::Vec2F(55.0f, 52.0f), Math::Vec2F(95.0f, 52.0f),
+                                   Math::Vec2F(500.0f, 500.0f)})
+        {
+            const auto bodyRef = world.CreateBody();
+            auto& body = world.GetBody(bodyRef);
+            body.SetMass(1);
+            body.SetPosition(position);
+
+            auto& collider = world.GetCollider(world.CreateCollider(bodyRef));
+            collider._shape = Math::ShapeType::Circle;
+            collider.circleShape = Math::CircleF(position, 4.0f);
+        }
+
+        world.ResolveBroadPhase();
+        world.ResolveNarrowPhase();
+        EXPECT_EQ(contactListener.collisionEnterCount, 3);
+        EXPECT_TRUE(world.staticTree.HasCollider(0));
+        EXPECT_EQ(world.staticTree.Height() > 0, true);
+    }
+}
+
+TEST(World, FilteredPairsNeverReachTheNarrowPhase)
+{
+    for (const auto broadPhaseType: {Engine::BroadPhaseType::QUAD_TREE, Engine::BroadPhaseType::AABB_TREE,
+                                     Engine::BroadPhaseType::SWEEP_AND_PRUNE, Engine::BroadPhaseType::SPATIAL_HASH_GRID,
+                                     Engine::BroadPhaseType::LINEAR_QUAD_TREE, Engine::BroadPhaseType::KD_TREE})
+    {
+        Engine::World world;
+        CountingContactListener contactListener;
+        world.contactListener = &contactListener;
+        world.broadPhaseType = broadPhaseType;
+        world.Init();
+
+        const auto createCircle = [&world](Math::Vec2F position, Engine::BodyType bodyType,
+                                           const Engine::CollisionFilter& filter)
+        {
+            const auto bodyRef = world.CreateBody();
+            auto& body = world.GetBody(bodyRef);
+            body.SetMass(1);
+            body.type = bodyType;
+            body.SetPosition(position);
+
+            auto& collider = world.GetCollider(world.CreateCollider(bodyRef));
+            collider._shape = Math::ShapeType::Circle;
+            collider.circleShape = Math::CircleF(position, 5.0f);
+            collider.filter = filter;
+        };
+
+        // Ten bullets overlapping each other and a target, above a static floor that ignores the bullets.
+        const Engine::CollisionFilter bullet{0b10u, ~0b10u, 0};
+        for (int i = 0; i < 10; i++)
+        {
+            createCircle(Math::Vec2F(100.0f + static_cast<float>(i) * 0.5f, 100.0f), Engine::BodyType::DYNAMIC, bullet);
+        }
+        createCircle(Math::Vec2F(103.0f, 103.0f), Engine::BodyType::DYNAMIC, Engine::CollisionFilter{});
+        createCircle(Math::Vec2F(103.0f, 110.0f), Engine::BodyType::STATIC, Engine::CollisionFilter{0b100u, ~0b10u, 0});
+
+        // Two overlapping parts of the same negative group.
+        createCircle(Math::Vec2F(300.0f, 300.0f), Engine::BodyType::DYNAMIC, Engine::CollisionFilter{0b1u, ~0u, -5});
+        createCircle(Math::Vec2F(302.0f, 300.0f), Engine::BodyType::DYNAMIC, Engine::CollisionFilter{0b1u, ~0u, -5});
+
+        world.ResolveBroadPhase();
+        world.ResolveNarrowPhase();
+        EXPECT_EQ(contactListener.collisionEnterCount, 11);
+    }
+}
+
+class GatheringQueryCallback : public Engine::QueryCallback
+{
+public:
+    std::vector<std::pair<std::size_t, std::size_t>> results;
+
+    void OnColliderFound(std::size_t queryIndex, Engine::ColliderRef colliderRef) noexcept override
+    {
+        results.emplace_back(queryIndex, colliderRef.index);
+    }
+};
+
+TEST(World, QueryAABBAndPointMatchTheColliders)
+{
+    for (const auto broadPhaseType: {Engine::BroadPhaseType::QUAD_TREE, Engine::BroadPhaseType::AABB_TREE,
+                                     Engine::BroadPhaseType::SWEEP_AND_PRUNE, Engine::BroadPhaseType::SPATIAL_HASH_GRID,
+                                     Engine::BroadPhaseType::LINEAR_QUAD_TREE, Engine::BroadPhaseType::KD_TREE})
+    {
+        Engine::World world;
+        world.broadPhaseType = broadPhaseType;
+        world.Init();
+
+        // Circles spread over the world, with a few static rectangles.
+        std::vector<Engine::ColliderRef> colliderRefs;
+        for (std::size_t i = 0; i < 300; i++)
+        {
+            const auto bodyRef = world.CreateBody();
+            auto& body = world.GetBody(bodyRef);
+            body.SetMass(1);
+            body.SetPosition(Math::Vec2F(static_cast<float>((i * 37) % 800), static_cast<float>((i * 53) % 600)));
+
+            colliderRefs.push_back(world.CreateCollider(bodyRef));
+            auto& collider = world.GetCollider(colliderRefs.back());
+            if (i % 30 == 0)
+            {
+                body.type = Engine::BodyType::STATIC;
+                collider._shape = Math::ShapeType::Rectangle;
+                collider.rectangleShape = Math::RectangleF(body.Position(), body.Position() + Math::Vec2F(80.0f, 20.0f));
+            }
+            else
+            {
+                collider._shape = Math::ShapeType::Circle;
+                collider.circleShape = Math::CircleF(body.Position(), 10.0f);
+            }
+        }
+        world.ResolveBroadPhase();
+
+        std::vector<Math::RectangleF> queries;
+        std::vector<Math::Vec2F> points;
+        for (std::size_t i = 0; i < 50; i++)
+        {
+            const auto center = Math::Vec2F(static_cast<float>((i * 71) % 800), static_cast<float>((i * 29) % 600));
+            queries.push_back(Math::RectangleF::FromCenter(center, Math::Vec2F(30.0f + i, 15.0f)));
+            points.push_back(center);
+        }
+
+        GatheringQueryCallback batchAabbCallback;
+        world.QueryAABBs(queries.data(), queries.size(), batchAabbCallback);
+        GatheringQueryCallback batchPointCallback;
+        world.QueryPoints(points.data(), points.size(), batchPointCallback);
+
+        for (std::size_t queryIndex = 0; queryIndex < queries.size(); queryIndex++)
+        {
+            std::vector<std::size_t> expectedAabb, expectedPoint;
+            for (const auto& colliderRef: colliderRefs)
+            {
+                const auto& collider = world.GetCollider(colliderRef);
+                const auto aabb = collider._shape == Math::ShapeType::Circle ?
+                                  Math::RectangleF::FromCenter(collider.circleShape.Center(), Math::Vec2F(10.0f, 10.0f)) :
+                                  collider.rectangleShape;
+                if (Math::Intersect(aabb, queries[queryIndex]))
+                {
+                    expectedAabb.push_back(colliderRef.index);
+                }
+                const bool containsPoint = collider._shape == Math::ShapeType::Circle ?
+                                           collider.circleShape.Contains(points[queryIndex]) :
+                                           collider.rectangleShape.Contains(points[queryIndex]);
+                if (containsPoint)
+                {
+                    expectedPoint.push_back(colliderRef.index);
+                }
+            }
+
+            std::array<Engine::ColliderRef, 64> buffer{};
+            const auto count = world.QueryAABB(queries[queryIndex], buffer.data(), buffer.size());
+            ASSERT_LE(count, buffer.size());
+            std::vector<std::size_t> found;
+            for (std::size_t i = 0; i < count; i++)
+            {
+                found.push_back(buffer[i].index);
+            }
+            std::sort(found.begin(), found.end());
+            EXPECT_EQ(found, expectedAabb);
+
+            found.clear();
+            for (const auto& [index, colliderIndex]: batchAabbCallback.results)
+            {
+                if (index == queryIndex)
+                {
+                    found.push_back(colliderIndex);
+                }
+            }
+            std::sort(found.begin(), found.end());
+            EXPECT_EQ(found, expectedAabb);
+
+            const auto pointCount = world.QueryPoint(points[queryIndex], buffer.data(), buffer.size());
+            found.clear();
+            for (std::size_t i = 0; i < pointCount; i++)
+            {
+                found.push_back(buffer[i].index);
+            }
+            std::sort(found.begin(), found.end());
+            EXPECT_EQ(found, expectedPoint);
+
+            found.clear();
+            for (const auto& [index, colliderIndex]: batchPointCallback.results)
+            {
+                if (index == queryIndex)
+                {
+                    found.push_back(colliderIndex);
+                }
+            }
+            std::sort(found.begin(), found.end());
+            EXPECT_EQ(found, expectedPoint);
+        }
+
+        // The buffer only receives the colliders that fit, the count includes the others.
+        const auto allCount = world.QueryAABB(Math::RectangleF(Math::Vec2F(-100.0f, -100.0f), Math::Vec2F(900.0f, 700.0f)),
+                                              nullptr, 0);
+        EXPECT_EQ(allCount, colliderRefs.size());
+    }
+}
+
+TEST(World, RayCastsFindTheClosestCollider)
+{
+    for (const auto broadPhaseType: {Engine::BroadPhaseType::QUAD_TREE, Engine::BroadPhaseType::AABB_TREE,
+                                     Engine::BroadPhaseType::SWEEP_AND_PRUNE, Engine::BroadPhaseType::SPATIAL_HASH_GRID,
+                                     Engine::BroadPhaseType::LINEAR_QUAD_TREE, Engine::BroadPhaseType::KD_TREE})
+    {
+        Engine::World world;
+        world.broadPhaseType = broadPhaseType;
+        world.Init();
+
+        std::vector<Engine::ColliderRef> colliderRefs;
+        for (std::size_t i = 0; i < 300; i++)
+        {
+            const auto bodyRef = world.CreateBody();
+            auto& body = world.GetBody(bodyRef);
+            body.SetMass(1);
+            body.SetPosition(Math::Vec2F(static_cast<float>((i * 37) % 800), static_cast<float>((i * 53) % 600)));
+
+            colliderRefs.push_back(world.CreateCollider(bodyRef));
+            auto& collider = world.GetCollider(colliderRefs.back());
+            if (i % 30 == 0)
+            {
+                body.type = Engine::BodyType::STATIC;
+                collider._shape = Math::ShapeType::Rectangle;
+                collider.rectangleShape = Math::RectangleF(body.Position(), body.Position() + Math::Vec2F(80.0f, 20.0f));
+            }
+            else
+            {
+                collider._shape = Math::ShapeType::Circle;
+                collider.circleShape = Math::CircleF(body.Position(), 6.0f);
+            }
+        }
+        world.ResolveBroadPhase();
+
+        // Rays and cast circles in every direction, a batch that does not fill its last packet.
+        std::vector<Engine::Ray> rays;
+        for (std::size_t i = 0; i < 61; i++)
+        {
+            const auto origin = Math::Vec2F(static_cast<float>((i * 71) % 800), static_cast<float>((i * 29) % 600));
+            const auto translation = Math::Vec2F(static_cast<float>(i * 13 % 400) - 200.0f,
+                                                 static_cast<float>(i * 7 % 300) - 150.0f);
+            rays.push_back(Engine::Ray{origin, translation, i % 3 == 0 ? 5.0f : 0.0f});
+        }
+        rays.push_back(Engine::Ray{Math::Vec2F(-50.0f, 300.0f), Math::Vec2F(10.0f, 0.0f), 0.0f});
+
+        std::vector<Engine::RayCastHit> hits(rays.size());
+        world.RayCasts(rays.data(), rays.size(), hits.data());
+
+        for (std::size_t rayIndex = 0; rayIndex < rays.size(); rayIndex++)
+        {
+            // Every collider is tested against the ray alone.
+            Engine::RayPacket packet;
+            packet.Load(&rays[rayIndex], 0, 1);
+            bool hasHit = false;
+            float closestFraction = 1.0f;
+            for (const auto& colliderRef: colliderRefs)
+            {
+                const auto& collider = world.GetCollider(colliderRef);
+                std::array<float, Engine::RayPacket::Size> fractions{};
+                const auto mask = collider._shape == Math::ShapeType::Circle ?
+                                  Engine::RayCastCircle8(packet, collider.circleShape.Center(), 6.0f, fractions.data()) :
+                                  Engine::RayCastRectangle8(packet, collider.rectangleShape, fractions.data());
+                if ((mask & 1) && fractions[0] <= closestFraction)
+                {
+                    hasHit = true;
+                    closestFraction = fractions[0];
+                }
+            }
+
+            ASSERT_EQ(hits[rayIndex].hasHit, hasHit) << rayIndex;
+            if (hasHit)
+            {
+                EXPECT_FLOAT_EQ(hits[rayIndex].fraction, closestFraction);
+                EXPECT_NEAR(hits[rayIndex].normal.Length(), 1.0f, 1e-4f);
+            }
+
+            const auto singleHit = world.RayCast(rays[rayIndex]);
+            EXPECT_EQ(singleHit.hasHit, hits[rayIndex].hasHit);
+            EXPECT_FLOAT_EQ(singleHit.fraction, hits[rayIndex].fraction);
+        }
+        EXPECT_FALSE(hits.back().hasHit);
+    }
+}
+
+TEST(World, QueryNearestMatchesBruteForce)
+{
+    for (const auto broadPhaseType: {Engine::BroadPhaseType::QUAD_TREE, Engine::BroadPhaseType::AABB_TREE,
+                                     Engine::BroadPhaseType::SWEEP_AND_PRUNE, Engine::BroadPhaseType::SPATIAL_HASH_GRID,
+                                     Engine::BroadPhaseType::LINEAR_QUAD_TREE, Engine::BroadPhaseType::KD_TREE})
+    {
+        Engine::World world;
+        world.broadPhaseType = broadPhaseType;
+        world.Init();
+
+        std::vector<Engine::ColliderRef> colliderRefs;
+        for (std::size_t i = 0; i < 300; i++)
+        {
+            const auto bodyRef = world.CreateBody();
+            auto& body = world.GetBody(bodyRef);
+            body.SetMass(1);
+            body.SetPosition(Math::Vec2F(static_cast<float>((i * 37) % 800), static_cast<float>((i * 53) % 600)));
+
+            colliderRefs.push_back(world.CreateCollider(bodyRef));
+            auto& collider = world.GetCollider(colliderRefs.back());
+            if (i % 30 == 0)
+            {
+                body.type = Engine::BodyType::STATIC;
+                collider._shape = Math::ShapeType::Rectangle;
+                collider.rectangleShape = Math::RectangleF(body.Position(), body.Position() + Math::Vec2F(80.0f, 20.0f));
+            }
+            else
+            {
+                collider._shape = Math::ShapeType::Circle;
+                collider.circleShape = Math::CircleF(body.Position(), 3.0f + static_cast<float>(i % 7));
+            }
+        }
+        world.ResolveBroadPhase();
+
+        // Points inside and far outside the world.
+        constexpr std::size_t K = 6;
+        std::vector<Math::Vec2F> points;
+        for (std::size_t i = 0; i < 40; i++)
+        {
+            points.emplace_back(static_cast<float>((i * 71) % 1200) - 200.0f, static_cast<float>((i * 29) % 900) - 150.0f);
+        }
+
+        std::vector<Engine::NearestCollider> nearest(points.size() * K);
+        std::vector<std::size_t> counts(points.size());
+        world.QueryNearests(points.data(), points.size(), K, nearest.data(), counts.data());
+
+        for (std::size_t queryIndex = 0; queryIndex < points.size(); queryIndex++)
+        {
+            std::vector<float> expectedDistances;
+            for (const auto& colliderRef: colliderRefs)
+            {
+                const auto& collider = world.GetCollider(colliderRef);
+                if (collider._shape == Math::ShapeType::Circle)
+                {
+                    const auto offset = points[queryIndex] - collider.circleShape.Center();
+                    expectedDistances.push_back(std::max(offset.Length() - collider.circleShape.Radius(), 0.0f));
+                }
+                else
+                {
+                    expectedDistances.push_back(std::sqrt(Engine::SquareDistanceAABB(collider.rectangleShape,
+                                                                                     points[queryIndex])));
+                }
+            }
+            std::sort(expectedDistances.begin(), expectedDistances.end());
+
+            ASSERT_EQ(counts[queryIndex], K);
+            for (std::size_t i = 0; i < K; i++)
+            {
+                EXPECT_NEAR(nearest[queryIndex * K + i].distance, expectedDistances[i], 1e-3f);
+            }
+
+            std::array<Engine::NearestCollider, K> singleNearest{};
+            ASSERT_EQ(world.QueryNearest(points[queryIndex], K, singleNearest.data()), K);
+            EXPECT_EQ(singleNearest[0].colliderRef, nearest[queryIndex * K].colliderRef);
+        }
+
+        // Asking for more colliders than the World has returns all of them.
+        std::vector<Engine::NearestCollider> all(400);
+        EXPECT_EQ(world.QueryNearest(Math::Vec2F(400.0f, 300.0f), all.size(), all.data()), colliderRefs.size());
+    }
+}
+
+TEST(World, ResolveCollisionsMatchesBothPhasesInARow)
+{
+    for (const auto broadPhaseType: {Engine::BroadPhaseType::QUAD_TREE, Engine::BroadPhaseType::AABB_TREE,
+                                     Engine::BroadPhaseType::SWEEP_AND_PRUNE, Engine::BroadPhaseType::SPATIAL_HASH_GRID,
+                                     Engine::BroadPhaseType::LINEAR_QUAD_TREE, Engine::BroadPhaseType::KD_TREE})
+    {
+        // Enough colliders for the QuadTree to find its pairs on several threads, and many chunks of pairs.
+        std::array<Engine::World, 2> worlds;
+        std::array<CountingContactListener, 2> contactListeners;
+        std::array<std::vector<Engine::BodyRef>, 2> bodyRefs;
+        for (std::size_t worldIndex = 0; worldIndex < worlds.size(); worldIndex++)
+        {
+            auto& world = worlds[worldIndex];
+            world.contactListener = &contactListeners[worldIndex];
+            world.broadPhaseType = broadPhaseType;
+            world.Init();
+            for (std::size_t i = 0; i < 1200; i++)
+            {
+                const auto bodyRef = world.CreateBody();
+                auto& body = world.GetBody(bodyRef);
+                body.SetMass(1);
+                body.SetPosition(Math::Vec2F(static_cast<float>((i * 37) % 600), static_cast<float>((i * 53) % 400)));
+                body.SetVelocity(Math::Vec2F(static_cast<float>(i % 7) - 3.0f, static_cast<float>(i % 5) - 2.0f));
+                bodyRefs[worldIndex].push_back(bodyRef);
+
+                auto& collider = world.GetCollider(world.CreateCollider(bodyRef));
+                collider._shape = Math::ShapeType::Circle;
+                collider.circleShape = Math::CircleF(body.Position(), 12.0f);
+            }
+        }
+
+        worlds[0].ResolveBroadPhase();
+        worlds[0].ResolveNarrowPhase();
+        worlds[1].ResolveCollisions();
+
+        EXPECT_GT(contactListeners[0].collisionEnterCount, 4 * Engine::PairChunkSize);
+        EXPECT_EQ(contactListeners[1].collisionEnterCount, contactListeners[0].collisionEnterCount);
+        for (std::size_t i = 0; i < bodyRefs[0].size(); i++)
+        {
+            auto& bodyA = worlds[0].GetBody(bodyRefs[0][i]);
+            auto& bodyB = worlds[1].GetBody(bodyRefs[1][i]);
+            EXPECT_EQ(bodyA.Velocity(), bodyB.Velocity());
+            EXPECT_EQ(bodyA.Position(), bodyB.Position());
+        }
+    }
+}
+
+class CountingNodeVisitor : public Engine::BroadPhaseVisitor
+{
+public:
+    std::size_t nodeCount = 0;
+
+    void OnNode(const Math::RectangleF&, int) noexcept override
+    {
+        nodeCount++;
+    }
+};
+
+TEST(World, SetBroadPhaseSwitchesTheStructureAtRuntime)
+{
+    Engine::World world;
+    world.Init();
+    for (std::size_t i = 0; i < 300; i++)
+    {
+        const auto bodyRef = world.CreateBody();
+        auto& body = world.GetBody(bodyRef);
+        body.SetPosition(Math::Vec2F(static_cast<float>((i * 37) % 400), static_cast<float>((i * 53) % 300)));
+
+        auto& collider = world.GetCollider(world.CreateCollider(bodyRef));
+        collider._shape = Math::ShapeType::Circle;
+        collider.circleShape = Math::CircleF(body.Position(), 10.0f);
+    }
+
+    world.ResolveBroadPhase();
+    const auto pairCount = world.GetBroadPhase().ColliderPairs().size();
+    EXPECT_GT(pairCount, 0);
+    EXPECT_EQ(&world.GetBroadPhase(), &world.tree);
+
+    CountingNodeVisitor quadTreeVisitor;
+    world.GetBroadPhase().VisitNodes(quadTreeVisitor);
+    EXPECT_EQ(quadTreeVisitor.nodeCount, world.tree.NodeCount());
+
+    Engine::KdTree customKdTree;
+    customKdTree.leafSize = 3;
+    customKdTree.Init();
+    world.SetBroadPhase(&customKdTree);
+    EXPECT_EQ(&world.GetBroadPhase(), &customKdTree);
+
+    // The colliders move to the new structure, the previous one is emptied.
+    world.ResolveBroadPhase();
+    EXPECT_EQ(customKdTree.ColliderPairs().size(), pairCount);
+    EXPECT_TRUE(world.tree.ColliderPairs().empty());
+    EXPECT_EQ(world.tree.NodeCount(), 1);
+
+    CountingNodeVisitor kdTreeVisitor;
+    world.GetBroadPhase().VisitNodes(kdTreeVisitor);
+    EXPECT_EQ(kdTreeVisitor.nodeCount, customKdTree.nodes.size());
+
+    world.SetBroadPhase(nullptr);
+    world.broadPhaseType = Engine::BroadPhaseType::SWEEP_AND_PRUNE;
+    world.ResolveBroadPhase();
+    EXPECT_EQ(world.GetBroadPhase().ColliderPairs().size(), pairCount);
+    EXPECT_TRUE(customKdTree.proxies.empty());
+}
+
+// Reports the pairs of a reference broad phase, except the first one, and the last one twice.
+class FaultyBroadPhase : public Engine::BroadPhase
+{
+public:
+    Engine::BruteForceBroadPhase reference;
+    HeapAllocator heapAllocator;
+    AllocatedVector<Engine::ColliderPair> colliderPairs{StandardAllocator<Engine::ColliderPair>{heapAllocator}};
+
+    void Init() noexcept override { reference.Init(); }
+    void Clear() noexcept override { reference.Clear(); }
+    void UpdateCollider(const Engine::SimplifedCollider& simplifedCollider) noexcept override { reference.UpdateCollider(simplifedCollider); }
+    void RemoveCollider(std::size_t colliderIndex) noexcept override { reference.RemoveCollider(colliderIndex); }
+
+    void FindPossiblePairs() noexcept override
+    {
+        reference.FindPossiblePairs();
+        colliderPairs.assign(reference.ColliderPairs().begin() + 1, reference.ColliderPairs().end());
+        colliderPairs.push_back(colliderPairs.back());
+    }
+
+    void FindPossiblePairs(Engine::PairCallback& callback) noexcept override
+    {
+        FindPossiblePairs();
+        callback.OnPairs(colliderPairs.data(), colliderPairs.size());
+    }
+
+    [[nodiscard]] const AllocatedVector<Engine::ColliderPair>& ColliderPairs() const noexcept override
+    {
+        return colliderPairs;
+    }
+
+    void QueryAABB(const Math::RectangleF& aabb, std::size_t queryIndex, Engine::QueryCallback& callback) noexcept override
+    {
+        reference.QueryAABB(aabb, queryIndex, callback);
+    }
+};
+
+TEST(World, CheckingBroadPhaseReportsMissedAndDuplicatePairs)
+{
+    FaultyBroadPhase faultyBroadPhase;
+    faultyBroadPhase.Init();
+    for (const auto broadPhaseType: {Engine::BroadPhaseType::QUAD_TREE, Engine::BroadPhaseType::AABB_TREE,
+                                     Engine::BroadPhaseType::SWEEP_AND_PRUNE, Engine::BroadPhaseType::SPATIAL_HASH_GRID,
+                                     Engine::BroadPhaseType::LINEAR_QUAD_TREE, Engine::BroadPhaseType::KD_TREE})
+    {
+        Engine::World world;
+        CountingContactListener contactListener;
+        world.contactListener = &contactListener;
+        world.broadPhaseType = broadPhaseType;
+        world.isCheckingBroadPhase = true;
+        world.Init();
+        for (std::size_t i = 0; i < 400; i++)
+        {
+            const auto bodyRef = world.CreateBody();
+            auto& body = world.GetBody(bodyRef);
+            body.SetMass(1);
+            body.SetPosition(Math::Vec2F(static_cast<float>((i * 37) % 500), static_cast<float>((i * 53) % 300)));
+            body.SetVelocity(Math::Vec2F(static_cast<float>(i % 7) - 3.0f, static_cast<float>(i % 5) - 2.0f));
+
+            auto& collider = world.GetCollider(world.CreateCollider(bodyRef));
+            collider._shape = i % 3 == 0 ? Math::ShapeType::Rectangle : Math::ShapeType::Circle;
+            collider.circleShape = Math::CircleF(body.Position(), 10.0f);
+            collider.rectangleShape = Math::RectangleF::FromCenter(body.Position(), Math::Vec2F(12.0f, 6.0f));
+            collider.filter.groupIndex = i % 11 == 0 ? -1 : 0;
+        }
+
+        // The built in structures agree with the reference, whether the pairs are kept or streamed.
+        for (int step = 0; step < 3; step++)
+        {
+            world.Update(1.0f);
+            EXPECT_TRUE(world.missedPairs.empty());
+            EXPECT_TRUE(world.duplicatePairs.empty());
+            world.ResolveBroadPhase();
+            EXPECT_TRUE(world.missedPairs.empty());
+            EXPECT_TRUE(world.duplicatePairs.empty());
+        }
+        EXPECT_GT(world.referenceBroadPhase.ColliderPairs().size(), 0);
+
+        world.SetBroadPhase(&faultyBroadPhase);
+        world.ResolveBroadPhase();
+        ASSERT_EQ(world.missedPairs.size(), 1);
+        EXPECT_EQ(world.missedPairs.front(), world.referenceBroadPhase.ColliderPairs().front());
+        ASSERT_EQ(world.duplicatePairs.size(), 1);
+        EXPECT_EQ(world.duplicatePairs.front(), world.referenceBroadPhase.ColliderPairs().back());
+
+        world.Update(1.0f);
+        EXPECT_EQ(world.missedPairs.size(), 1);
+        EXPECT_EQ(world.duplicatePairs.size(), 1);
+        world.SetBroadPhase(nullptr);
+    }
+}
+
+static float SettleStack(bool isWarmStarting, std::size_t solverIterations,
+                         Engine::ContactSolverType contactSolverType = Engine::ContactSolverType::SEQUENTIAL)
+{
+    Engine::World world;
+    CountingContactListener contactListener;
+    world.contactListener = &contactListener;
+    world.solverIterations = solverIterations;
+    world.isWarmStarting = isWarmStarting;
+    world.contactSolverType = contactSolverType;
+    world.Init();
+
+    const auto groundRef = world.CreateBody();
+    world.GetBody(groundRef).type = Engine::BodyType::STATIC;
+    world.GetBody(groundRef).SetMass(1);
+    auto& ground = world.GetCollider(world.CreateCollider(groundRef));
+    ground._shape = Math::ShapeType::Rectangle;
+    ground.rectangleShape = Math::RectangleF(Math::Vec2F(-20.0f, -10.0f), Math::Vec2F(20.0f, 0.0f));
+    ground.restitution = 0.0f;
+
+    // A column of boxes resting on each other, the pairs are already touching on the first step.
+    std::vector<std::pair<Engine::BodyRef, Engine::ColliderRef>> boxes;
+    const Math::Vec2F halfSize(1.0f, 1.0f);
+    for (std::size_t i = 0; i < 6; i++)
+    {
+        const auto bodyRef = world.CreateBody();
+        auto& body = world.GetBody(bodyRef);
+        body.SetMass(1);
+        body.SetPosition(Math::Vec2F(0.0f, 1.0f + 2.0f * static_cast<float>(i)));
+        const auto colliderRef = world.CreateCollider(bodyRef);
+        auto& collider = world.GetCollider(colliderRef);
+        collider._shape = Math::ShapeType::Rectangle;
+        collider.rectangleShape = Math::RectangleF::FromCenter(body.Position(), halfSize);
+        collider.restitution = 0.0f;
+        boxes.emplace_back(bodyRef, colliderRef);
+    }
+
+    // Returns the largest vertical speed of a box once the stack had time to settle.
+    float maxSpeed = 0.0f;
+    for (std::size_t step = 0; step < 120; step++)
+    {
+        for (const auto& [bodyRef, colliderRef]: boxes)
+        {
+            world.GetBody(bodyRef).SetForce(Math::Vec2F(0.0f, -10.0f));
+        }
+        world.Update(1.0f / 60.0f);
+        for (const auto& [bodyRef, colliderRef]: boxes)
+        {
+            auto& body = world.GetBody(bodyRef);
+            world.GetCollider(colliderRef).rectangleShape = Math::RectangleF::FromCenter(body.Position(), halfSize);
+            if (step >= 100)
+            {
+                maxSpeed = std::max(maxSpeed, std::abs(body.Velocity().Y));
+            }
+        }
+    }
+    return maxSpeed;
+}
+
+TEST(World, WarmStartedContactsSettleAStackInFewIterations)
+{
+    // Two iterations from the impulses of the previous step do as well as many iterations from nothing.
+    const auto warmSpeed = SettleStack(true, 2);
+    EXPECT_LT(warmSpeed, 0.01f);
+    EXPECT_LT(warmSpeed, SettleStack(false, 64));
+    EXPECT_GT(SettleStack(false, 2), 10.0f * warmSpeed);
+}
+
+TEST(World, WideContactSolverSettlesAStack)
+{
+    EXPECT_LT(SettleStack(true, 2, Engine::ContactSolverType::WIDE), 0.01f);
+}
+
+TEST(World, WideContactSolverMatchesTheSequentialOne)
+{
+    // A heavy circle touched by more small circles than the wide solver has colors, so the last ones are solved alone.
+    // The small circles are spread around it and do not touch each other.
+    std::array<Engine::World, 2> worlds;
+    std::array<CountingContactListener, 2> contactListeners;
+    std::array<std::vector<Engine::BodyRef>, 2> bodyRefs;
+    for (std::size_t worldIndex = 0; worldIndex < worlds.size(); worldIndex++)
+    {
+        auto& world = worlds[worldIndex];
+        world.contactListener = &contactListeners[worldIndex];
+        world.contactSolverType = worldIndex == 0 ? Engine::ContactSolverType::SEQUENTIAL :
+                                  Engine::ContactSolverType::WIDE;
+        world.Init();
+        for (std::size_t i = 0; i < 81; i++)
+        {
+            const auto bodyRef = world.CreateBody();
+            auto& body = world.GetBody(bodyRef);
+            const auto angle = static_cast<float>(i) * 0.0785f;
+            const auto direction = Math::Vec2F(std::cos(angle), std::sin(angle));
+            const auto center = Math::Vec2F(500.0f, 500.0f);
+            body.SetMass(i == 0 ? 50.0f : 1.0f);
+            body.SetPosition(i == 0 ? center : center + direction * 409.0f);
+            body.SetVelocity(i == 0 ? Math::Vec2F(1.0f, 0.0f) : direction * -2.0f);
+            bodyRefs[worldIndex].push_back(bodyRef);
+
+            auto& collider = world.GetCollider(world.CreateCollider(bodyRef));
+            collider._shape = Math::ShapeType::Circle;
+            collider.circleShape = Math::CircleF(body.Position(), i == 0 ? 400.0f : 10.0f);
+        }
+        world.ResolveBroadPhase();
+        world.ResolveNarrowPhase();
+    }
+
+    EXPECT_EQ(contactListeners[0].collisionEnterCount, 80);
+    EXPECT_EQ(contactListeners[1].collisionEnterCount, contactListeners[0].collisionEnterCount);
+    for (std::size_t i = 0; i < bodyRefs[0].size(); i++)
+    {
+        auto& bodyA = worlds[0].GetBody(bodyRefs[0][i]);
+        auto& bodyB = worlds[1].GetBody(bodyRefs[1][i]);
+        EXPECT_NEAR(bodyA.Velocity().X, bodyB.Velocity().X, 1e-3f);
+        EXPECT_NEAR(bodyA.Velocity().Y, bodyB.Velocity().Y, 1e-3f);
+        EXPECT_NEAR(bodyA.Position().X, bodyB.Position().X, 1e-3f);
+        EXPECT_NEAR(bodyA.Position().Y, bodyB.Position().Y, 1e-3f);
+    }
+}
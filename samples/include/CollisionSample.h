@@ -23,8 +23,7 @@
  * Methods:
  * - CreateCircle(): Creates circles in the sample world, initializing bodies, colliders, and positions.
  * - RenderCircle(): Renders the circles in the sample world using SDL.
- * - RenderNodes(): Renders the quad tree nodes in the sample world using SDL.
- * - DrawQuadTreeNodes(): Recursively draws the quad tree nodes.
+ * - RenderNodes(): Renders the broad phase nodes of the sample world using SDL.
  * - ReverseForceOnBorder(): Reverses the force of circles that hit the fictive borders of the window.
  * - OnTriggerEnter(), OnTriggerExit(), OnCollisionEnter(), OnCollisionExit(): Event handling methods.
  * - SampleSetUp(): Sets up the collision sample by associating the contact listener and creating circles.
@@ -62,19 +61,11 @@ public :
     void RenderCircle(SDL_Renderer* renderer) noexcept;
 
     /**
-     * @brief Renders the quad tree nodes in the sample world using SDL.
+     * @brief Renders the broad phase nodes of the sample world using SDL.
      * @param renderer The SDL renderer.
      */
     void RenderNodes(SDL_Renderer* renderer) noexcept;
 
-    /**
-     * @brief Recursively draws the quad tree nodes.
-     * @param renderer The SDL renderer.
-     * @param node The quad tree node to draw.
-     * @param color The color to use for drawing.
-     */
-    void DrawQuadTreeNodes(SDL_Renderer* renderer, Engine::QuadNode& node, const SDL_Color& color) noexcept;
-
     /**
      * @brief Reverses the force of circles that hit the fictive borders of the _window.
      */
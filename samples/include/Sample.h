@@ -34,6 +34,9 @@
  * - `virtual void SampleRender(SDL_Renderer *renderer) noexcept = 0`: Abstract method for specific sample rendering.
  * - `virtual void SampleTearDown() noexcept = 0`: Abstract method for specific sample teardown.
  *
+ * And the following protected method:
+ * - `void RenderBroadPhase(SDL_Renderer* renderer, SDL_Color color) noexcept`: Draws the nodes of the world broad phase.
+ *
  * This class provides a foundation for creating and managing physics simulation samples.
  */
 class Sample
@@ -74,4 +77,11 @@ protected:
     virtual void SampleRender(SDL_Renderer* renderer) noexcept = 0;
 
     virtual void SampleTearDown() noexcept = 0;
+
+    /**
+     * @brief Draws the outline of every node of the broad phase used by the sample world, whatever its structure.
+     * @param renderer The SDL renderer.
+     * @param color The color of the outlines.
+     */
+    void RenderBroadPhase(SDL_Renderer* renderer, SDL_Color color) noexcept;
 };
\ No newline at end of file
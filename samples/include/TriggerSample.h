@@ -26,8 +26,7 @@
  * - CreateObjects(): Creates a predefined number of circles and rectangles with trigger colliders, initializing their properties.
  * - RenderCircle(): Renders circles using the provided SDL renderer.
  * - RenderRect(): Renders rectangles using the provided SDL renderer.
- * - RenderNodes(): Renders quadtree nodes using the provided SDL renderer.
- * - DrawQuadTreeNodes(): Draws quadtree nodes recursively.
+ * - RenderNodes(): Renders the broad phase nodes using the provided SDL renderer.
  * - ReverseForceOnBorder(): Reverses the force on objects that reach the fictive borders of the screen.
  * - OnTriggerEnter(): Handles trigger enter events by incrementing collision counters.
  * - OnTriggerExit(): Handles trigger exit events by decrementing collision counters.
@@ -99,19 +98,11 @@ public :
     void RenderRect(SDL_Renderer* renderer) noexcept;
 
     /**
-     * @brief Renders quadtree nodes using the provided SDL renderer.
+     * @brief Renders the broad phase nodes using the provided SDL renderer.
      * @param renderer The SDL renderer used for rendering.
      */
     void RenderNodes(SDL_Renderer* renderer) noexcept;
 
-    /**
- * @brief Draws quadtree nodes recursively.
- * @param renderer The SDL renderer used for rendering.
- * @param node The quadtree node to draw.
- * @param color The color to use for drawing the node outline.
- */
-    void DrawQuadTreeNodes(SDL_Renderer* renderer, Engine::QuadNode& node, const SDL_Color& color) noexcept;
-
     /**
      * @brief Reverses the force on objects that reach the fictive borders of the screen.
      */
@@ -66,31 +66,7 @@ void CollisionWithRectSample::RenderCircle(SDL_Renderer* renderer) noexcept
 
 void CollisionWithRectSample::RenderNodes(SDL_Renderer* renderer) noexcept
 {
-    Display::DrawRectOutline(renderer, _sampleWorld.tree.nodes[0].bounds, SDL_Color{100, 100, 100, 0}, 2);
-    if (_sampleWorld.tree.nodes[0].children[0])
-    {
-        for (const auto& child: _sampleWorld.tree.nodes[0].children)
-        {
-            if (child != nullptr)
-            {
-                DrawQuadTreeNodes(renderer, *child, SDL_Color{100, 100, 100, 0});
-            }
-        }
-    }
-}
-
-void CollisionWithRectSample::DrawQuadTreeNodes(SDL_Renderer* renderer, Engine::QuadNode& node,
-                                                const SDL_Color& color) noexcept
-{
-    Display::DrawRectOutline(renderer, node.bounds, color, 2);
-
-    for (const auto& child: node.children)
-    {
-        if (child)
-        {
-            DrawQuadTreeNodes(renderer, *child, color);
-        }
-    }
+    RenderBroadPhase(renderer, SDL_Color{100, 100, 100, 0});
 }
 
 void CollisionWithRectSample::ReverseForceOnBorder() noexcept
@@ -1,4 +1,27 @@
 #include "Sample.h"
+#include "Display.h"
+
+namespace
+{
+    /**
+     * @brief Draws the outline of each broad phase node it visits.
+     */
+    class NodeOutlineVisitor final : public Engine::BroadPhaseVisitor
+    {
+    public:
+        NodeOutlineVisitor(SDL_Renderer* renderer, SDL_Color color) noexcept: _renderer(renderer), _color(color)
+        {}
+
+        void OnNode(const Math::RectangleF& bounds, int) noexcept override
+        {
+            Display::DrawRectOutline(_renderer, bounds, _color, 2);
+        }
+
+    private:
+        SDL_Renderer* _renderer;
+        SDL_Color _color;
+    };
+}
 
 void Sample::SetUp() noexcept
 {
@@ -19,4 +42,10 @@ void Sample::TearDown() noexcept
     _bodyRefs.clear();
     _colRefs.clear();
     _sampleWorld.Clear();
+}
+
+void Sample::RenderBroadPhase(SDL_Renderer* renderer, SDL_Color color) noexcept
+{
+    NodeOutlineVisitor visitor(renderer, color);
+    _sampleWorld.GetBroadPhase().VisitNodes(visitor);
 }
\ No newline at end of file